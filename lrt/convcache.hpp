@@ -0,0 +1,156 @@
+#ifndef CONVCACHE_HPP
+#define CONVCACHE_HPP
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "directory.hpp"
+
+
+///Get fast 64bit hash of data
+static unsigned long long getHash(const unsigned char *in, const unsigned length, unsigned long long hash = 0x9E3779B97F4A7C15) {
+    const unsigned long long mul = 0xFF51AFD7ED558CCD;
+    unsigned i = 0;
+
+    for (unsigned long long k; i + 8 <= length; i += 8) {
+        memcpy(&k, in + i, 8);
+        hash = (hash ^ k) * mul;
+        hash ^= hash >> 32;
+    }
+    for (; i < length; ++i) hash = (hash ^ in[i]) * 0x100000001B3;
+
+    hash = (hash ^ length) * mul;
+    return hash ^ (hash >> 29);
+}
+
+
+///Incremental Conversion Cache
+///  Remembers input and output hashes between runs, so unchanged inputs
+///  are skipped and outputs with identical bytes aren't rewritten
+struct convcache {
+    //Load manifest, entries from other versions are dropped
+    int load(const std::string &file, const std::string &ver) {
+        std::lock_guard<std::mutex> lck(lock);
+        const unsigned char *data = 0;
+        unsigned size = 0;
+
+        name = file; vers = ver;
+        jobs.clear(); outs.clear();
+        if (!mapFileData(file.c_str(), data, size)) return 0;
+
+        std::string lst((const char*)data, size), key;
+        unmapFileData(data, size);
+
+        for (size_t p0 = 0, p1 = 0; p0 < lst.size(); p0 = p1 + 1) {
+            p1 = lst.find('\n', p0); if (p1 == std::string::npos) p1 = lst.size();
+            const auto ln = lst.substr(p0, p1 - p0);
+            unsigned long long hash = 0;
+            unsigned siz = 0;
+            int pos = 0;
+
+            if (!p0) { if (ln != "#cache " + vers) return 0; continue; }
+            if (sscanf(ln.c_str(), "I %llx %n", &hash, &pos) == 1 && pos) {
+                key = ln.substr(pos);
+                for (auto &c : key) if (c == '\t') c = '\n';
+                jobs[key] = {hash, {}};
+            }
+            else if (sscanf(ln.c_str(), "O %llx %u %n", &hash, &siz, &pos) == 2 && pos && !key.empty()) {
+                jobs[key].outs.push_back(ln.substr(pos));
+                outs[ln.substr(pos)] = {hash, siz};
+            }
+        }
+
+        return 1;
+    }
+    //Write manifest, dropping anything that failed to be written
+    int save(const std::vector<std::string> &errors = {}) {
+        std::lock_guard<std::mutex> lck(lock);
+        std::string lst = "#cache " + vers + "\n";
+        char tmp[64] {};
+
+        if (name.empty()) return 0;
+        for (const auto &e : errors) outs.erase(e);
+
+        for (const auto &j : jobs) {
+            bool is_ok = true;
+            for (const auto &o : j.second.outs) if (!outs.count(o)) is_ok = false;
+            if (!is_ok) continue;
+
+            auto key = j.first;
+            for (auto &c : key) if (c == '\n') c = '\t';
+            snprintf(tmp, 64, "I %016llx ", j.second.hash);
+            lst += tmp + key + "\n";
+            for (const auto &o : j.second.outs) {
+                snprintf(tmp, 64, "O %016llx %u ", outs[o].hash, outs[o].size);
+                lst += tmp + o + "\n";
+            }
+        }
+
+        if (!createFile((name + ".tmp").c_str(), lst.data(), lst.size())) return 0;
+        return !rename((name + ".tmp").c_str(), name.c_str());
+    }
+    //Check if input is unchanged and all of its outputs are still there
+    int isFresh(const std::string &key, const unsigned long long &hash) {
+        std::lock_guard<std::mutex> lck(lock);
+        auto itr = jobs.find(key);
+        if (itr == jobs.end() || itr->second.hash != hash) return 0;
+
+        for (const auto &o : itr->second.outs) {
+            unsigned siz;
+            if (!getFileSize(o.c_str(), siz) || siz != outs[o].size) return 0;
+        }
+        return 1;
+    }
+    //Get outputs recorded for input
+    std::vector<std::string> getOutputs(const std::string &key) {
+        std::lock_guard<std::mutex> lck(lock);
+        auto itr = jobs.find(key);
+        return (itr == jobs.end()) ? std::vector<std::string>{} : itr->second.outs;
+    }
+    //Start recording outputs of input converted on this thread
+    void setJob(const std::string &key, const unsigned long long &hash) {
+        cur = {hash, {}}; cur_key = key;
+    }
+    //Stop recording, input is only kept if it converted
+    void endJob(const bool &is_ok) {
+        std::lock_guard<std::mutex> lck(lock);
+        if (is_ok) jobs[cur_key] = std::move(cur);
+        else jobs.erase(cur_key);
+        cur = {}; cur_key.clear();
+    }
+    //Record output of current input, 0 if file already holds these bytes
+    int setOutput(const std::string &file, const unsigned char *data, const unsigned size) {
+        const unsigned long long hash = getHash(data, size);
+        if (!cur_key.empty()) cur.outs.push_back(file);
+
+        std::lock_guard<std::mutex> lck(lock);
+        auto itr = outs.find(file);
+        unsigned siz;
+        if (
+            itr != outs.end() && itr->second.hash == hash && itr->second.size == size &&
+            getFileSize(file.c_str(), siz) && siz == size
+        ) return 0;
+
+        outs[file] = {hash, size};
+        return 1;
+    }
+
+    private:
+        struct outinfo { unsigned long long hash; unsigned size; };
+        struct jobinfo { unsigned long long hash; std::vector<std::string> outs; };
+
+        std::mutex lock;
+        std::string name, vers;
+        std::map<std::string, jobinfo> jobs;
+        std::map<std::string, outinfo> outs;
+
+        //Inputs are converted start to end on one thread
+        static inline thread_local jobinfo cur {};
+        static inline thread_local std::string cur_key;
+};
+
+
+#endif
@@ -1,73 +1,260 @@
 #ifndef DIRECTORY_HPP
 #define DIRECTORY_HPP
 
+#include <climits>
 #include <cstdio>
+#include <string>
+#include <vector>
 #include <errno.h>
 #if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) \
                       || defined(WIN64) || defined(_WIN64) || defined(__WIN64__)
+    #ifndef NOMINMAX
+    #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
     #include <direct.h>
+    #include <io.h>
+    #include <windows.h>
     #define mkdir(filename) _mkdir(filename)
 #else
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
     #include <sys/stat.h>
     #include <sys/types.h>
+    #include <unistd.h>
     #define mkdir(filename) mkdir(filename, 0777)
 #endif
 
 
 ///Create a folder
-static int createFolder(const char *folder) {
+static inline int createFolder(const char *folder) {
     int ret = 1;
     if (mkdir(folder) < 0) ret = (errno == EEXIST);
 
     return ret;
 }
 
+///Check if a path is a folder
+static inline int isFolder(const char *folder) {
+    int ret = 1;
+
+#if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) \
+                      || defined(WIN64) || defined(_WIN64) || defined(__WIN64__)
+    DWORD in_attr = GetFileAttributesA(folder);
+    if (in_attr == INVALID_FILE_ATTRIBUTES || !(in_attr & FILE_ATTRIBUTE_DIRECTORY)) ret = 0;
+#else
+    struct stat in_stat {};
+    if (stat(folder, &in_stat) < 0 || !S_ISDIR(in_stat.st_mode)) ret = 0;
+#endif
+
+    return ret;
+}
+
+///Get size of a file, 0 if it doesn't exist
+static inline int getFileSize(const char *file, unsigned &data_size) {
+    int ret = 1;
+    data_size = 0;
+
+#if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) \
+                      || defined(WIN64) || defined(_WIN64) || defined(__WIN64__)
+    WIN32_FILE_ATTRIBUTE_DATA in_attr {};
+    if (!GetFileAttributesExA(file, GetFileExInfoStandard, &in_attr)) ret = 0;
+    else if (in_attr.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ret = 0;
+    else data_size = in_attr.nFileSizeLow;
+#else
+    struct stat in_stat {};
+    if (stat(file, &in_stat) < 0 || !S_ISREG(in_stat.st_mode)) ret = 0;
+    else data_size = in_stat.st_size;
+#endif
+
+    return ret;
+}
+
+///Get all files within a folder and its subfolders
+static inline int getFolderFiles(const char *folder, std::vector<std::string> &files) {
+    int ret = 1;
+
+    std::string root = (folder) ? folder : "";
+    if (root.empty()) return 0;
+    if (root.find_last_of("\\/") != root.size() - 1) root += "/";
+
+#if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) \
+                      || defined(WIN64) || defined(_WIN64) || defined(__WIN64__)
+    WIN32_FIND_DATAA in_data {};
+    HANDLE in = FindFirstFileA((root + "*").c_str(), &in_data);
+    if (in == INVALID_HANDLE_VALUE) ret = 0;
+    else {
+        do {
+            std::string nam = in_data.cFileName;
+            if (nam == "." || nam == "..") continue;
+            if (in_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) getFolderFiles((root + nam).c_str(), files);
+            else files.push_back(root + nam);
+        } while (FindNextFileA(in, &in_data));
+        FindClose(in);
+    }
+#else
+    DIR *in = opendir(root.c_str());
+    if (!in) ret = 0;
+    else {
+        for (dirent *ent; (ent = readdir(in));) {
+            std::string nam = ent->d_name;
+            if (nam == "." || nam == "..") continue;
+            if (isFolder((root + nam).c_str())) getFolderFiles((root + nam).c_str(), files);
+            else files.push_back(root + nam);
+        }
+        closedir(in);
+    }
+#endif
+
+    return ret;
+}
+
 ///Write binary to a file
-static int createFile(const char *file, unsigned char *data, unsigned data_size) {
+static inline int createFile(const char *file, unsigned char *data, unsigned data_size) {
     int ret = 1;
 
     FILE *out = fopen(file, "wb");
     if (!out) ret = 0;
     else {
-        fseek(out, 0, SEEK_SET);
-        fflush(out);
-        if (!fwrite(data, 1, data_size, out) || fclose(out)) ret = 0;
+        if (!data_size || fwrite(data, 1, data_size, out) != data_size) ret = 0;
+        if (fclose(out)) ret = 0;
     }
 
     return ret;
 }
 
 ///Write C-style string to a file
-static int createFile(const char *file, const char *data, unsigned data_size) {
+static inline int createFile(const char *file, const char *data, unsigned data_size) {
     return createFile(file, (unsigned char*)data, data_size);
 }
 
+///Write all of data to a file descriptor, interrupted writes are retried
+static inline int writeFileData(const int fd, const unsigned char *data, const unsigned data_size) {
+    for (unsigned pos = 0; pos < data_size;) {
+#if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) \
+                      || defined(WIN64) || defined(_WIN64) || defined(__WIN64__)
+        const long long siz = _write(fd, data + pos, data_size - pos);
+#else
+        const long long siz = write(fd, data + pos, data_size - pos);
+#endif
+        if (siz < 0 && errno == EINTR) continue;
+        if (siz <= 0) return 0;
+        pos += siz;
+    }
+
+    return 1;
+}
+
 ///Delete a file
-static int removeFile(const char *file) {
+static inline int removeFile(const char *file) {
     int ret = 1;
     if (remove(file) < 0) ret = (errno == ENOENT);
 
     return ret;
 }
 
-///Get data from a file
-static int getFileData(const char *file, unsigned char *&data, unsigned &data_size) {
+///Map a file into read-only memory
+///  Files of 4 GiB or more are refused, sizes are kept as unsigned throughout
+static inline int mapFileData(const char *file, const unsigned char *&data, unsigned &data_size) {
     int ret = 1;
 
-    FILE *in = fopen(file, "rb");
-    if (!in) ret = 0;
+    data = 0;
+    data_size = 0;
+
+#if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) \
+                      || defined(WIN64) || defined(_WIN64) || defined(__WIN64__)
+    HANDLE in = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    LARGE_INTEGER in_size {};
+    if (in == INVALID_HANDLE_VALUE) ret = 0;
+    else {
+        HANDLE map = 0;
+        if (GetFileSizeEx(in, &in_size) && in_size.QuadPart > 0 && in_size.QuadPart <= UINT_MAX) {
+            map = CreateFileMappingA(in, 0, PAGE_READONLY, 0, 0, 0);
+        }
+        CloseHandle(in);
+
+        if (!map) ret = 0;
+        else {
+            data = (const unsigned char*)MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(map);
+            if (!data) ret = 0;
+            else data_size = in_size.QuadPart;
+        }
+    }
+#else
+    int in = open(file, O_RDONLY);
+    struct stat in_stat {};
+    if (in < 0) ret = 0;
     else {
-        if (!data_size) {
-            fseek(in, 0, SEEK_END);
-            data_size = ftell(in);
+        void *map = MAP_FAILED;
+        if (!fstat(in, &in_stat) && in_stat.st_size > 0 && (unsigned long long)in_stat.st_size <= UINT_MAX) {
+            map = mmap(0, in_stat.st_size, PROT_READ, MAP_PRIVATE, in, 0);
+        }
+        close(in);
+
+        if (map == MAP_FAILED) ret = 0;
+        else {
+            data = (const unsigned char*)map;
+            data_size = in_stat.st_size;
         }
-        fseek(in, 0, SEEK_SET);
+    }
+#endif
+
+    return ret;
+}
+
+///Unmap a file from memory
+static inline int unmapFileData(const unsigned char *data, const unsigned data_size) {
+    int ret = 1;
+    if (!data || !data_size) return ret;
+
+#if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) \
+                      || defined(WIN64) || defined(_WIN64) || defined(__WIN64__)
+    if (!UnmapViewOfFile(data)) ret = 0;
+#else
+    if (munmap((void*)data, data_size) < 0) ret = 0;
+#endif
+
+    return ret;
+}
 
-        data = new unsigned char[data_size] {};
+///Read a byte range from a file without touching the rest
+///  data_size is set to the amount actually read
+static inline int getFileRange(const char *file, const unsigned offset, unsigned char *data, unsigned &data_size) {
+    int ret = 1;
+    unsigned size = 0;
 
-        if (!fread(data, 1, data_size, in) || fclose(in)) ret = 0;
+#if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) \
+                      || defined(WIN64) || defined(_WIN64) || defined(__WIN64__)
+    HANDLE in = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (in == INVALID_HANDLE_VALUE) ret = 0;
+    else {
+        OVERLAPPED in_ofs {};
+        DWORD in_read = 0;
+        in_ofs.Offset = offset;
+        if (!ReadFile(in, data, data_size, &in_read, &in_ofs) && GetLastError() != ERROR_HANDLE_EOF) ret = 0;
+        else size = in_read;
+        CloseHandle(in);
     }
+#else
+    int in = open(file, O_RDONLY);
+    if (in < 0) ret = 0;
+    else {
+        while (size < data_size) {
+            ssize_t in_read = pread(in, data + size, data_size - size, (off_t)offset + size);
+            if (in_read < 0 && errno == EINTR) continue;
+            if (in_read < 0) { ret = 0; break; }
+            if (!in_read) break;
+            size += in_read;
+        }
+        close(in);
+    }
+#endif
 
+    data_size = size;
     return ret;
 }
 
@@ -0,0 +1,243 @@
+#ifndef FILEQUEUE_HPP
+#define FILEQUEUE_HPP
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "convcache.hpp"
+#include "directory.hpp"
+
+
+///Write-Behind File Queue
+///  Files are handed to I/O workers so callers don't stall on the filesystem
+///  Optionally every file goes into one uncompressed tar with a .toc listing
+struct filequeue {
+    ~filequeue() {
+        flush();
+        {
+            std::lock_guard<std::mutex> lck(lock);
+            done = true;
+        }
+        cv_pop.notify_all();
+        for (auto &w : workers) w.join();
+        setArchive("");
+    }
+    filequeue(const unsigned t_w = 2, const unsigned t_l = 64 << 20) : limit(t_l) {
+        for (unsigned w = 0; w < ((t_w) ? t_w : 1); ++w) workers.emplace_back(&filequeue::work, this);
+    }
+    filequeue(const filequeue &r) = delete;
+    filequeue& operator=(const filequeue &r) = delete;
+
+    //Write all following files into archive, empty to close current one
+    //  Archive only changes with queue drained, holding both locks
+    int setArchive(const std::string &file) {
+        flush();
+        std::scoped_lock lck(lock, arc_lock);
+        int ret = 1;
+
+        if (arc) {
+            //End of archive, then table of contents
+            unsigned char end[1024] {};
+            if (fwrite(end, 1, 1024, arc) != 1024 || fclose(arc)) ret = 0;
+            arc = 0;
+
+            std::string toc;
+            for (const auto &t : arc_toc) {
+                toc += std::to_string(std::get<0>(t)) + " " + std::to_string(std::get<1>(t)) + " " + std::get<2>(t) + "\n";
+            }
+            if (!createFile((arc_name + ".toc").c_str(), toc.data(), toc.size()) && !toc.empty()) ret = 0;
+            if (!ret) errors.push_back(arc_name);
+
+            arc_toc.clear();
+            arc_name.clear();
+            arc_pos = 0;
+        }
+        if (!file.empty()) {
+            arc = fopen(file.c_str(), "wb");
+            if (!arc) ret = 0;
+            else arc_name = file;
+        }
+
+        return ret;
+    }
+    //Create folder once, later requests are answered from cache
+    int setFolder(const std::string &folder) {
+        std::lock_guard<std::mutex> lck(lock);
+        if (folders.count(folder)) return 1;
+
+        int ret = (arc) ? 1 : createFolder(folder.c_str());
+        if (ret) folders.insert(folder);
+        return ret;
+    }
+    //Skip files whose bytes are unchanged since last run, 0 to disable
+    void setCache(convcache *c) {
+        std::lock_guard<std::mutex> lck(lock);
+        cache = c;
+    }
+    //Queue data for file, waits while queue is over its limit
+    int setFile(const std::string &file, std::vector<unsigned char> &&data) {
+        std::unique_lock<std::mutex> lck(lock);
+        if (cache && !arc) {
+            //Hash outside of lock, cache keeps its own
+            auto *c = cache;
+            lck.unlock();
+            if (!c->setOutput(file, data.data(), data.size())) return 1;
+            lck.lock();
+        }
+
+        cv_push.wait(lck, [this]() { return queue.empty() || queued < limit; });
+
+        queued += data.size();
+        queue.emplace_back(file, std::move(data));
+        cv_pop.notify_one();
+        return 1;
+    }
+    //Wait until every queued file is written, 0 if any failed
+    int flush() {
+        std::unique_lock<std::mutex> lck(lock);
+        cv_push.wait(lck, [this]() { return queue.empty() && !active; });
+        return errors.empty();
+    }
+    //Get files that could not be written
+    std::vector<std::string> getErrors() {
+        std::lock_guard<std::mutex> lck(lock);
+        return errors;
+    }
+
+    private:
+        std::mutex lock;
+        std::condition_variable cv_push, cv_pop;
+        std::deque<std::pair<std::string, std::vector<unsigned char>>> queue;
+        std::set<std::string> folders;
+        std::vector<std::string> errors;
+        std::vector<std::thread> workers;
+        unsigned queued = 0, limit, active = 0;
+        bool done = false;
+        convcache *cache = 0;
+
+        std::mutex arc_lock; //Writes to archive, arc itself is only changed holding lock too
+        FILE *arc = 0;
+        std::string arc_name;
+        unsigned long long arc_pos = 0;
+        std::vector<std::tuple<unsigned long long, unsigned, std::string>> arc_toc;
+
+        //Append file to archive as tar entry
+        int setEntry(std::string file, const std::vector<unsigned char> &data) {
+            std::lock_guard<std::mutex> lck(arc_lock);
+            if (!arc) return 0;
+
+            auto set_hdr = [this](const std::string &name, const unsigned size, const char type) -> int {
+                char hdr[512] {};
+                unsigned sum = 0;
+
+                if (name.size() <= 100) memcpy(hdr, name.data(), name.size());
+                else {
+                    //Split long names into prefix and name where possible
+                    auto p = name.find_last_of('/', 155);
+                    if (p != std::string::npos && name.size() - p - 1 <= 100) {
+                        memcpy(hdr + 345, name.data(), p);
+                        memcpy(hdr, name.data() + p + 1, name.size() - p - 1);
+                    }
+                    else memcpy(hdr, name.data(), 100);
+                }
+                snprintf(hdr + 100, 8, "%07o", 0644);
+                snprintf(hdr + 108, 8, "%07o", 0);
+                snprintf(hdr + 116, 8, "%07o", 0);
+                snprintf(hdr + 124, 12, "%011o", size);
+                snprintf(hdr + 136, 12, "%011llo", (unsigned long long)time(0));
+                memset(hdr + 148, ' ', 8);
+                hdr[156] = type;
+                memcpy(hdr + 257, "ustar", 6);
+                memcpy(hdr + 263, "00", 2);
+                for (const auto &h : hdr) sum += (unsigned char)h;
+                snprintf(hdr + 148, 7, "%06o", sum);
+
+                if (fwrite(hdr, 1, 512, arc) != 512) return 0;
+                arc_pos += 512;
+                return 1;
+            };
+            auto set_dat = [this](const unsigned char *data, const unsigned size) -> int {
+                unsigned char pad[512] {};
+                unsigned p = (512 - size % 512) % 512;
+
+                if (size && fwrite(data, 1, size, arc) != size) return 0;
+                if (p && fwrite(pad, 1, p, arc) != p) return 0;
+                arc_pos += size + p;
+                return 1;
+            };
+
+            //Archive names are relative
+            while (file.find("./") == 0) file.erase(0, 2);
+            while (!file.empty() && (file[0] == '/' || file[0] == '\\')) file.erase(0, 1);
+            for (auto &c : file) if (c == '\\') c = '/';
+
+            //GNU long name entry for names that don't fit
+            auto p = file.find_last_of('/', 155);
+            if (file.size() > 100 && (p == std::string::npos || file.size() - p - 1 > 100)) {
+                if (!set_hdr("././@LongLink", file.size() + 1, 'L')) return 0;
+                if (!set_dat((const unsigned char*)file.c_str(), file.size() + 1)) return 0;
+            }
+            if (!set_hdr(file, data.size(), '0')) return 0;
+            arc_toc.emplace_back(arc_pos, data.size(), file);
+            return set_dat(data.data(), data.size());
+        }
+
+        void work() {
+            std::unique_lock<std::mutex> lck(lock);
+            while (true) {
+                cv_pop.wait(lck, [this]() { return done || !queue.empty(); });
+                if (queue.empty()) return;
+
+                auto fle = std::move(queue.front());
+                queue.pop_front();
+                active += 1;
+                const bool is_arc = arc;
+
+                lck.unlock();
+                int ret = (is_arc) ?
+                    setEntry(fle.first, fle.second) :
+                    createFile(fle.first.c_str(), fle.second.data(), fle.second.size());
+                lck.lock();
+
+                active -= 1;
+                queued -= fle.second.size();
+                if (!ret) errors.push_back(fle.first);
+                cv_push.notify_all();
+            }
+        }
+};
+
+
+///Create a folder, through queue if available
+static inline int createFolder(filequeue *queue, const char *folder) {
+    return (queue) ? queue->setFolder(folder) : createFolder(folder);
+}
+
+///Write binary to a file, through queue if available
+static inline int createFile(filequeue *queue, const char *file, const unsigned char *data, unsigned data_size) {
+    if (!queue) return createFile(file, (unsigned char*)data, data_size);
+    return queue->setFile(file, std::vector<unsigned char>(data, data + data_size));
+}
+
+///Write binary to a file, through queue if available, handing buffer over to it
+static inline int createFile(filequeue *queue, const char *file, std::vector<unsigned char> &&data) {
+    if (!queue) return createFile(file, data.data(), data.size());
+    return queue->setFile(file, std::move(data));
+}
+
+///Write C-style string to a file, through queue if available
+static inline int createFile(filequeue *queue, const char *file, const char *data, unsigned data_size) {
+    return createFile(queue, file, (const unsigned char*)data, data_size);
+}
+
+
+#endif
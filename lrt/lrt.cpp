@@ -1,9 +1,19 @@
 #include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <string>
 #include <vector>
+#if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) \
+                      || defined(WIN64) || defined(_WIN64) || defined(__WIN64__)
+    #include <fcntl.h>
+    #include <io.h>
+#endif
 #include "directory.hpp"
+#include "filequeue.hpp"
+#include "parallel.hpp"
+#include "trace.hpp"
 #define PACKCSV_IMPLEMENTATION
+#include "midi/midi_forms.hpp"
 #include "midi/midi_const.hpp"
 #include "midi/midi_types.hpp"
 #include "midi/midi_func.hpp"
@@ -14,7 +24,7 @@
 
 
 ///Unpacks LBRT info from LBRT file
-void unpackLrt(const char *file) {
+void unpackLrt(lbrtctx &ctx, const char *file) {
     if (!file || !file[0]) return;
 
     std::string str;
@@ -23,25 +33,29 @@ void unpackLrt(const char *file) {
     str = file;
     p0 = str.find_last_of("\\/"); if (p0 == std::string::npos) p0 = 0;
     p1 = str.find_last_of('.'); if (p1 == std::string::npos || p1 <= p0) p1 = str.size();
-    if (lrt_debug) fprintf(stderr, "Title of sequence: %s\n", std::string(file + p0 + (p0 > 0), file + p1).c_str());
+    TRACE_STEP(ctx.debug, "Title of sequence: %s\n", std::string(file + p0 + (p0 > 0), file + p1).c_str());
 
     if (file) {
-        unsigned char *data = 0;
+        const unsigned char *data = 0;
         unsigned size = 0;
 
-        if (!getFileData(file, data, size)) {
+        if (!mapFileData(file, data, size)) {
             fprintf(stderr, "    Unable to open %s\n", file);
             return;
         }
-        unpackLrt(data, size);
+        unpackLrt(ctx, (unsigned char*)data, size);
+        unmapFileData(data, size);
     }
-    lrt_inf.path = (!p0) ? "" : std::string(file, file + p0);
-    lrt_inf.name = std::string(file + p0 + (p0 > 0), file + p1);
+    ctx.inf.path = (!p0) ? "" : std::string(file, file + p0);
+    ctx.inf.name = std::string(file + p0 + (p0 > 0), file + p1);
 }
 
+///Unpacks LBRT file into global LBRT info
+void unpackLrt(const char *file) { unpackLrt(lrt_ctx, file); }
+
 ///Unpacks LBRT info from LBRT data
-void unpackLrt(unsigned char *in, const unsigned length) {
-    lrt_inf = {};
+void unpackLrt(lbrtctx &ctx, unsigned char *in, const unsigned length) {
+    ctx.inf = {};
     if (!in || length < 36) return;
 
     const unsigned char *in_beg = in, *in_end = in + length;
@@ -64,243 +78,622 @@ void unpackLrt(unsigned char *in, const unsigned length) {
 
     if (get_fcc() != FOURCC_LBRT) {
         fprintf(stderr, "This is not an LBRT file\n");
-        lrt_inf = {}; return;
+        ctx.inf = {}; return;
     }
-    lrt_inf.soff = get_int(4);
-    lrt_inf.tpc = get_int(4);
-    lrt_inf.ppqn = get_int(4);
+    ctx.inf.soff = get_int(4);
+    ctx.inf.tpc = get_int(4);
+    ctx.inf.ppqn = get_int(4);
 
     try {
-        lrt_inf.trks.resize(get_int(4));
-        if (lrt_inf.trks.empty()) throw std::exception();
-
-        if (lrt_debug) {
-            fprintf(stderr, "    Sequence data at position: 0x%08X\n", lrt_inf.soff);
-            fprintf(stderr, "    Clock ticks per click: %u\n", lrt_inf.tpc);
-            fprintf(stderr, "    Pulses per quarter note: %u\n", lrt_inf.ppqn);
-            fprintf(stderr, "    Total tracks: %u\n", lrt_inf.trks.size());
-        }
+        ctx.inf.trks.resize(get_int(4));
+        if (ctx.inf.trks.empty()) throw std::exception();
+
+        TRACE_STEP(ctx.debug, "    Sequence data at position: 0x%08X\n", ctx.inf.soff);
+        TRACE_STEP(ctx.debug, "    Clock ticks per click: %u\n", ctx.inf.tpc);
+        TRACE_STEP(ctx.debug, "    Pulses per quarter note: %u\n", ctx.inf.ppqn);
+        TRACE_STEP(ctx.debug, "    Total tracks: %u\n", ctx.inf.trks.size());
 
-        for (auto &trk : lrt_inf.trks) {
+        for (auto &trk : ctx.inf.trks) {
+            if (in + 16 > in_end) throw std::exception();
             trk.id = get_int(4);
             trk.unk0 = get_int(4);
             trk.msgs.resize(get_int(4));
             trk.qrts.resize(get_int(4));
             if (trk.msgs.empty() || trk.qrts.empty()) throw std::exception();
+            if (in + 4 * trk.qrts.size() > in_end) throw std::exception();
 
-            if (lrt_debug) {
-                fprintf(stderr, "        Sequence id: %u\n", trk.id);
-                fprintf(stderr, "        Total events: %u\n", trk.msgs.size());
-                fprintf(stderr, "        Total quarter events: %u\n", trk.qrts.size());
-            }
+            TRACE_STEP(ctx.debug, "        Sequence id: %u\n", trk.id);
+            TRACE_STEP(ctx.debug, "        Total events: %u\n", trk.msgs.size());
+            TRACE_STEP(ctx.debug, "        Total quarter events: %u\n", trk.qrts.size());
 
             //Set quarter events
             for (auto &q : trk.qrts) {
                 q = get_int(4);
-                if (lrt_debug) fprintf(stderr, "            Quarter event ID: %04u\n", q);
+                TRACE_FIELD(ctx.debug, "            Quarter event ID: %04u\n", q);
             }
         }
     }
     catch (std::exception &e) {
         fprintf(stderr, "There are no events in this LBRT file\n");
-        lrt_inf = {}; return;
+        ctx.inf = {}; return;
+    }
+
+    //Header only, messages stay unset
+    if (ctx.inf.soff >= length) {
+        TRACE_STEP(ctx.debug, "    No LBRT messages in data\n");
+        return;
     }
 
     //Set messages
-    if (lrt_debug) fprintf(stderr, "    Retrieving LBRT messages\n");
-
-    in = (unsigned char*)in_beg + lrt_inf.soff;
-    for (auto &trk : lrt_inf.trks) {
-        for (auto &msg : trk.msgs) {
-            msg.id = get_int(4);
-            msg.dtim = get_int(4);
-            msg.tval = get_int(4);
-            msg.val0 = get_int(4);
-            msg.val1 = get_int(2);
-            msg.val2 = get_int(2);
-            msg.velon = get_int(2);
-            msg.bndon = get_int(2);
-            msg.chn = get_int(1);
-            msg.stat = get_int(1);
-            msg.veloff = get_int(1);
-            msg.bndoff = get_int(1);
-
-            if (lrt_debug) {
-                fprintf(stderr, "        Current event: %u\n", &msg - trk.msgs.data());
-                fprintf(stderr, "            Quarter Event ID: %u\n", msg.id);
-                fprintf(stderr, "            Delta time: %ums\n", msg.dtim);
-                fprintf(stderr, "            Time value: %u\n", msg.tval);
-                fprintf(stderr, "            Channel event value 1: %u\n", msg.val0);
-                fprintf(stderr, "            Channel event value 2: %u\n", msg.val1);
-                fprintf(stderr, "            Channel event value 3: %u\n", msg.val2);
-                fprintf(stderr, "            Note On velocity: %u\n", msg.velon);
-                fprintf(stderr, "            Note On pitch bend: %u\n", msg.bndon);
-                fprintf(stderr, "            Channel: %u\n", msg.chn);
-                fprintf(stderr, "            Status: 0x%02X\n", msg.stat & 0xFF);
-                fprintf(stderr, "            Note Off velocity: %u\n", msg.veloff);
-                fprintf(stderr, "            Note Off pitch bend: %u\n", msg.bndoff);
+    TRACE_STEP(ctx.debug, "    Retrieving LBRT messages\n");
+
+    in = (unsigned char*)in_beg + ctx.inf.soff;
+    for (auto &trk : ctx.inf.trks) {
+        unsigned siz = trk.msgs.size();
+        if (in + siz * LBRT_MESG_SIZE > in_end) {
+            fprintf(stderr, "    LBRT messages end early\n");
+            siz = (in_end - in) / LBRT_MESG_SIZE;
+            trk.msgs.resize(siz);
+        }
+        trk.msgs.setAll(in, 0, siz);
+        in += siz * LBRT_MESG_SIZE;
+    }
+
+    if constexpr (TRACE_LEVEL >= TRACE_LEVEL_FIELD) {
+        if (ctx.debug) {
+            for (const auto &trk : ctx.inf.trks) {
+                for (unsigned e = 0; e < trk.msgs.size(); ++e) {
+                    const auto msg = trk.msgs[e];
+                    TRACE_FIELD(true, "        Current event: %u\n", e);
+                    TRACE_FIELD(true, "            Quarter Event ID: %u\n", msg.id);
+                    TRACE_FIELD(true, "            Delta time: %ums\n", msg.dtim);
+                    TRACE_FIELD(true, "            Time value: %u\n", msg.tval);
+                    TRACE_FIELD(true, "            Channel event value 1: %u\n", msg.val0);
+                    TRACE_FIELD(true, "            Channel event value 2: %u\n", msg.val1);
+                    TRACE_FIELD(true, "            Channel event value 3: %u\n", msg.val2);
+                    TRACE_FIELD(true, "            Note On velocity: %u\n", msg.velon);
+                    TRACE_FIELD(true, "            Note On pitch bend: %u\n", msg.bndon);
+                    TRACE_FIELD(true, "            Channel: %u\n", msg.chn);
+                    TRACE_FIELD(true, "            Status: 0x%02X\n", msg.stat & 0xFF);
+                    TRACE_FIELD(true, "            Note Off velocity: %u\n", msg.veloff);
+                    TRACE_FIELD(true, "            Note Off pitch bend: %u\n", msg.bndoff);
+                }
             }
         }
     }
 }
 
+///Unpacks LBRT data into global LBRT info
+void unpackLrt(unsigned char *in, const unsigned length) { unpackLrt(lrt_ctx, in, length); }
 
-///Extracts MIDI from LBRT info
-void extractLrt(const char *folder) {
-    if (lrt_inf.empty()) return;
-    if (folder && folder[0]) lrt_inf.path = folder;
-    if (lrt_inf.path.find_last_of("\\/") != lrt_inf.path.size() - 1) lrt_inf.path += "/";
-
-    fprintf(stderr, "Extract from LBRT file to %s\n", lrt_inf.path.c_str());
-    if (!createFolder(lrt_inf.path.c_str())) {
-        fprintf(stderr, "Unable to create %s\n", lrt_inf.path.c_str());
-        lrt_inf = {}; return;
+///Unpacks LBRT header and sub-header from LBRT file, messages are left unread
+void unpackLrtHead(lbrtctx &ctx, const char *file) {
+    if (!file || !file[0]) return;
+
+    std::string str;
+    size_t p0, p1;
+
+    str = file;
+    p0 = str.find_last_of("\\/"); if (p0 == std::string::npos) p0 = 0;
+    p1 = str.find_last_of('.'); if (p1 == std::string::npos || p1 <= p0) p1 = str.size();
+
+    const unsigned char *data = 0;
+    unsigned size = 0, soff = 0;
+
+    if (!mapFileData(file, data, size)) {
+        fprintf(stderr, "    Unable to open %s\n", file);
+        return;
     }
+    if (size >= 8) soff = data[4] | data[5] << 8 | data[6] << 16 | (unsigned)data[7] << 24;
+    unpackLrt(ctx, (unsigned char*)data, (soff < size) ? soff : size);
+    unmapFileData(data, size);
 
-    for (const auto &trk : lrt_inf.trks) {
-        int fabs = 0;
-        std::string nam = lrt_inf.name;
-        if (lrt_inf.trks.size() > 1) nam += "_" + std::to_string(&trk - lrt_inf.trks.data());
+    ctx.inf.path = (!p0) ? "" : std::string(file, file + p0);
+    ctx.inf.name = std::string(file + p0 + (p0 > 0), file + p1);
+}
+
+///Unpacks LBRT header and sub-header from LBRT file into global LBRT info
+void unpackLrtHead(const char *file) { unpackLrtHead(lrt_ctx, file); }
 
-        /* //For tracking bend values
-        unsigned short bends[16] {};
-        for (auto &b : bends) b = 0x40;
-        */
 
+///LBRT Track Conversion
+///  Turns messages of one LBRT track into MIDI tracks as they come
+struct lbrtconv {
+    lbrtconv(lbrtctx &t_c, const std::string &nam) : mid(MIDI_MULTIPLE_TRACK, 1, t_c.inf.ppqn), ctx(t_c) {
         //Assign MIDI header
-        if (lrt_debug) fprintf(stderr, "    Assign MIDI header\n");
-        mid_inf = {MIDI_MULTIPLE_TRACK, 1, lrt_inf.ppqn};
-        mid_inf.msg.resize(17);
+        TRACE_STEP(ctx.debug, "    Assign MIDI header\n");
+        mid.msg.resize(17);
+
+        //Messages are written in order as they come
+        que.reserve(mid.msg.size());
+        for (auto &msg : mid.msg) que.emplace_back(msg);
 
         //Insert global settings
-        if (lrt_debug) fprintf(stderr, "    Set MIDI tracks\n");
-        mid_inf.msg[0].emplace_back(0, META_TRACK_NAME, nam.c_str());
-        mid_inf.msg[0].emplace_back(0, META_TIME_SIGNATURE, (unsigned char[]){4, 2, lrt_inf.tpc, 8});
+        TRACE_STEP(ctx.debug, "    Set MIDI tracks\n");
+        que[0].setMesg(0, META_TRACK_NAME, nam.c_str());
+        que[0].setMesg(0, META_TIME_SIGNATURE, (unsigned char[]){4, 2, (unsigned char)ctx.inf.tpc, 8});
+    }
+    lbrtconv(const lbrtconv &c) = delete;
+    lbrtconv& operator=(const lbrtconv &c) = delete;
 
-        //Set messages
-        for (int e = 1, abs = 0; e < trk.msgs.size(); ++e) {
-            auto chn = trk.msgs[e].chn;
-            short stat = trk.msgs[e].stat;
+    midiinfo mid;
 
-            if (stat != STAT_RESET) stat = stat & 0xF0;
-            else { stat = (stat << 8) | trk.msgs[e].val2; chn = -1; }
+    //Convert message e, 0 once track has ended
+    int setMesg(const lbrtmesgs &msg, const unsigned e) {
+        if (is_end) return 0;
 
-            abs += trk.msgs[e].dtim;
-            if (stat != STAT_NONE) fabs = abs + trk.msgs[e].tval;
+        auto chn = msg.chn[e];
+        short stat = msg.stat[e];
 
-            if (stat == STAT_NONE) {
-                //Theoretically shouldn't do anything
-                if (lrt_debug) fprintf(stderr, "        RUNNING STATUS\n");
-            }
-            else if (stat == STAT_NOTE_OFF) {
-                //NOTE_OFF message found with NOTE_ON
+        if (stat != STAT_RESET) stat = stat & 0xF0;
+        else { stat = (stat << 8) | msg.val2[e]; chn = -1; }
+
+        abs += msg.dtim[e];
+        if (stat != STAT_NONE) fabs = abs + msg.tval[e];
+
+        if (stat == STAT_NONE) {
+            //Theoretically shouldn't do anything
+            TRACE_FIELD(ctx.debug, "        RUNNING STATUS\n");
+        }
+        else if (stat == STAT_NOTE_OFF) {
+            //NOTE_OFF message found with NOTE_ON
+        }
+        else if (stat == STAT_NOTE_ON) {
+            TRACE_FIELD(ctx.debug, "        NOTE ON/OFF EVENT\n");
+            if (que[chn+1].empty()) {
+                que[chn+1].setMesg(0, STAT_CONTROLLER | chn, (unsigned char[]){CC_BANK_SELECT_C, 0});
+                que[chn+1].setMesg(0, STAT_PROGRAMME_CHANGE | chn, (unsigned char[]){(unsigned char)chn});
             }
-            else if (stat == STAT_NOTE_ON) {
-                if (lrt_debug) fprintf(stderr, "        NOTE ON/OFF EVENT\n");
-                    if (mid_inf.msg[chn+1].empty()) {
-                    mid_inf.msg[chn+1].emplace_back(0, STAT_CONTROLLER | chn, (unsigned char[]){CC_BANK_SELECT_C, 0});
-                    mid_inf.msg[chn+1].emplace_back(0, STAT_PROGRAMME_CHANGE | chn, (unsigned char[]){chn});
-                }
 
-                mid_inf.msg[chn+1].emplace_back(abs, STAT_NOTE_ON | chn, (unsigned char[]){trk.msgs[e].val0,trk.msgs[e].velon});
-                mid_inf.msg[chn+1].emplace_back(fabs, STAT_NOTE_OFF | chn, (unsigned char[]){trk.msgs[e].val0,trk.msgs[e].veloff});
+            que[chn+1].setMesg(abs, STAT_NOTE_ON | chn, (unsigned char[]){(unsigned char)msg.val0[e], (unsigned char)msg.velon[e]});
+            que[chn+1].setLater(fabs, STAT_NOTE_OFF | chn, (unsigned char[]){(unsigned char)msg.val0[e], (unsigned char)msg.veloff[e]});
 
-                /* Either these are NOT pitch bend values or the bending range is different... ugh
-                   OR these relate to portamento somehow... double UGH
-                if (bends[chn] != trk.msgs[e].bndon) {
-                    bends[chn] = trk.msgs[e].bndon;
-                    mid_inf.msg[chn+1].push_back({abs, STAT_PITCH_WHEEL | chn, {bends[chn],bends[chn]>>8}});
-                }
-                if (bends[chn] != trk.msgs[e].bndoff) {
-                    bends[chn] = trk.msgs[e].bndoff;
-                    mid_inf.msg[chn+1].push_back({fabs, STAT_PITCH_WHEEL | chn, {bends[chn],bends[chn]>>8}});
-                }
-                */
+            /* Either these are NOT pitch bend values or the bending range is different... ugh
+               OR these relate to portamento somehow... double UGH
+            if (bends[chn] != msg.bndon[e]) {
+                bends[chn] = msg.bndon[e];
+                mid.msg[chn+1].push_back({abs, STAT_PITCH_WHEEL | chn, {bends[chn],bends[chn]>>8}});
             }
-            else if (stat == STAT_KEY_PRESSURE) {
-                //Never seen KEY PRESSURE, likely never will
-                if (lrt_debug) fprintf(stderr, "        KEY PRESSURE\n");
+            if (bends[chn] != msg.bndoff[e]) {
+                bends[chn] = msg.bndoff[e];
+                mid.msg[chn+1].push_back({fabs, STAT_PITCH_WHEEL | chn, {bends[chn],bends[chn]>>8}});
             }
-            else if (stat == STAT_CONTROLLER) {
-                //Sequence uses CC 99 for looping
-                //Will use CC 116/117 instead
-                //Additionally use Final Fantasy style just because
-                if (trk.msgs[e].val2 == LBRT_PSX_LOOP) {
-                    if (trk.msgs[e].val0 == LBRT_PSX_LOOPSTART) {
-                        if (lrt_debug) fprintf(stderr, "        LOOP START EVENT\n");
-                        mid_inf.msg[0].emplace_back(abs, STAT_CONTROLLER, (unsigned char[]){CC_XML_LOOPSTART, CC_XML_LOOPINFINITE});
-                        mid_inf.msg[0].emplace_back(abs, META_MARKER, "loopStart");
-                    }
-                    else if (trk.msgs[e].val0 == LBRT_PSX_LOOPEND) {
-                        if (lrt_debug) fprintf(stderr, "        LOOP STOP EVENT\n");
-                        mid_inf.msg[0].emplace_back(abs, STAT_CONTROLLER, (unsigned char[]){CC_XML_LOOPEND, CC_XML_LOOPRESERVED});
-                        mid_inf.msg[0].emplace_back(abs, META_MARKER, "loopEnd");
-                    }
+            */
+        }
+        else if (stat == STAT_KEY_PRESSURE) {
+            //Never seen KEY PRESSURE, likely never will
+            TRACE_FIELD(ctx.debug, "        KEY PRESSURE\n");
+        }
+        else if (stat == STAT_CONTROLLER) {
+            //Sequence uses CC 99 for looping
+            //Will use CC 116/117 instead
+            //Additionally use Final Fantasy style just because
+            if (msg.val2[e] == LBRT_PSX_LOOP) {
+                if (msg.val0[e] == LBRT_PSX_LOOPSTART) {
+                    TRACE_FIELD(ctx.debug, "        LOOP START EVENT\n");
+                    que[0].setMesg(abs, STAT_CONTROLLER, (unsigned char[]){CC_XML_LOOPSTART, CC_XML_LOOPINFINITE});
+                    que[0].setMesg(abs, META_MARKER, "loopStart");
                 }
-                else {
-                    if (lrt_debug) fprintf(stderr, "        CC %u EVENT\n", trk.msgs[e].val2);
-                    mid_inf.msg[chn+1].emplace_back(abs, stat, (unsigned char[]){trk.msgs[e].val2, trk.msgs[e].val0});
+                else if (msg.val0[e] == LBRT_PSX_LOOPEND) {
+                    TRACE_FIELD(ctx.debug, "        LOOP STOP EVENT\n");
+                    que[0].setMesg(abs, STAT_CONTROLLER, (unsigned char[]){CC_XML_LOOPEND, CC_XML_LOOPRESERVED});
+                    que[0].setMesg(abs, META_MARKER, "loopEnd");
                 }
             }
-            else if (stat == STAT_PROGRAMME_CHANGE) {
-                //Never seen PROGRAMME CHANGE, likely never will
-                if (lrt_debug) fprintf(stderr, "        PROGRAMME CHANGE\n");
-            }
-            else if (stat == STAT_CHANNEL_PRESSURE) {
-                //Never seen CHANNEL PRESSURE, likely never will
-                if (lrt_debug) fprintf(stderr, "        CHANNEL PRESSURE\n");
-            }
-            else if (stat == STAT_PITCH_WHEEL) {
-                //Never seen PITCH WHEEL message, likely found with NOTE_ON
-                if (lrt_debug) fprintf(stderr, "        PITCH WHEEL\n");
-            }
-            else if (stat == META_END_OF_SEQUENCE) {
-                if (lrt_debug) fprintf(stderr, "        END OF TRACK\n");
-                break;
-            }
-            else if (stat == META_TEMPO) {
-                if (lrt_debug) fprintf(stderr, "        TEMPO CHANGE TO %g BPM\n", 60000000.0 / trk.msgs[e].tval);
-                mid_inf.msg[0].emplace_back(
-                    abs,
-                    META_TEMPO,
-                    (unsigned char[]){trk.msgs[e].tval>>16, trk.msgs[e].tval>>8, trk.msgs[e].tval>>0}
-                );
+            else {
+                TRACE_FIELD(ctx.debug, "        CC %u EVENT\n", msg.val2[e]);
+                que[chn+1].setMesg(abs, stat, (unsigned char[]){(unsigned char)msg.val2[e], (unsigned char)msg.val0[e]});
             }
         }
+        else if (stat == STAT_PROGRAMME_CHANGE) {
+            //Never seen PROGRAMME CHANGE, likely never will
+            TRACE_FIELD(ctx.debug, "        PROGRAMME CHANGE\n");
+        }
+        else if (stat == STAT_CHANNEL_PRESSURE) {
+            //Never seen CHANNEL PRESSURE, likely never will
+            TRACE_FIELD(ctx.debug, "        CHANNEL PRESSURE\n");
+        }
+        else if (stat == STAT_PITCH_WHEEL) {
+            //Never seen PITCH WHEEL message, likely found with NOTE_ON
+            TRACE_FIELD(ctx.debug, "        PITCH WHEEL\n");
+        }
+        else if (stat == META_END_OF_SEQUENCE) {
+            TRACE_FIELD(ctx.debug, "        END OF TRACK\n");
+            is_end = true; return 0;
+        }
+        else if (stat == META_TEMPO) {
+            TRACE_FIELD(ctx.debug, "        TEMPO CHANGE TO %g BPM\n", 60000000.0 / msg.tval[e]);
+            que[0].setMesg(
+                abs,
+                META_TEMPO,
+                (unsigned char[]){(unsigned char)(msg.tval[e] >> 16), (unsigned char)(msg.tval[e] >> 8), (unsigned char)msg.tval[e]}
+            );
+        }
 
-        //Remove empty tracks
-        std::erase_if(mid_inf.msg, [](const auto &t) { return t.empty(); });
-        
-        //Add end-of-track event to tracks
-        //Add extra time for those stupid short ones
-        for (auto &trk : mid_inf.msg) trk.emplace_back(fabs + 2000, META_END_OF_SEQUENCE);
+        return 1;
+    }
+    //Add end-of-track event to used tracks, then write out what's left
+    //Add extra time for those stupid short ones
+    void flush() {
+        TRACE_STEP(ctx.debug, "    Finish MIDI tracks\n");
+        for (auto &q : que) {
+            if (!q.empty()) q.setMesg(fabs + 2000, META_END_OF_SEQUENCE);
+            q.flush();
+        }
+    }
+    //Check if every MIDI track came out in order
+    bool isOrdered() const {
+        for (const auto &q : que) if (!q.isOrdered()) return false;
+        return true;
+    }
+
+    private:
+        lbrtctx &ctx;
+        std::vector<mesgqueue> que;
+        int abs = 0, fabs = 0;
+        bool is_end = false;
+
+        /* //For tracking bend values
+        unsigned short bends[16] {};
+        for (auto &b : bends) b = 0x40;
+        */
+};
+
+///Extracts MIDI from LBRT info
+int extractLrt(lbrtctx &ctx, const char *folder) {
+    int ret = 1;
+    if (ctx.inf.empty()) return 0;
+    if (folder && folder[0]) ctx.inf.path = folder;
+    if (ctx.inf.path.find_last_of("\\/") != ctx.inf.path.size() - 1) ctx.inf.path += "/";
+
+    fprintf(stderr, "Extract from LBRT file to %s\n", ctx.inf.path.c_str());
+    if (!createFolder(ctx.queue, ctx.inf.path.c_str())) {
+        fprintf(stderr, "Unable to create %s\n", ctx.inf.path.c_str());
+        ctx.inf = {}; return 0;
+    }
+
+    //Convert tracks independently, each into its own MIDI info
+    std::vector<int> rets(ctx.inf.trks.size(), 1);
+    parallelFor(ctx.jobs, ctx.inf.trks.size(), [&ctx, &rets](const unsigned t) -> void {
+        const auto &trk = ctx.inf.trks[t];
+        std::string nam = ctx.inf.name;
+        if (ctx.inf.trks.size() > 1) nam += "_" + std::to_string(&trk - ctx.inf.trks.data());
 
-        //Sort tracks
-        if (lrt_debug) fprintf(stderr, "    Sort MIDI tracks\n");
-        for (auto &trk : mid_inf.msg) std::sort(trk.begin(), trk.end());
+        //Set messages
+        lbrtconv cnv {ctx, nam};
+        for (unsigned e = 1; e < trk.msgs.size() && cnv.setMesg(trk.msgs, e); ++e);
+        cnv.flush();
+        auto &mid = cnv.mid;
+
+        //Remove empty tracks
+        std::erase_if(mid.msg, [](const auto &t) { return t.empty(); });
 
         //Update number tracks
-        mid_inf.trk = mid_inf.msg.size();
+        mid.trk = mid.msg.size();
 
         //Write MIDI to file
+        unsigned src = 0;
+        unsigned long long hash = 0;
         if (true) {
-            if (lrt_debug) fprintf(stderr, "    Write MIDI file\n");
-            auto out = packMidi();
+            TRACE_STEP(ctx.debug, "    Write MIDI file\n");
+            auto out = packMidi(mid);
+            src = out.size();
+            if (ctx.mev) hash = getHash(out.data(), out.size());
 
-            if (!createFile((lrt_inf.path + nam + ".mid").c_str(), out.data(), out.size())) {
+            if (!createFile(ctx.queue, (ctx.inf.path + nam + ".mid").c_str(), std::move(out))) {
                 fprintf(stderr, "    Unable to extract %s.mid\n", nam.c_str());
-                continue;
+                rets[t] = 0; return;
+            }
+        }
+
+        //Write MIDI event cache if applicable
+        if (ctx.mev) {
+            TRACE_STEP(ctx.debug, "    Write MIDI event cache\n");
+            auto out = packMev(mid, src, hash);
+
+            if (!createFile(ctx.queue, (ctx.inf.path + nam + ".mev").c_str(), std::move(out))) {
+                fprintf(stderr, "    Unable to extract %s.mev\n", nam.c_str());
+                rets[t] = 0;
             }
         }
 
         //Write MIDI to CSV if applicable
-        if (lrt_midicsv) {
-            if (lrt_debug) fprintf(stderr, "    Write MIDICSV file\n");
-            auto out = packCsv();
+        //  Goes straight to file in blocks unless output is queued
+        if (ctx.midicsv) {
+            TRACE_STEP(ctx.debug, "    Write MIDICSV file\n");
+            int is_ok = 1;
+
+            if (ctx.queue) {
+                auto out = packCsv(mid);
+                is_ok = createFile(ctx.queue, (ctx.inf.path + nam + ".csv").c_str(), out.data(), out.size());
+            }
+            else if (FILE *out = fopen((ctx.inf.path + nam + ".csv").c_str(), "wb")) {
+                is_ok = packCsv(mid, [&out](const char *data, const unsigned data_size) -> int {
+                    return fwrite(data, 1, data_size, out) == data_size;
+                });
+                if (fclose(out)) is_ok = 0;
+            }
+            else is_ok = 0;
 
-            if (!createFile((lrt_inf.path + nam + ".csv").c_str(), out.data(), out.size())) {
+            if (!is_ok) {
                 fprintf(stderr, "    Unable to extract %s.csv\n", nam.c_str());
+                rets[t] = 0;
+            }
+        }
+    });
+
+    for (const auto &r : rets) if (!r) ret = 0;
+
+    return ret;
+}
+
+///Extracts MIDI from global LBRT info
+int extractLrt(const char *folder) { return extractLrt(lrt_ctx, folder); }
+
+///Converts LBRT file to MIDI while reading it, memory doesn't grow with sequence length
+///  "-" reads one or more concatenated LBRT files from standard input
+///  MIDI tracks are spilled to temporary files and joined once complete,
+///  files that can't be streamed (MIDICSV, messages out of order) are extracted as usual
+///  Joined MIDI is written to its folder directly, not through ctx.queue
+int streamLrt(lbrtctx &ctx, const char *file, const char *folder) {
+    if (!file || !file[0]) return 0;
+
+    const bool is_std = !strcmp(file, "-");
+    if (!is_std && ctx.midicsv) {
+        unpackLrt(ctx, file);
+        return extractLrt(ctx, folder);
+    }
+    if (is_std && ctx.midicsv) fprintf(stderr, "MIDICSV is not available for standard input\n");
+
+    int ret = 1;
+    std::string str, path, name;
+    size_t p0, p1;
+
+    str = (is_std) ? "stdin" : file;
+    p0 = str.find_last_of("\\/"); if (p0 == std::string::npos) p0 = 0;
+    p1 = str.find_last_of('.'); if (p1 == std::string::npos || p1 <= p0) p1 = str.size();
+    path = (folder && folder[0]) ? folder : (!p0) ? "." : str.substr(0, p0);
+    name = str.substr(p0 + (p0 > 0), p1 - p0 - (p0 > 0));
+    if (path.find_last_of("\\/") != path.size() - 1) path += "/";
+
+    FILE *in = 0;
+    if (!is_std) in = fopen(file, "rb");
+    else {
+#if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) \
+                      || defined(WIN64) || defined(_WIN64) || defined(__WIN64__)
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        in = stdin;
+    }
+    if (!in) {
+        fprintf(stderr, "    Unable to open %s\n", file);
+        return 0;
+    }
+
+    fprintf(stderr, "Stream from LBRT file to %s\n", path.c_str());
+    if (!createFolder(path.c_str())) {
+        fprintf(stderr, "Unable to create %s\n", path.c_str());
+        if (!is_std) fclose(in);
+        return 0;
+    }
+
+    const unsigned CHUNK = 4096;
+    std::vector<unsigned char> buf(CHUNK * LBRT_MESG_SIZE), dat;
+    lbrtmesgs msgs;
+    msgs.resize(CHUNK);
+    unsigned pos = 0;
+
+    auto get_dat = [&in, &pos](unsigned char *data, const unsigned size) -> int {
+        unsigned siz = fread(data, 1, size, in);
+        pos += siz;
+        return siz == size;
+    };
+    auto get_int = [](const unsigned char *in, unsigned length) -> signed {
+        signed out = 0;
+        for (int i = length; i > 0; --i) {
+            out = (out << 8) | in[i - 1];
+        }
+        return out;
+    };
+    auto set_int = [](unsigned char *out, const unsigned in, int length) -> void {
+        while (length--) *(out++) = (in >> (8 * length)) & 0xFF;
+    };
+
+    //Every LBRT in input
+    for (unsigned n = 0; ret; ++n) {
+        std::vector<unsigned> cnts;
+        unsigned char hdr[LBRT_HEAD_SIZE] {};
+
+        pos = 0;
+        if (!get_dat(hdr, LBRT_HEAD_SIZE)) {
+            if (!n || pos) { fprintf(stderr, "This is not an LBRT file\n"); ret = 0; }
+            break;
+        }
+        if ((unsigned)(hdr[0] << 24 | hdr[1] << 16 | hdr[2] << 8 | hdr[3]) != FOURCC_LBRT) {
+            fprintf(stderr, "This is not an LBRT file\n");
+            ret = 0; break;
+        }
+
+        ctx.inf = {};
+        ctx.inf.soff = get_int(hdr + 4, 4);
+        ctx.inf.tpc = get_int(hdr + 8, 4);
+        ctx.inf.ppqn = get_int(hdr + 12, 4);
+        if ((unsigned)get_int(hdr + 16, 4) <= 0xFFFF) ctx.inf.trks.resize(get_int(hdr + 16, 4));
+        ctx.inf.path = path;
+        ctx.inf.name = (!is_std) ? name : name + "_" + std::to_string(n);
+
+        //Sub-header, quarter events are skipped
+        for (auto &trk : ctx.inf.trks) {
+            unsigned char sub[LBRT_TRCK_SIZE];
+            if (!get_dat(sub, LBRT_TRCK_SIZE)) break;
+            trk.id = get_int(sub, 4);
+            trk.unk0 = get_int(sub + 4, 4);
+            cnts.push_back(get_int(sub + 8, 4));
+
+            if (!get_int(sub + 12, 4)) cnts.back() = 0;
+            for (unsigned q = get_int(sub + 12, 4), siz; q; q -= siz) {
+                siz = (q < buf.size() / 4) ? q : buf.size() / 4;
+                if (!get_dat(buf.data(), 4 * siz)) break;
             }
         }
+        if (cnts.empty() || cnts.size() != ctx.inf.trks.size() || std::count(cnts.begin(), cnts.end(), 0)) {
+            fprintf(stderr, "There are no events in this LBRT file\n");
+            ret = 0; break;
+        }
+
+        //Skip to messages
+        if (ctx.inf.soff < pos) { fprintf(stderr, "    No LBRT messages in data\n"); ret = 0; break; }
+        for (unsigned siz; pos < ctx.inf.soff;) {
+            siz = (ctx.inf.soff - pos < buf.size()) ? ctx.inf.soff - pos : buf.size();
+            if (!get_dat(buf.data(), siz)) break;
+        }
+        if (pos < ctx.inf.soff) { fprintf(stderr, "    No LBRT messages in data\n"); ret = 0; break; }
+
+        for (unsigned t = 0; t < cnts.size() && ret; ++t) {
+            std::string nam = ctx.inf.name;
+            if (ctx.inf.trks.size() > 1) nam += "_" + std::to_string(t);
+
+            struct spill {
+                FILE *tmp = 0;
+                unsigned size = 0, beg = 0;
+                bool is_end = false;
+            };
+            std::vector<spill> spl(17);
+            lbrtconv cnv {ctx, nam};
+
+            //Write finished messages out, keeping last one for delta time and running status
+            auto set_spl = [&cnv, &spl, &dat]() -> int {
+                for (unsigned k = 0; k < spl.size(); ++k) {
+                    auto &trk = cnv.mid.msg[k];
+                    auto &s = spl[k];
+                    if (trk.size() <= s.beg) continue;
+
+                    if (!s.is_end) {
+                        dat.resize(trk.getBound());
+                        unsigned siz = trk.getAll(dat.data(), s.beg) - dat.data();
+                        if (siz && !s.tmp && !(s.tmp = tmpfile())) return 0;
+                        if (siz && fwrite(dat.data(), 1, siz, s.tmp) != siz) return 0;
+                        s.size += siz;
+                        for (unsigned i = s.beg; i < trk.size(); ++i) {
+                            if (trk[i].getStat() == META_END_OF_SEQUENCE) { s.is_end = true; break; }
+                        }
+                    }
+
+                    const auto lst = trk.back().getMesg();
+                    trk.clear();
+                    trk.push_back(lst);
+                    s.beg = 1;
+                }
+                return 1;
+            };
+            auto del_spl = [&spl]() -> void {
+                for (auto &s : spl) if (s.tmp) { fclose(s.tmp); s.tmp = 0; }
+            };
+
+            //Set messages, first one is skipped as in extractLrt
+            int is_ok = 1;
+            for (unsigned e = 0; e < cnts[t] && is_ok;) {
+                unsigned siz = (cnts[t] - e < CHUNK) ? cnts[t] - e : CHUNK;
+                if (!get_dat(buf.data(), LBRT_MESG_SIZE * siz)) {
+                    fprintf(stderr, "    LBRT messages of %s end early\n", nam.c_str());
+                    is_ok = 0; break;
+                }
+                msgs.setAll(buf.data(), 0, siz);
+                for (unsigned m = !e; m < siz; ++m) cnv.setMesg(msgs, m);
+                e += siz;
+                if (!cnv.isOrdered()) is_ok = -1;
+                else if (!set_spl()) is_ok = 0;
+            }
+            if (is_ok > 0) {
+                cnv.flush();
+                if (!cnv.isOrdered()) is_ok = -1;
+                else if (!set_spl()) is_ok = 0;
+            }
+
+            //Messages going back in time need the whole track
+            if (is_ok < 0) {
+                del_spl();
+                if (is_std) {
+                    fprintf(stderr, "    LBRT messages of %s are out of order, unable to stream\n", nam.c_str());
+                    ret = 0; break;
+                }
+                fclose(in);
+                unpackLrt(ctx, file);
+                return extractLrt(ctx, folder);
+            }
+
+            //Join MIDI header and spilled tracks
+            FILE *out = (is_ok) ? fopen((path + nam + ".mid").c_str(), "wb") : 0;
+            if (out) {
+                unsigned trks = 0;
+                for (unsigned k = 0; k < spl.size(); ++k) trks += !cnv.mid.msg[k].empty();
+
+                set_int(hdr, FOURCC_MThd, 4);
+                set_int(hdr + 4, 6, 4);
+                set_int(hdr + 8, MIDI_MULTIPLE_TRACK, 2);
+                set_int(hdr + 10, trks, 2);
+                set_int(hdr + 12, cnv.mid.div, 2);
+                if (fwrite(hdr, 1, 14, out) != 14) is_ok = 0;
+
+                for (unsigned k = 0; k < spl.size() && is_ok; ++k) {
+                    if (cnv.mid.msg[k].empty()) continue;
+                    set_int(hdr, FOURCC_MTrk, 4);
+                    set_int(hdr + 4, spl[k].size, 4);
+                    if (fwrite(hdr, 1, 8, out) != 8) { is_ok = 0; break; }
+                    if (!spl[k].tmp) continue;
+
+                    rewind(spl[k].tmp);
+                    for (unsigned siz; (siz = fread(buf.data(), 1, buf.size(), spl[k].tmp));) {
+                        if (fwrite(buf.data(), 1, siz, out) != siz) { is_ok = 0; break; }
+                    }
+                }
+                if (fclose(out)) is_ok = 0;
+            }
+            del_spl();
+
+            if (!is_ok) {
+                fprintf(stderr, "    Unable to extract %s.mid\n", nam.c_str());
+                ret = 0;
+            }
+        }
+
+        if (!is_std) break;
     }
+
+    if (!is_std) fclose(in);
+    return ret;
+}
+
+///Converts LBRT file to MIDI while reading it into global LBRT info
+int streamLrt(const char *file, const char *folder) { return streamLrt(lrt_ctx, file, folder); }
+
+///Extracts LBRT metadata into string, messages are not needed
+std::string probeLrt(lbrtctx &ctx) {
+    std::string out;
+    auto set_fstr = [&out]<typename... T>(const char *in, T&&... args) -> void {
+        int s0 = snprintf(nullptr, 0, in, args...) + 1, s1 = out.size();
+        out.resize(s1 + s0 - 1); snprintf(out.data() + s1, s0, in, args...);
+    };
+    unsigned msgs = 0;
+
+    if (ctx.inf.empty()) return out;
+
+    set_fstr("LBRT: %s\n", ctx.inf.name.c_str());
+    set_fstr("    Sequence Offset: %u\n", ctx.inf.soff);
+    set_fstr("    Ticks per Click: %u\n", ctx.inf.tpc);
+    set_fstr("    Pulses per Quarternote: %d\n", ctx.inf.ppqn);
+    set_fstr("    Tracks: %zu\n", ctx.inf.trks.size());
+    for (const auto &trk : ctx.inf.trks) {
+        set_fstr("        Track: %td\n", &trk - ctx.inf.trks.data());
+        set_fstr("            ID: %u\n", trk.id);
+        set_fstr("            Events: %zu\n", trk.msgs.size());
+        set_fstr("            Quarter Events: %zu\n", trk.qrts.size());
+        msgs += trk.msgs.size();
+    }
+    set_fstr("    Events: %u\n", msgs);
+
+    return out;
 }
+
+///Extracts metadata from global LBRT info into string
+std::string probeLrt() { return probeLrt(lrt_ctx); }
@@ -10,5 +10,12 @@ enum LbrtSeqdCC : unsigned char {
     LBRT_PSX_LOOPEND            = 0x1E,
 };
 
+///LBRT Record Sizes
+enum LbrtSize : unsigned {
+    LBRT_HEAD_SIZE              = 20,
+    LBRT_TRCK_SIZE              = 16,
+    LBRT_MESG_SIZE              = 28,
+};
+
 
 #endif
@@ -8,13 +8,23 @@
 #endif
 
 
-inline extern bool lrt_debug = false, lrt_midicsv = false;
-inline extern lbrtinfo lrt_inf {};
+inline extern lbrtctx lrt_ctx {};
+inline extern bool &lrt_debug = lrt_ctx.debug, &lrt_midicsv = lrt_ctx.midicsv, &lrt_mev = lrt_ctx.mev;
+inline extern lbrtinfo &lrt_inf = lrt_ctx.inf;
 
+void unpackLrt(lbrtctx &ctx, const char *file = 0);
+void unpackLrt(lbrtctx &ctx, unsigned char *in, const unsigned length);
+void unpackLrtHead(lbrtctx &ctx, const char *file);
 void unpackLrt(const char *file = 0);
 void unpackLrt(unsigned char *in, const unsigned length);
-
-void extractLrt(const char *folder = 0);
+void unpackLrtHead(const char *file);
+
+int extractLrt(lbrtctx &ctx, const char *folder = 0);
+int extractLrt(const char *folder = 0);
+int streamLrt(lbrtctx &ctx, const char *file, const char *folder = 0);
+int streamLrt(const char *file, const char *folder = 0);
+std::string probeLrt(lbrtctx &ctx);
+std::string probeLrt();
 
 
 #endif
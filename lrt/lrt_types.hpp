@@ -1,8 +1,12 @@
 #ifndef LBRT_TYPES_HPP
 #define LBRT_TYPES_HPP
 
+#include <bit>
+#include <cstring>
 #include <string>
+#include <type_traits>
 #include <vector>
+#include "lrt_const.hpp"
 
 ///LBRT Message Info
 struct lbrtmesg {
@@ -22,11 +26,67 @@ struct lbrtmesg {
     bool operator==(const lbrtmesg &m) const = default;
 };
 
+///LBRT Message Fields
+///  Fields are kept as columns, records are decoded in bulk
+struct lbrtmesgs {
+    std::vector<signed> id, dtim, tval, val0;
+    std::vector<short> val1, val2, velon, bndon;
+    std::vector<char> chn, stat, veloff, bndoff;
+
+    bool operator==(const lbrtmesgs &m) const = default;
+
+    //Get number of messages
+    unsigned size() const { return id.size(); }
+    //Check if empty
+    bool empty() const { return id.empty(); }
+    //Set number of messages
+    void resize(const unsigned &siz) {
+        id.resize(siz); dtim.resize(siz); tval.resize(siz); val0.resize(siz);
+        val1.resize(siz); val2.resize(siz); velon.resize(siz); bndon.resize(siz);
+        chn.resize(siz); stat.resize(siz); veloff.resize(siz); bndoff.resize(siz);
+    }
+    //Get message
+    lbrtmesg operator[](const unsigned &i) const {
+        return {
+            id[i], dtim[i], tval[i], val0[i], val1[i], val2[i], velon[i], bndon[i],
+            chn[i], stat[i], veloff[i], bndoff[i]
+        };
+    }
+
+    //Decode siz LBRT_MESG_SIZE-byte records into messages from beg on
+    void setAll(const unsigned char *in, const unsigned beg, const unsigned siz) {
+        //Little-endian fields are loaded whole where possible
+        auto get_int = []<typename T>(const unsigned char *in, T &out) -> void {
+            if constexpr (std::endian::native == std::endian::little) std::memcpy(&out, in, sizeof(T));
+            else {
+                std::make_unsigned_t<T> tmp = 0;
+                for (int i = sizeof(T); i > 0; --i) tmp = (tmp << 8) | in[i - 1];
+                out = tmp;
+            }
+        };
+
+        for (unsigned i = beg, end = beg + siz; i < end; ++i, in += LBRT_MESG_SIZE) {
+            get_int(in +  0, id[i]);
+            get_int(in +  4, dtim[i]);
+            get_int(in +  8, tval[i]);
+            get_int(in + 12, val0[i]);
+            get_int(in + 16, val1[i]);
+            get_int(in + 18, val2[i]);
+            get_int(in + 20, velon[i]);
+            get_int(in + 22, bndon[i]);
+            chn[i] = in[24];
+            stat[i] = in[25];
+            veloff[i] = in[26];
+            bndoff[i] = in[27];
+        }
+    }
+};
+
 ///LBRT Track Info
 struct lbrttrck {
     unsigned id;
     unsigned unk0;
-    std::vector<lbrtmesg> msgs;
+    lbrtmesgs msgs;
     std::vector<unsigned> qrts;
 
     bool operator==(const lbrttrck &t) const = default;
@@ -51,5 +111,16 @@ struct lbrtinfo {
     }
 };
 
+struct filequeue;
+
+///LBRT Conversion Context
+struct lbrtctx {
+    bool debug = false, midicsv = false;
+    bool mev = false; //Write MIDI event cache next to each MIDI
+    unsigned jobs = 0; //Worker threads, 0 for all cores
+    filequeue *queue = 0; //Write-behind output, 0 for direct writes
+    lbrtinfo inf {};
+};
+
 
 #endif
@@ -1,97 +1,203 @@
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <functional>
 #include <string>
-#include <format>
 #include <vector>
 #include "midi_const.hpp"
 #include "midi_types.hpp"
 #include "midi_func.hpp"
+#include "../directory.hpp"
 
 
-///Packs variable messages from MIDI chunk to MIDICSV-style string
-std::string packCsv() {
-    std::string csv = "";
-    auto set_fstr = [&csv]<typename... T>(std::format_string<T...> in, T&&... args) -> void {
-        csv += std::format(in, std::forward<T>(args)...);
+///MIDICSV Record Forms
+///  What follows the record name
+enum CsvForm : unsigned char {
+    CSV_SKIP,                   //Not written
+    CSV_UNKNOWN,                //Status, size, data bytes
+    CSV_SIZED,                  //Size, data bytes
+    CSV_BYTES,                  //Data bytes
+    CSV_CHANNEL,                //Channel, data bytes
+    CSV_PITCH,                  //Channel, 14-bit bend
+    CSV_END,                    //Nothing
+    CSV_SEQUENCE,               //16-bit number
+    CSV_TEMPO,                  //24-bit tempo
+    CSV_KEY,                    //Key, major/minor
+    CSV_TEXT,                   //Quoted text
+};
+
+///MIDICSV Record Info
+struct csvrecord {
+    const char *name = "UNKNOWN_META_EVENT";
+    unsigned char size = 18;
+    CsvForm form = CSV_UNKNOWN;
+};
+
+///Gets MIDICSV record of a status
+static const csvrecord& getRecord(const short &st) {
+    static const auto tbl = []() {
+        std::array<csvrecord, 512> out {};
+        auto set_rec = [&out](const short st, const char *name, const CsvForm form) -> void {
+            out[st + 256] = {name, (unsigned char)strlen(name), form};
+        };
+
+        set_rec(META_SEQUENCE_ID, "SEQUENCE_NUMBER", CSV_SEQUENCE);
+        set_rec(META_TEXT, "TEXT_T", CSV_TEXT);
+        set_rec(META_COPYRIGHT, "COPYRIGHT_T", CSV_TEXT);
+        set_rec(META_TRACK_NAME, "TITLE_T", CSV_TEXT);
+        set_rec(META_INSTRUMENT_NAME, "INSTRUMENT_NAME_T", CSV_TEXT);
+        set_rec(META_LYRICS, "LYRIC_T", CSV_TEXT);
+        set_rec(META_MARKER, "MARKER_T", CSV_TEXT);
+        set_rec(META_CUE, "CUE_POINT_T", CSV_TEXT);
+        set_rec(META_PATCH_NAME, "INSTRUMENT_NAME_T", CSV_TEXT);
+        set_rec(META_PORT_NAME, "TEXT_T", CSV_TEXT);
+        set_rec(META_MISC_TEXT_A, "TEXT_T", CSV_TEXT);
+        set_rec(META_MISC_TEXT_B, "TEXT_T", CSV_TEXT);
+        set_rec(META_MISC_TEXT_C, "TEXT_T", CSV_TEXT);
+        set_rec(META_MISC_TEXT_D, "TEXT_T", CSV_TEXT);
+        set_rec(META_MISC_TEXT_E, "TEXT_T", CSV_TEXT);
+        set_rec(META_MISC_TEXT_F, "TEXT_T", CSV_TEXT);
+        set_rec(META_CHANNEL_PREFIX, "CHANNEL_PREFIX", CSV_BYTES);
+        set_rec(META_PORT, "MIDI_PORT", CSV_BYTES);
+        set_rec(META_END_OF_SEQUENCE, "END_TRACK", CSV_END);
+        set_rec(META_TEMPO, "TEMPO", CSV_TEMPO);
+        set_rec(META_SMPTE, "SMPTE_OFFSET", CSV_BYTES);
+        set_rec(META_TIME_SIGNATURE, "TIME_SIGNATURE", CSV_BYTES);
+        set_rec(META_KEY_SIGNATURE, "KEY_SIGNATURE", CSV_KEY);
+        set_rec(META_SEQUENCER_EXCLUSIVE, "SEQUENCER_SPECIFIC", CSV_SIZED);
+        set_rec(META_NONE, "", CSV_SKIP);
+        set_rec(STAT_NONE, "", CSV_SKIP);
+        set_rec(STAT_NOTE_OFF, "NOTE_OFF_C", CSV_CHANNEL);
+        set_rec(STAT_NOTE_ON, "NOTE_ON_C", CSV_CHANNEL);
+        set_rec(STAT_KEY_PRESSURE, "POLY_AFTERTOUCH_C", CSV_CHANNEL);
+        set_rec(STAT_CONTROLLER, "CONTROL_C", CSV_CHANNEL);
+        set_rec(STAT_PROGRAMME_CHANGE, "PROGRAM_C", CSV_CHANNEL);
+        set_rec(STAT_CHANNEL_PRESSURE, "CHANNEL_AFTERTOUCH_C", CSV_CHANNEL);
+        set_rec(STAT_PITCH_WHEEL, "PITCH_BEND_C", CSV_PITCH);
+        //Empty field after these is how they've always been written
+        set_rec(STAT_SYSTEM_EXCLUSIVE_STOP, "SYSTEM_EXCLUSIVE_PACKET, ", CSV_SIZED);
+        set_rec(STAT_SYSTEM_EXCLUSIVE, "SYSTEM_EXCLUSIVE, ", CSV_SIZED);
+
+        return out;
+    }();
+    static const csvrecord unk {};
+
+    if (st < -256 || st > 255) return unk;
+    return tbl[st + 256];
+}
+
+///Packs variable messages from MIDI chunk as MIDICSV into sink, one call per block
+int packCsv(const midiinfo &mid, const std::function<int(const char*, const unsigned)> &sink) {
+    //Block is flushed once past its size, records never need more than the slack
+    //  Text longer than that goes out in pieces
+    const unsigned BLOCK = 1 << 16, SLACK = 256;
+    std::vector<char> buf(BLOCK + SLACK);
+    char *out = buf.data();
+    int ret = 1;
+
+    auto set_blk = [&]() -> void {
+        if (ret && out > buf.data()) ret = sink(buf.data(), out - buf.data());
+        out = buf.data();
+    };
+    auto set_str = [&](const char *in, unsigned size) -> void {
+        while (size) {
+            unsigned siz = buf.data() + buf.size() - out;
+            if (siz > size) siz = size;
+            out = std::copy(in, in + siz, out);
+            in += siz; size -= siz;
+            if (out - buf.data() >= BLOCK) set_blk();
+        }
+    };
+    auto set_lit = [&set_str]<unsigned N>(const char (&in)[N]) -> void { set_str(in, N - 1); };
+    auto set_int = [&out](const auto in) -> void {
+        out = std::to_chars(out, out + 24, in).ptr;
+        *(out++) = ','; *(out++) = ' ';
+    };
+    //Last field ends the line instead
+    auto set_end = [&]() -> void {
+        out[-2] = '\n'; out -= 1;
+        if (out - buf.data() >= BLOCK) set_blk();
     };
 
-    set_fstr("0, 0, HEADER, {0:d}, {1:d}, {2:d}\n", mid_inf.fmt, mid_inf.trk, mid_inf.div);
-    for (const auto &msg : mid_inf.msg) {
-        unsigned id = 1 + (&msg - mid_inf.msg.data());
+    set_lit("0, 0, HEADER, ");
+    set_int(mid.fmt); set_int(mid.trk); set_int(mid.div); set_end();
+    for (const auto &msg : mid.msg) {
+        unsigned id = 1 + (&msg - mid.msg.data());
 
-        set_fstr("{0:d}, 0, START_TRACK\n", id);
+        set_int(id); set_lit("0, START_TRACK"); *(out++) = '\n';
         for (const auto &m : msg) {
-            std::string txt = "";
             const auto &tm = m.getTime();
             const auto &st = m.getStat();
             const auto &ch = m.getChan();
             const auto &dt = m.getData();
+            const auto &rec = getRecord(st);
 
-            switch(st) {
-                case META_SEQUENCE_ID:          txt = "SEQUENCE_NUMBER"; break;
-                case META_TEXT:                 txt = "TEXT_T"; break;
-                case META_COPYRIGHT:            txt = "COPYRIGHT_T"; break;
-                case META_TRACK_NAME:           txt = "TITLE_T"; break;
-                case META_INSTRUMENT_NAME:      txt = "INSTRUMENT_NAME_T"; break;
-                case META_LYRICS:               txt = "LYRIC_T"; break;
-                case META_MARKER:               txt = "MARKER_T"; break;
-                case META_CUE:                  txt = "CUE_POINT_T"; break;
-                case META_PATCH_NAME:           txt = "INSTRUMENT_NAME_T"; break;
-                case META_PORT_NAME:
-                case META_MISC_TEXT_A:
-                case META_MISC_TEXT_B:
-                case META_MISC_TEXT_C:
-                case META_MISC_TEXT_D:
-                case META_MISC_TEXT_E:
-                case META_MISC_TEXT_F:          txt = "TEXT_T"; break;
-                case META_CHANNEL_PREFIX:       txt = "CHANNEL_PREFIX"; break;
-                case META_PORT:                 txt = "MIDI_PORT"; break;
-                case META_END_OF_SEQUENCE:      txt = "END_TRACK"; break;
-                case META_TEMPO:                txt = "TEMPO"; break;
-                case META_SMPTE:                txt = "SMPTE_OFFSET"; break;
-                case META_TIME_SIGNATURE:       txt = "TIME_SIGNATURE"; break;
-                case META_KEY_SIGNATURE:        txt = "KEY_SIGNATURE"; break;
-                case META_SEQUENCER_EXCLUSIVE:  txt = "SEQUENCER_SPECIFIC"; break;
-                case META_NONE:
-                case STAT_NONE:                 continue;
-                case STAT_NOTE_OFF:             txt = "NOTE_OFF_C"; break;
-                case STAT_NOTE_ON:              txt = "NOTE_ON_C"; break;
-                case STAT_KEY_PRESSURE:         txt = "POLY_AFTERTOUCH_C"; break;
-                case STAT_CONTROLLER:           txt = "CONTROL_C"; break;
-                case STAT_PROGRAMME_CHANGE:     txt = "PROGRAM_C"; break;
-                case STAT_CHANNEL_PRESSURE:     txt = "CHANNEL_AFTERTOUCH_C"; break;
-                case STAT_PITCH_WHEEL:          txt = "PITCH_BEND_C"; break;
-                case STAT_SYSTEM_EXCLUSIVE_STOP:txt = "_PACKET";
-                case STAT_SYSTEM_EXCLUSIVE:     txt = "SYSTEM_EXCLUSIVE" + txt + ", "; break;
-                default:                        txt = "UNKNOWN_META_EVENT"; break;
+            if (rec.form == CSV_SKIP) continue;
+
+            set_int(id); set_int(tm);
+            set_str(rec.name, rec.size); *(out++) = ','; *(out++) = ' ';
+
+            switch(rec.form) {
+                case CSV_UNKNOWN:   set_int((st < 0) ? -st : st & 0xFF); [[fallthrough]];
+                case CSV_SIZED:     set_int(dt.size()); break;
+                case CSV_CHANNEL:
+                case CSV_PITCH:     set_int((int)ch); break;
+                default:            break;
+            }
+
+            switch(rec.form) {
+                case CSV_END:
+                    set_end(); break;
+                case CSV_SEQUENCE:
+                    set_int((unsigned short)dt[0] << 8 | dt[1]); set_end(); break;
+                case CSV_PITCH:
+                    set_int((unsigned short)(dt[1] & 0x7F) << 7 | (dt[0] & 0x7F)); set_end(); break;
+                case CSV_TEMPO:
+                    set_int((unsigned)dt[0] << 16 | (unsigned)dt[1] << 8 | dt[2] << 0); set_end(); break;
+                case CSV_KEY:
+                    set_int((int)(char)dt[0]);
+                    if (!dt[1]) set_lit("\"major\"\n");
+                    else set_lit("\"minor\"\n");
+                    break;
+                case CSV_TEXT:
+                    *(out++) = '"'; set_str((const char*)dt.data(), dt.size());
+                    *(out++) = '"'; *(out++) = '\n';
+                    break;
+                default:
+                    for (const auto &d : dt) {
+                        if (out - buf.data() >= BLOCK) set_blk();
+                        set_int(d);
+                    }
+                    if (!dt.empty()) set_end();
+                    break;
             }
-            
-            set_fstr("{0:d}, {1:d}, {2:s}, ", id, tm, txt);
-            if (txt == "UNKNOWN_META_EVENT")
-                set_fstr("{0:d}, ", (st < 0) ? -st : st & 0xFF);
-            if (txt.find("UNKNOWN") != std::string::npos)
-                set_fstr("{0:d}, ", dt.size());
-            else if (txt.find("EXCLUSIVE") != std::string::npos)
-                set_fstr("{0:d}, ", dt.size());
-            else if (txt.find("SPECIFIC") != std::string::npos)
-                set_fstr("{0:d}, ", dt.size());
-            if (txt.ends_with("_C"))
-                set_fstr("{0:d}, ", ch);
-            if (txt == "END_TRACK")
-                csv.replace(csv.rfind(", "), 2, "\n");
-            else if (txt == "SEQUENCE_NUMBER")
-                set_fstr("{0:d}\n", (unsigned short)dt[0] << 8 | dt[1]);
-            else if (txt == "PITCH_BEND_C")
-                set_fstr("{0:d}\n", (unsigned short)(dt[1] & 0x7F) << 7 | dt[0] & 0x7F);
-            else if (txt == "TEMPO")
-                set_fstr("{0:d}\n", (unsigned)dt[0] << 16 | (unsigned)dt[1] << 8 | dt[2] << 0);
-            else if (txt == "KEY_SIGNATURE")
-                set_fstr("{0:d}, \"{1:s}\"\n", (char)dt[0], !dt[1] ? "major" : "minor");
-            else if (txt.ends_with("_T"))
-                set_fstr("\"{0:s}\"\n", std::string(dt.begin(), dt.end()));
-            else
-                for (const auto &d : dt) set_fstr("{0:d}{1:s}", d, (&d < &dt.back()) ? ", " : "\n");
+
+            if (out - buf.data() >= BLOCK) set_blk();
         }
     }
-    csv += "0, 0, END_OF_FILE\n";
+    set_lit("0, 0, END_OF_FILE\n");
+    set_blk();
+
+    return ret;
+}
+
+///Packs MIDICSV data from MIDI info into file descriptor
+int packCsv(const midiinfo &mid, const int fd) {
+    return packCsv(mid, [&fd](const char *data, const unsigned data_size) -> int {
+        return writeFileData(fd, (const unsigned char*)data, data_size);
+    });
+}
+
+///Packs variable messages from MIDI chunk to MIDICSV-style string
+std::string packCsv(const midiinfo &mid) {
+    std::string csv = "";
+    packCsv(mid, [&csv](const char *data, const unsigned data_size) -> int {
+        csv.append(data, data_size);
+        return 1;
+    });
 
     return csv;
 }
+
+///Packs MIDICSV data from global MIDI info
+std::string packCsv() { return packCsv(mid_inf); }
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "midi_func.hpp"
+#include "midi_forms.hpp"
+#include "midi_const.hpp"
+#include "midi_types.hpp"
+
+
+///MIDI Event Cache Header
+///  Everything is in host byte order, mark tells if it still is
+struct mevhead {
+    unsigned char fcc[4];
+    unsigned vers;
+    unsigned mark;
+    unsigned short fmt, trk, div, pad;
+    unsigned src;
+    unsigned lbeg, lend;
+    unsigned tempo_size, tempo_offs;
+    unsigned trks_offs;
+    unsigned size;
+    unsigned long long hash;
+};
+
+///MIDI Event Cache Track Entry
+struct mevchnk {
+    unsigned recs_offs, recs_size;
+    unsigned arena_offs, arena_size;
+};
+
+static const unsigned MEV_VERSION = 2, MEV_MARK = 0x01020304;
+
+
+///Packs MIDI event cache from MIDI info
+///  src and hash are size and hash of the MIDI data it stands for, so stale caches can be told apart
+std::vector<unsigned char> packMev(const midiinfo &mid, const unsigned src, const unsigned long long hash) {
+    if (mid.msg.empty() || mid.div & 0x8000) return {};
+
+    std::vector<mevtempo> tmps;
+    std::vector<mevchnk> chks(mid.msg.size());
+    unsigned lbeg = -1, lend = -1;
+    unsigned siz = sizeof(mevhead) + sizeof(mevchnk) * chks.size();
+
+    //Tempo changes by tick, later tracks win ties as in playback
+    for (const auto &trk : mid.msg) {
+        for (const auto &m : trk) {
+            const auto st = m.getStat();
+            const auto dt = m.getData();
+
+            if (st == META_TEMPO && dt.size() >= 3) {
+                tmps.push_back({m.getTime(), (unsigned)dt[0] << 16 | (unsigned)dt[1] << 8 | dt[2], 0});
+            }
+            else if (st == META_MARKER) {
+                const std::string txt(dt.begin(), dt.end());
+                if (txt == "loopStart") lbeg = std::min(lbeg, m.getTime());
+                else if (txt == "loopEnd") lend = std::min(lend, m.getTime());
+            }
+            else if (st == STAT_CONTROLLER && dt.size() >= 1) {
+                if (dt[0] == CC_XML_LOOPSTART) lbeg = std::min(lbeg, m.getTime());
+                else if (dt[0] == CC_XML_LOOPEND) lend = std::min(lend, m.getTime());
+            }
+        }
+    }
+    std::stable_sort(tmps.begin(), tmps.end(), [](const mevtempo &a, const mevtempo &b) { return a.tick < b.tick; });
+    for (unsigned i = 0, tck = 0, tmp = 500000, msc = 0; i < tmps.size(); ++i) {
+        msc += (int)((tmps[i].tick - tck) * (tmp / (1000.0 * mid.div)));
+        tmps[i].msec = msc;
+        tck = tmps[i].tick; tmp = tmps[i].tempo;
+    }
+
+    const unsigned tmp_offs = siz;
+    siz += sizeof(mevtempo) * tmps.size();
+    for (unsigned t = 0; t < chks.size(); ++t) {
+        unsigned arena = 0;
+        for (const auto &m : mid.msg[t]) if (m.getData().size() > sizeof(unsigned)) arena += m.getData().size();
+
+        chks[t].recs_offs = siz;
+        chks[t].recs_size = mid.msg[t].size();
+        siz += sizeof(mevmesg) * chks[t].recs_size;
+        chks[t].arena_offs = siz;
+        chks[t].arena_size = arena;
+        siz += (arena + 3) & ~3;
+    }
+
+    std::vector<unsigned char> out(siz);
+    mevhead hdr {};
+    memcpy(hdr.fcc, "MEVC", 4);
+    hdr.vers = MEV_VERSION; hdr.mark = MEV_MARK;
+    hdr.fmt = mid.fmt; hdr.trk = mid.msg.size(); hdr.div = mid.div;
+    hdr.src = src; hdr.hash = hash;
+    hdr.lbeg = lbeg; hdr.lend = lend;
+    hdr.tempo_size = tmps.size(); hdr.tempo_offs = tmp_offs;
+    hdr.trks_offs = sizeof(mevhead);
+    hdr.size = siz;
+
+    memcpy(out.data(), &hdr, sizeof(mevhead));
+    memcpy(out.data() + sizeof(mevhead), chks.data(), sizeof(mevchnk) * chks.size());
+    if (!tmps.empty()) memcpy(out.data() + tmp_offs, tmps.data(), sizeof(mevtempo) * tmps.size());
+
+    for (unsigned t = 0; t < chks.size(); ++t) {
+        unsigned char *recs = out.data() + chks[t].recs_offs, *arena = out.data() + chks[t].arena_offs;
+        unsigned pos = 0;
+
+        for (const auto &m : mid.msg[t]) {
+            const auto dt = m.getData();
+            mevmesg rec {m.getTime(), m.getStat(), m.getChan(), 0, dt.size(), 0};
+
+            if (dt.size() <= sizeof(unsigned)) memcpy(&rec.dval, dt.data(), dt.size());
+            else { rec.dval = pos; memcpy(arena + pos, dt.data(), dt.size()); pos += dt.size(); }
+
+            memcpy(recs, &rec, sizeof(mevmesg));
+            recs += sizeof(mevmesg);
+        }
+    }
+
+    return out;
+}
+
+///Unpacks MIDI event cache view from cache data, data has to stay valid
+///  Layout and payload ranges are checked once, records are used as they are after
+int unpackMev(mevinfo &mev, const unsigned char *in, const unsigned length) {
+    mev = {};
+    if (!in || length < sizeof(mevhead) || (size_t)in % alignof(mevhead)) return 0;
+
+    mevhead hdr;
+    memcpy(&hdr, in, sizeof(mevhead));
+    if (memcmp(hdr.fcc, "MEVC", 4) || hdr.vers != MEV_VERSION || hdr.mark != MEV_MARK) return 0;
+    if (hdr.size != length || !hdr.div || hdr.div & 0x8000) return 0;
+
+    auto is_in = [&length](const unsigned offs, const unsigned long long size) -> bool {
+        return offs <= length && size <= length - offs && !(offs % 4);
+    };
+    if (!is_in(hdr.trks_offs, (unsigned long long)sizeof(mevchnk) * hdr.trk)) return 0;
+    if (!is_in(hdr.tempo_offs, (unsigned long long)sizeof(mevtempo) * hdr.tempo_size)) return 0;
+
+    const mevchnk *chks = (const mevchnk*)(in + hdr.trks_offs);
+    mev.msg.reserve(hdr.trk);
+    for (unsigned t = 0; t < hdr.trk; ++t) {
+        const auto &c = chks[t];
+        if (!is_in(c.recs_offs, (unsigned long long)sizeof(mevmesg) * c.recs_size)) { mev = {}; return 0; }
+        if (!is_in(c.arena_offs, c.arena_size)) { mev = {}; return 0; }
+
+        //Payloads are read without checks later, so every one has to lie in its arena
+        const mevmesg *recs = (const mevmesg*)(in + c.recs_offs);
+        for (unsigned r = 0; r < c.recs_size; ++r) {
+            if (recs[r].dsiz <= sizeof(unsigned)) continue;
+            if (recs[r].dval > c.arena_size || recs[r].dsiz > c.arena_size - recs[r].dval) { mev = {}; return 0; }
+        }
+        mev.msg.push_back({recs, c.recs_size, in + c.arena_offs});
+    }
+
+    mev.fmt = hdr.fmt;
+    mev.trk = hdr.trk;
+    mev.div = hdr.div;
+    mev.src = hdr.src;
+    mev.hash = hdr.hash;
+    mev.lbeg = hdr.lbeg;
+    mev.lend = hdr.lend;
+    mev.tempo = (const mevtempo*)(in + hdr.tempo_offs);
+    mev.tempo_size = hdr.tempo_size;
+
+    return 1;
+}
@@ -1,36 +1,46 @@
+#include <algorithm>
+#include <functional>
 #include <utility>
 #include <vector>
 #include "midi_func.hpp"
 #include "midi_forms.hpp"
 #include "midi_const.hpp"
 #include "midi_types.hpp"
+#include "../directory.hpp"
+#include "../parallel.hpp"
 
 
-///Unpacks variable MIDI messages from MTRK data
-void unpackMesg(unsigned char *in, const unsigned length) {
-    mid_inf.msg.emplace_back();
-    if (!in || length < 2) { mid_inf.msg.pop_back(); return; }
-
+///Unpacks variable MIDI messages from MTRK data into track
+///  Every read is checked against the end, a cut off message ends the track
+static void unpackTrack(mesgtrack &out, const unsigned char *in, const unsigned length) {
     const unsigned char *in_end = in + length;
     short t_st = STAT_NONE;
     unsigned t_ab = 0;
-    auto &out = mid_inf.msg.back();
 
-    auto get_vlv = [&in]() -> unsigned {
-        unsigned out = 0;
-        do { out = (out << 7) | (in[0] & 0x7F); } while(*(in++) & 0x80);
-        return out;
+    //Most messages take 3 or 4 bytes
+    out.reserve(length / 4);
+
+    auto get_vlv = [&in, &in_end](unsigned &out) -> bool {
+        out = 0;
+        for (int i = 0; i < 4 && in < in_end; ++i) {
+            out = (out << 7) | (in[0] & 0x7F);
+            if (!(*(in++) & 0x80)) return true;
+        }
+        return false;
     };
 
     while (in < in_end) {
-        std::vector<unsigned char> t_vl;
-        
+        const unsigned char *t_dt;
+        unsigned t_ln = 0, t_dl;
+
         //Get delta time
-        t_ab += get_vlv();
+        if (!get_vlv(t_dl) || in >= in_end) break;
+        t_ab += t_dl;
 
         //Get status
         if (!(in[0] & 0x80) && (t_st == STAT_NONE)) continue;
         else if (in[0] & 0x80) t_st = *(in++);
+        t_dt = in;
 
         //Get message
         switch (t_st & 0xF0) {
@@ -40,36 +50,43 @@ void unpackMesg(unsigned char *in, const unsigned length) {
             case STAT_KEY_PRESSURE:
             case STAT_CONTROLLER:
             case STAT_PITCH_WHEEL:
-                t_vl.push_back(*(in++));
+                t_ln += 1;
             //Has 1 data byte
             case STAT_PROGRAMME_CHANGE:
             case STAT_CHANNEL_PRESSURE:
-                t_vl.push_back(*(in++));
+                t_ln += 1;
                 break;
             case 0xF0:
-                if (t_st == STAT_RESET) t_st = (t_st << 8) | *(in++);
+                if (t_st == STAT_RESET) {
+                    if (in >= in_end) return;
+                    t_st = (t_st << 8) | *(in++);
+                }
 
                 if (t_st == STAT_SYSTEM_EXCLUSIVE ||
                     t_st == STAT_SYSTEM_EXCLUSIVE_STOP ||
                     t_st < 0) {
-                    
-                    t_vl.resize(get_vlv());
-                    for (auto &v : t_vl) v = *(in++);
+
+                    if (!get_vlv(t_ln)) return;
+                    t_dt = in;
                 }
                 else {
                     switch (t_st) {
                         case STAT_SEQUENCE_POINTER:
-                            t_vl.push_back(*(in++));
+                            t_ln += 1;
                         case STAT_QUARTER_FRAME:
                         case STAT_SEQUENCE_REQUEST:
-                            t_vl.push_back(*(in++));
+                            t_ln += 1;
                         default:
                             break;
                     }
                 }
                 break;
         }
-        out.emplace_back(t_ab, t_st, t_vl.data(), t_vl.size());
+        if (t_ln > in_end - in) break;
+
+        //Payload is read straight from input into the track
+        in += t_ln;
+        out.push_back(t_ab, t_st, t_dt, t_ln);
 
         //Cancel running status if applicable
         if (t_st > STAT_NONE && t_st < STAT_SYSTEM_EXCLUSIVE);
@@ -77,12 +94,24 @@ void unpackMesg(unsigned char *in, const unsigned length) {
     }
 }
 
+///Unpacks variable MIDI messages from MTRK data
+void unpackMesg(midiinfo &mid, unsigned char *in, const unsigned length) {
+    if (!in || length < 2) return;
+    mid.msg.emplace_back();
+    unpackTrack(mid.msg.back(), in, length);
+}
+
+///Unpacks MIDI track from MIDI data into global MIDI info
+void unpackMesg(unsigned char *in, const unsigned length) { unpackMesg(mid_inf, in, length); }
+
 ///Unpacks MIDI info from MIDI data
-void unpackMidi(unsigned char *in, const unsigned length) {
-    mid_inf = {};
+///  MTRK chunks are found first, then parsed on up to jobs threads (0 for all cores)
+void unpackMidi(midiinfo &mid, unsigned char *in, const unsigned length, const unsigned jobs) {
+    mid = {};
     if (!in || length < 14) return;
 
     const unsigned char *in_end = in + length;
+    std::vector<std::pair<const unsigned char*, unsigned>> chks;
 
     auto get_int = [&in](unsigned length) -> unsigned {
         unsigned out = 0;
@@ -94,67 +123,106 @@ void unpackMidi(unsigned char *in, const unsigned length) {
 
     if (get_int(4) != FOURCC_MThd) return;
     if (get_int(4) != 6) return;
-    mid_inf.fmt = get_int(2);
-    mid_inf.trk = get_int(2);
-    mid_inf.div = get_int(2);
+    mid.fmt = get_int(2);
+    mid.trk = get_int(2);
+    mid.div = get_int(2);
 
-    while (in < in_end) {
+    //Index tracks
+    while (in_end - in >= 8) {
         unsigned t_sz;
 
         if (get_int(4) != FOURCC_MTrk) break;
         t_sz = get_int(4);
-        if (in + t_sz > in_end) break;
+        if (t_sz > in_end - in) break;
 
-        unpackMesg(in, t_sz);
+        if (t_sz >= 2) chks.emplace_back(in, t_sz);
         in += t_sz;
     }
+
+    //Parse tracks
+    mid.msg.resize(chks.size());
+    parallelFor(jobs, chks.size(), [&mid, &chks](const unsigned t) -> void {
+        unpackTrack(mid.msg[t], chks[t].first, chks[t].second);
+    });
 }
 
 
-///Packs MIDI data from MIDI info
-std::vector<unsigned char> packMidi() {
-    if (mid_inf.fmt > MIDI_MULTIPLE_SONG) return {};
-    else if (mid_inf.trk != mid_inf.msg.size()) return {};
-    else if (mid_inf.msg.empty()) return {};
+///Unpacks MIDI data into global MIDI info
+void unpackMidi(unsigned char *in, const unsigned length, const unsigned jobs) { unpackMidi(mid_inf, in, length, jobs); }
 
-    std::vector<unsigned char> out;
 
+///Writes MIDI header, returns end of written data
+static unsigned char* packHead(const midiinfo &mid, unsigned char *out) {
     auto set_int = [&out](const unsigned in, int length) -> void {
-        while (length--) out.push_back((in >> (8 * length)) & 0xFF);
-    };
-    auto get_siz = [](const std::vector<mesginfo> &in) -> unsigned {
-        const mesginfo *prv = 0;
-        unsigned siz = 0;
-        for (const auto &m : in) {
-            siz += m.size(prv);
-            prv = &m;
-            if (m.getStat() == META_END_OF_SEQUENCE) break;
-        }
-        return siz;
-    };
-    auto set_dat = [&out](const std::vector<mesginfo> &in) -> void {
-        const mesginfo *prv = 0;
-        for (const auto &m : in) {
-            auto dat = m.getAll(prv);
-            prv = &m;
-            out.insert(out.end(), dat.begin(), dat.end());
-            if (m.getStat() == META_END_OF_SEQUENCE) break;
-        }
+        while (length--) *(out++) = (in >> (8 * length)) & 0xFF;
     };
 
-    //Set MIDI header
     set_int(FOURCC_MThd, 4);
     set_int(0x06, 4);
-    set_int(mid_inf.fmt, 2);
-    set_int(mid_inf.trk, 2);
-    set_int(mid_inf.div, 2);
-
-    //Set MIDI tracks
-    for (const auto &trk : mid_inf.msg) {
-        set_int(FOURCC_MTrk, 4);
-        set_int(get_siz(trk), 4);
-        set_dat(trk);
+    set_int(mid.fmt, 2);
+    set_int(mid.trk, 2);
+    set_int(mid.div, 2);
+
+    return out;
+}
+
+///Writes MIDI track, returns end of written data
+///  Length is backpatched once the messages are written
+static unsigned char* packTrack(const mesgtrack &trk, unsigned char *out) {
+    auto set_int = [](unsigned char *out, const unsigned in, int length) -> void {
+        while (length--) *(out++) = (in >> (8 * length)) & 0xFF;
+    };
+
+    set_int(out, FOURCC_MTrk, 4);
+    unsigned char *end = trk.getAll(out + 8);
+    set_int(out + 4, end - out - 8, 4);
+
+    return end;
+}
+
+///Packs MIDI data from MIDI info
+std::vector<unsigned char> packMidi(const midiinfo &mid) {
+    if (mid.fmt > MIDI_MULTIPLE_SONG) return {};
+    else if (mid.trk != mid.msg.size()) return {};
+    else if (mid.msg.empty()) return {};
+
+    //Size for worst case, trimmed after writing
+    unsigned siz = 14;
+    for (const auto &trk : mid.msg) siz += 8 + trk.getBound();
+
+    std::vector<unsigned char> out(siz);
+    unsigned char *end = packHead(mid, out.data());
+    for (const auto &trk : mid.msg) end = packTrack(trk, end);
+    out.resize(end - out.data());
+
+    return out;
+}
+
+///Packs MIDI data from MIDI info into sink, one call per chunk
+int packMidi(const midiinfo &mid, const std::function<int(const unsigned char*, const unsigned)> &sink) {
+    if (mid.fmt > MIDI_MULTIPLE_SONG) return 0;
+    else if (mid.trk != mid.msg.size()) return 0;
+    else if (mid.msg.empty()) return 0;
+
+    //One buffer for the largest chunk, reused for all
+    unsigned siz = 14;
+    for (const auto &trk : mid.msg) siz = std::max(siz, 8 + trk.getBound());
+
+    std::vector<unsigned char> out(siz);
+    if (!sink(out.data(), packHead(mid, out.data()) - out.data())) return 0;
+    for (const auto &trk : mid.msg) {
+        if (!sink(out.data(), packTrack(trk, out.data()) - out.data())) return 0;
     }
 
-    return std::move(out);
+    return 1;
 }
+
+///Packs MIDI data from MIDI info into file descriptor
+int packMidi(const midiinfo &mid, const int fd) {
+    return packMidi(mid, [&fd](const unsigned char *data, const unsigned data_size) -> int {
+        return writeFileData(fd, data, data_size);
+    });
+}
+
+///Packs MIDI data from global MIDI info
+std::vector<unsigned char> packMidi() { return packMidi(mid_inf); }
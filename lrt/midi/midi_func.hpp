@@ -1,6 +1,7 @@
 #ifndef MIDI_FUNC_HPP
 #define MIDI_FUNC_HPP
 
+#include <functional>
 #include <string>
 #include <vector>
 #include "midi_types.hpp"
@@ -8,16 +9,26 @@
 
 inline extern midiinfo mid_inf = {};
 
+void unpackMesg(midiinfo &mid, unsigned char *in, const unsigned length);
 void unpackMesg(unsigned char *in, const unsigned length);
-void unpackMidi(unsigned char *in, const unsigned length);
+void unpackMidi(midiinfo &mid, unsigned char *in, const unsigned length, const unsigned jobs = 0);
+void unpackMidi(unsigned char *in, const unsigned length, const unsigned jobs = 0);
+std::vector<unsigned char> packMidi(const midiinfo &mid);
 std::vector<unsigned char> packMidi();
+int packMidi(const midiinfo &mid, const std::function<int(const unsigned char*, const unsigned)> &sink);
+int packMidi(const midiinfo &mid, const int fd);
+std::vector<unsigned char> packMev(const midiinfo &mid, const unsigned src = 0, const unsigned long long hash = 0);
+int unpackMev(mevinfo &mev, const unsigned char *in, const unsigned length);
 
 #ifdef CHECKMIDI_IMPLEMENTATION
 int checkMidi();
 #endif
 
 #ifdef PACKCSV_IMPLEMENTATION
+std::string packCsv(const midiinfo &mid);
 std::string packCsv();
+int packCsv(const midiinfo &mid, const std::function<int(const char*, const unsigned)> &sink);
+int packCsv(const midiinfo &mid, const int fd);
 #endif
 
 
@@ -1,22 +1,53 @@
 #ifndef MIDI_TYPES_HPP
 #define MIDI_TYPES_HPP
 
+#include <algorithm>
+#include <array>
 #include <compare>
+#include <functional>
+#include <string>
 #include <vector>
 #include "midi_const.hpp"
+#include "midi_forms.hpp"
+
+///MIDI Message Data
+///  Non-owning view, valid until the message or track it came from changes
+struct mesgdata {
+    const unsigned char *ptr = 0;
+    unsigned len = 0;
+
+    auto operator<=>(const mesgdata &d) const {
+        return std::lexicographical_compare_three_way(ptr, ptr + len, d.ptr, d.ptr + d.len);
+    }
+    bool operator==(const mesgdata &d) const {
+        return len == d.len && std::equal(ptr, ptr + len, d.ptr);
+    }
+
+    const unsigned char& operator[](const unsigned &i) const { return ptr[i]; }
+    unsigned size() const { return len; }
+    bool empty() const { return !len; }
+    const unsigned char* data() const { return ptr; }
+    const unsigned char* begin() const { return ptr; }
+    const unsigned char* end() const { return ptr + len; }
+    const unsigned char& back() const { return ptr[len - 1]; }
+};
 
 ///MIDI Message Fields
+///  Payload lives in a short string, so common messages need no allocation
 struct mesginfo {
     ~mesginfo() = default;
     mesginfo(const unsigned t_t = 0, const short t_s = STAT_NONE, std::initializer_list<unsigned char> t_v = {}) :
-        time(t_t), data(t_v) {
+        time(t_t), data(t_v.begin(), t_v.end()) {
             if (t_s <= STAT_NONE || t_s >= STAT_SYSTEM_EXCLUSIVE) { stat = t_s; chan = -1; }
             else { stat = t_s & 0xF0; chan = t_s & 0x0F; }
         }
     mesginfo(const unsigned t_t, const short t_s, const unsigned char *t_d, const int t_z) :
-        mesginfo{t_t, t_s} { if (t_z > 0) data.assign(t_d, t_d + t_z); }
+        mesginfo{t_t, t_s} { if (t_z > 0) data.assign((const char*)t_d, t_z); }
+    template<unsigned N>
+    mesginfo(const unsigned t_t, const short t_s, const unsigned char (&t_d)[N]) :
+        mesginfo{t_t, t_s, t_d, N} {}
     mesginfo(const unsigned t_t, const short t_s, const char *t_d) :
-        mesginfo{t_t, t_s} { for(int d = 0; t_d[d]; ++d) data.push_back(t_d[d]); }
+        mesginfo{t_t, t_s} { data = t_d; }
     mesginfo(const mesginfo &m) = default;
     mesginfo(mesginfo &&m) = default;
 
@@ -26,9 +57,9 @@ struct mesginfo {
     //To make comparing easier
     auto operator<=>(const mesginfo &m) const {
         if (auto cmp = time <=> m.time; cmp != 0) return cmp;
-        if (auto cmp = get_id() <=> m.get_id(); cmp != 0) return cmp;
+        if (auto cmp = getOrder(stat) <=> getOrder(m.stat); cmp != 0) return cmp;
         if (auto cmp = chan <=> m.chan; cmp != 0) return cmp;
-        if (auto cmp = data <=> m.data; cmp != 0) return cmp;
+        if (auto cmp = getData() <=> m.getData(); cmp != 0) return cmp;
         return std::strong_ordering::equal;
     }
     bool operator<(const mesginfo &m) const = default;
@@ -38,33 +69,6 @@ struct mesginfo {
     bool operator!=(const mesginfo &m) const = default;
     bool operator>=(const mesginfo &m) const = default;
 
-    //Get size of current message from pointer to previous message
-    unsigned size(const mesginfo *m = 0) const {
-        if (stat == META_NONE || stat == STAT_NONE) return 0;
-
-        unsigned out = 0; auto sid = get_id();
-        auto clc_vlv = [](unsigned v0) -> unsigned {
-            unsigned out = 0;
-            do { out += 1; } while (v0 >>= 7);
-            return out;
-        };
-
-        //Size of delta time
-        out += clc_vlv(time - (!m ? 0 : m[0].getTime()));
-        //Size of status if applicable
-        if (m && stat == m[0].getStat() && chan == m[0].getChan() && sid > 0x27 && sid < 0x2F);
-        else out += (stat < 0) ? 2 : 1;
-        //Size of size if applicable
-        if (stat == STAT_SYSTEM_EXCLUSIVE ||
-            stat == STAT_SYSTEM_EXCLUSIVE_STOP ||
-            stat < 0) {
-            out += clc_vlv(data.size());
-        }
-        //Size of data
-        out += data.size();
-        
-        return out;
-    }
     //Check if empty
     bool empty() const { return *this == mesginfo{}; }
     //Clear messages
@@ -74,7 +78,7 @@ struct mesginfo {
     void setStat(const short &st) { stat = st; }
     void setChan(const char &ch) { chan = ch; }
     void setData(const std::vector<unsigned char> &dt) {
-        data.insert(data.end(), dt.begin(), dt.end());
+        data.append(dt.begin(), dt.end());
     }
     void setData(const unsigned char &vl, const unsigned &id) {
         if (id < data.size()) data[id] = vl;
@@ -83,46 +87,500 @@ struct mesginfo {
     unsigned getTime() const { return time; }
     short getStat() const { return stat; }
     char getChan() const { return chan; }
-    std::vector<unsigned char> getData() const { return data; }
-    std::vector<unsigned char> getAll(const mesginfo *m = 0) const {
-        if (stat == META_NONE || stat == STAT_NONE) return {};
+    mesgdata getData() const { return {(const unsigned char*)data.data(), (unsigned)data.size()}; }
+
+    //Get sorting position of a status
+    static unsigned char getOrder(const short &st) {
+        static const auto ord = []() {
+            std::array<unsigned char, 512> out;
+            out.fill(sizeof(MIDISTATUS_ORDER)/sizeof(MidiStatus));
+            for (int i = sizeof(MIDISTATUS_ORDER)/sizeof(MidiStatus); i-- > 0;) out[MIDISTATUS_ORDER[i] + 256] = i;
+            return out;
+        }();
+        if (st < -256 || st > 255) return sizeof(MIDISTATUS_ORDER)/sizeof(MidiStatus);
+        return ord[st + 256];
+    }
+
+    private:
+        unsigned time;
+        short stat;
+        char chan;
+        std::string data;
+};
+
+///MIDI Message Reference
+///  Fields of one message read out of a track
+struct mesgview {
+    unsigned time;
+    short stat;
+    char chan;
+    mesgdata data;
+
+    unsigned getTime() const { return time; }
+    short getStat() const { return stat; }
+    char getChan() const { return chan; }
+    mesgdata getData() const { return data; }
+    mesginfo getMesg() const {
+        mesginfo out {time, STAT_NONE, data.ptr, (int)data.len};
+        out.setStat(stat);
+        out.setChan(chan);
+        return out;
+    }
+};
+
+///MIDI Track Fields
+///  Messages are kept as columns; payloads up to 4 bytes sit in their
+///  column, larger ones (sysex, meta text) in the track's shared arena
+struct mesgtrack {
+    ~mesgtrack() = default;
+    mesgtrack() = default;
+    mesgtrack(const std::vector<mesginfo> &t_m) {
+        reserve(t_m.size());
+        for (const auto &m : t_m) push_back(m);
+    }
+    mesgtrack(const mesgtrack &t) = default;
+    mesgtrack(mesgtrack &&t) = default;
 
-        std::vector<unsigned char> out; auto sid = get_id();
+    mesgtrack& operator=(const mesgtrack &t) = default;
+    mesgtrack& operator=(mesgtrack &&t) = default;
+
+    struct iterator {
+        const mesgtrack *trk;
+        unsigned id;
+
+        mesgview operator*() const { return (*trk)[id]; }
+        iterator& operator++() { id += 1; return *this; }
+        bool operator==(const iterator &i) const { return id == i.id; }
+        bool operator!=(const iterator &i) const { return id != i.id; }
+    };
+
+    //Get number of messages
+    unsigned size() const { return time.size(); }
+    //Check if empty
+    bool empty() const { return time.empty(); }
+    //Clear messages
+    void clear() { *this = {}; }
+    //Reserve space for messages
+    void reserve(const unsigned &siz) {
+        time.reserve(siz); stat.reserve(siz); chan.reserve(siz);
+        dsiz.reserve(siz); dval.reserve(siz);
+    }
+
+    //Get message stuff
+    mesgview operator[](const unsigned &id) const {
+        return {time[id], stat[id], chan[id], get_dat(id)};
+    }
+    mesgview back() const { return (*this)[size() - 1]; }
+    iterator begin() const { return {this, 0}; }
+    iterator end() const { return {this, size()}; }
+    std::vector<mesginfo> getMesgs() const {
+        std::vector<mesginfo> out;
+        out.reserve(size());
+        for (const auto &m : *this) out.push_back(m.getMesg());
+        return out;
+    }
+
+    //Set message stuff
+    void push_back(const mesginfo &m) {
+        const auto dt = m.getData();
+        time.push_back(m.getTime());
+        stat.push_back(m.getStat());
+        chan.push_back(m.getChan());
+        dsiz.push_back(dt.size());
+        dval.push_back(set_dat(dt));
+    }
+    void push_back(const unsigned &tm, const short &st, const unsigned char *dt, const unsigned &siz) {
+        time.push_back(tm);
+        if (st <= STAT_NONE || st >= STAT_SYSTEM_EXCLUSIVE) { stat.push_back(st); chan.push_back(-1); }
+        else { stat.push_back(st & 0xF0); chan.push_back(st & 0x0F); }
+        dsiz.push_back(siz);
+        dval.push_back(set_dat({dt, siz}));
+    }
+    template<typename... T>
+    void emplace_back(T&&... args) { push_back(mesginfo(std::forward<T>(args)...)); }
+    void insert(const unsigned &id, const mesginfo &m) {
+        const auto dt = m.getData();
+        time.insert(time.begin() + id, m.getTime());
+        stat.insert(stat.begin() + id, m.getStat());
+        chan.insert(chan.begin() + id, m.getChan());
+        dsiz.insert(dsiz.begin() + id, dt.size());
+        dval.insert(dval.begin() + id, set_dat(dt));
+    }
+
+    //Sort messages by time, status order, channel and data
+    void sort() {
+        std::vector<unsigned> ord(size());
+        std::vector<unsigned char> sid(size());
+        for (unsigned i = 0; i < size(); ++i) { ord[i] = i; sid[i] = mesginfo::getOrder(stat[i]); }
+
+        std::sort(ord.begin(), ord.end(), [this, &sid](const unsigned &a, const unsigned &b) -> bool {
+            if (time[a] != time[b]) return time[a] < time[b];
+            if (sid[a] != sid[b]) return sid[a] < sid[b];
+            if (chan[a] != chan[b]) return chan[a] < chan[b];
+            if (auto cmp = get_dat(a) <=> get_dat(b); cmp != 0) return cmp < 0;
+            return a < b;
+        });
+
+        //Arena offsets move with their messages, so the arena stays put
+        auto set_ord = [&ord]<typename T>(std::vector<T> &col) -> void {
+            std::vector<T> tmp(col.size());
+            for (unsigned i = 0; i < ord.size(); ++i) tmp[i] = col[ord[i]];
+            col.swap(tmp);
+        };
+        set_ord(time); set_ord(stat); set_ord(chan); set_ord(dsiz); set_ord(dval);
+    }
+
+    //Get most bytes messages can take as MTRK data
+    //  Delta, status and size are at most 12 bytes, small payloads 4 more
+    unsigned getBound() const { return size() * 16 + arena.size(); }
+    //Write messages from beg as MTRK data up to end of sequence, returns end of written data
+    //  out must hold at least getBound() bytes, message before beg is taken as already written
+    unsigned char* getAll(unsigned char *out, const unsigned beg = 0) const {
         auto set_vlv = [&out](unsigned v0) -> void {
             unsigned v1 = v0 & 0x7F;
             while (v0 >>= 7) { v1 = (v1 << 8) | ((v0 & 0x7F) | 0x80); }
-            do { out.push_back(v1 & 0xFF); v1 >>= 8; } while (out.back() & 0x80);
+            do { *(out++) = v1 & 0xFF; v1 >>= 8; } while (out[-1] & 0x80);
         };
 
-        //Delta time
-        set_vlv(time - (!m ? 0 : m[0].getTime()));
-        //Status
-        if (m && stat == m[0].getStat() && chan == m[0].getChan() && sid > 0x27 && sid < 0x2F);
-        else {
-            if (stat < 0) out.push_back(stat >> 8);
-            out.push_back((stat | ((chan < 0) ? 0 : chan)) & 0xFF);
-        }
-        //Size
-        if (stat == STAT_SYSTEM_EXCLUSIVE ||
-            stat == STAT_SYSTEM_EXCLUSIVE_STOP ||
-            stat < 0) {
-            set_vlv(data.size());
-        }
-        //Data
-        out.insert(out.end(), data.begin(), data.end());
-        
+        for (unsigned i = beg; i < size(); ++i) {
+            if (stat[i] == META_NONE || stat[i] == STAT_NONE) continue;
+
+            //Delta time
+            set_vlv(time[i] - ((!i) ? 0 : time[i - 1]));
+            //Status
+            if (!is_run(i)) {
+                if (stat[i] < 0) *(out++) = stat[i] >> 8;
+                *(out++) = (stat[i] | ((chan[i] < 0) ? 0 : chan[i])) & 0xFF;
+            }
+            //Size
+            if (is_siz(i)) set_vlv(dsiz[i]);
+            //Data
+            const auto dt = get_dat(i);
+            out = std::copy(dt.begin(), dt.end(), out);
+
+            if (stat[i] == META_END_OF_SEQUENCE) break;
+        }
+
         return out;
     }
 
     private:
-        unsigned time;
-        short stat;
-        char chan;
-        std::vector<unsigned char> data;
+        std::vector<unsigned> time;
+        std::vector<short> stat;
+        std::vector<char> chan;
+        std::vector<unsigned> dsiz;         //Payload size
+        std::vector<unsigned> dval;         //Payload bytes if small, otherwise arena offset
+        std::vector<unsigned char> arena;
 
-        unsigned char get_id() const {
-            for (const auto &S : MIDISTATUS_ORDER) { if (stat == S) return &S - MIDISTATUS_ORDER; }
-            return sizeof(MIDISTATUS_ORDER)/sizeof(MidiStatus);
+        mesgdata get_dat(const unsigned &id) const {
+            if (dsiz[id] <= sizeof(unsigned)) return {(const unsigned char*)&dval[id], dsiz[id]};
+            return {arena.data() + dval[id], dsiz[id]};
+        }
+        unsigned set_dat(const mesgdata &dt) {
+            unsigned out = 0;
+            if (dt.size() <= sizeof(unsigned)) std::copy(dt.begin(), dt.end(), (unsigned char*)&out);
+            else { out = arena.size(); arena.insert(arena.end(), dt.begin(), dt.end()); }
+            return out;
+        }
+        //Check if status is running from previous message
+        bool is_run(const unsigned &id) const {
+            if (!id || stat[id] != stat[id - 1] || chan[id] != chan[id - 1]) return false;
+            const auto sid = mesginfo::getOrder(stat[id]);
+            return sid > 0x27 && sid < 0x2F;
+        }
+        //Check if message carries its data size
+        bool is_siz(const unsigned &id) const {
+            return stat[id] == STAT_SYSTEM_EXCLUSIVE ||
+                   stat[id] == STAT_SYSTEM_EXCLUSIVE_STOP ||
+                   stat[id] < 0;
+        }
+};
+
+///MIDI Track Writer
+///  Messages come in by time and go out in sorted order without sorting the track;
+///  later messages (note offs) wait in a min-heap, only same-time messages get sorted
+///  Input that goes back in time falls back to sorting the whole track
+struct mesgqueue {
+    ~mesgqueue() = default;
+    mesgqueue(mesgtrack &t_t) : trk(t_t) {}
+    mesgqueue(const mesgqueue &q) = delete;
+    mesgqueue(mesgqueue &&q) = default;
+    mesgqueue& operator=(const mesgqueue &q) = delete;
+
+    //Add message at or after time of previous one
+    void setMesg(mesginfo &&m) {
+        if (is_srt || m.getTime() < time) { set_srt(); trk.push_back(m); return; }
+        set_time(m.getTime());
+        grp.push_back(std::move(m));
+    }
+    template<typename... T>
+    void setMesg(T&&... args) { setMesg(mesginfo(std::forward<T>(args)...)); }
+    //Add message for some later time
+    void setLater(mesginfo &&m) {
+        if (is_srt || m.getTime() < time) { set_srt(); trk.push_back(m); return; }
+        if (m.getTime() == time) { grp.push_back(std::move(m)); return; }
+        late.push_back(std::move(m));
+        std::push_heap(late.begin(), late.end(), is_late);
+    }
+    template<typename... T>
+    void setLater(T&&... args) { setLater(mesginfo(std::forward<T>(args)...)); }
+    //Write every waiting message to track
+    void flush() {
+        if (!is_srt) {
+            while (!late.empty()) set_late();
+            set_grp();
+        }
+        else trk.sort();
+    }
+    //Check if anything was added
+    bool empty() const { return trk.empty() && grp.empty() && late.empty(); }
+    //Check if messages reached the track in order
+    bool isOrdered() const { return !is_srt; }
+
+    private:
+        mesgtrack &trk;
+        std::vector<mesginfo> grp;          //Messages at current time
+        std::vector<mesginfo> late;         //Messages for later, min-heap by time
+        unsigned time = 0;
+        bool is_srt = false;
+
+        static bool is_late(const mesginfo &a, const mesginfo &b) { return a.getTime() > b.getTime(); }
+
+        //Sort and write messages at current time
+        void set_grp() {
+            if (grp.size() > 1) std::sort(grp.begin(), grp.end());
+            for (const auto &m : grp) trk.push_back(m);
+            grp.clear();
+        }
+        //Move earliest later message to its time
+        void set_late() {
+            std::pop_heap(late.begin(), late.end(), is_late);
+            if (late.back().getTime() != time) { set_grp(); time = late.back().getTime(); }
+            grp.push_back(std::move(late.back()));
+            late.pop_back();
+        }
+        //Move to time, writing everything before it
+        void set_time(const unsigned &tm) {
+            if (tm == time) return;
+            while (!late.empty() && late.front().getTime() < tm) set_late();
+            set_grp();
+            time = tm;
+        }
+        //Give up on ordering, track gets sorted on flush
+        void set_srt() {
+            if (is_srt) return;
+            for (const auto &m : grp) trk.push_back(m);
+            for (const auto &m : late) trk.push_back(m);
+            grp.clear(); late.clear();
+            is_srt = true;
+        }
+};
+
+///MIDI Stream Reader
+///  Reads MIDI data a block at a time through a callback, keeping a cursor per track;
+///  messages of all tracks come out merged by time, then track
+///  Only a block per track and the current payloads are held, whatever the file size
+struct midireader {
+    //Reads up to size bytes at offs into out, returns amount read
+    using readfunc = std::function<unsigned(const unsigned offs, unsigned char *out, const unsigned size)>;
+
+    ~midireader() = default;
+    midireader(readfunc t_r, const unsigned t_b = 1 << 14) : read(t_r), block((t_b) ? t_b : 1) {}
+    midireader(const midireader &r) = delete;
+    midireader& operator=(const midireader &r) = delete;
+
+    unsigned short fmt = 0;
+    unsigned short trk = 0;
+    unsigned short div = 0;
+
+    //Read header and find tracks, false if not MIDI data
+    //  Tracks are read as far as the callback gives data, a cut off message ends the track
+    bool open() {
+        unsigned char hdr[14];
+        unsigned offs = 14;
+
+        auto get_int = [](const unsigned char *in, const unsigned length) -> unsigned {
+            unsigned out = 0;
+            for (unsigned i = 0; i < length; ++i) out = (out << 8) | in[i];
+            return out;
+        };
+
+        trks.clear(); heap.clear(); last = -1;
+        if (read(0, hdr, 14) != 14) return false;
+        if (get_int(hdr, 4) != FOURCC_MThd || get_int(hdr + 4, 4) != 6) return false;
+        fmt = get_int(hdr + 8, 2);
+        trk = get_int(hdr + 10, 2);
+        div = get_int(hdr + 12, 2);
+
+        //Index tracks from their headers only
+        for (unsigned char chk[8]; read(offs, chk, 8) == 8; offs += 8 + get_int(chk + 4, 4)) {
+            const unsigned end = offs + 8 + get_int(chk + 4, 4);
+            if (get_int(chk, 4) != FOURCC_MTrk || end < offs) break;
+            if (end - offs >= 10) {
+                auto &c = trks.emplace_back();
+                c.offs = offs + 8; c.end = end;
+            }
+        }
+
+        for (unsigned t = 0; t < trks.size(); ++t) set_next(t);
+        return true;
+    }
+    //Get next message over all tracks and its track, false at end
+    //  Message data stays valid until next call
+    bool getMesg(mesgview &out, unsigned &id) {
+        if (last < trks.size()) set_next(last);
+        if (heap.empty()) { last = -1; return false; }
+
+        std::pop_heap(heap.begin(), heap.end(), is_late);
+        id = last = heap.back().second;
+        heap.pop_back();
+
+        const auto &c = trks[id];
+        out = {c.tm, c.st, c.ch, {c.dat.data(), (unsigned)c.dat.size()}};
+        return true;
+    }
+    //Get number of tracks found
+    unsigned size() const { return trks.size(); }
+
+    private:
+        struct cursor {
+            unsigned offs, end;                 //Offset of next block, end of track
+            std::vector<unsigned char> buf;     //Current block
+            unsigned pos = 0;
+            unsigned time = 0;
+            short run = STAT_NONE;              //Running status
+            unsigned tm = 0;                    //Message waiting to go out
+            short st = STAT_NONE;
+            char ch = -1;
+            std::vector<unsigned char> dat;
+        };
+
+        readfunc read;
+        unsigned block;
+        std::vector<cursor> trks;
+        std::vector<std::pair<unsigned, unsigned>> heap;    //Time and track of waiting messages, min-heap
+        unsigned last = -1;                                 //Track of message given out last
+
+        static bool is_late(const std::pair<unsigned, unsigned> &a, const std::pair<unsigned, unsigned> &b) {
+            return a > b;
+        }
+
+        //Get byte from track without moving past it, reading next block if needed
+        bool get_peek(cursor &c, unsigned char &out) {
+            if (c.pos >= c.buf.size()) {
+                unsigned siz = std::min(block, c.end - c.offs);
+                c.buf.resize(siz); c.pos = 0;
+                if (siz) c.buf.resize(read(c.offs, c.buf.data(), siz));
+                c.offs += c.buf.size();
+                if (c.buf.empty()) return false;
+            }
+            out = c.buf[c.pos];
+            return true;
+        }
+        bool get_byte(cursor &c, unsigned char &out) {
+            if (!get_peek(c, out)) return false;
+            c.pos += 1;
+            return true;
+        }
+        bool get_vlv(cursor &c, unsigned &out) {
+            unsigned char b = 0;
+            out = 0;
+            for (int i = 0; i < 4 && get_byte(c, b); ++i) {
+                out = (out << 7) | (b & 0x7F);
+                if (!(b & 0x80)) return true;
+            }
+            return false;
+        }
+        //Read next message of track and queue it, a track that ends lets go of its block
+        void set_next(const unsigned &id) {
+            auto &c = trks[id];
+
+            if (!get_mesg(c)) {
+                std::vector<unsigned char>().swap(c.buf);
+                std::vector<unsigned char>().swap(c.dat);
+                c.offs = c.end;
+                return;
+            }
+            heap.emplace_back(c.tm, id);
+            std::push_heap(heap.begin(), heap.end(), is_late);
+        }
+        //Same reading as unpackMesg, a byte at a time
+        bool get_mesg(cursor &c) {
+            unsigned char b = 0;
+
+            while (true) {
+                short t_st = c.run;
+                unsigned t_ln = 0, t_dl;
+
+                //Get delta time
+                if (!get_vlv(c, t_dl) || !get_peek(c, b)) return false;
+                c.time += t_dl;
+
+                //Get status
+                if (!(b & 0x80) && (t_st == STAT_NONE)) continue;
+                else if (b & 0x80) { get_byte(c, b); t_st = b; }
+
+                //Get message
+                switch (t_st & 0xF0) {
+                    //Has 2 data bytes
+                    case STAT_NOTE_OFF:
+                    case STAT_NOTE_ON:
+                    case STAT_KEY_PRESSURE:
+                    case STAT_CONTROLLER:
+                    case STAT_PITCH_WHEEL:
+                        t_ln += 1;
+                        [[fallthrough]];
+                    //Has 1 data byte
+                    case STAT_PROGRAMME_CHANGE:
+                    case STAT_CHANNEL_PRESSURE:
+                        t_ln += 1;
+                        break;
+                    case 0xF0:
+                        if (t_st == STAT_RESET) {
+                            if (!get_byte(c, b)) return false;
+                            t_st = (t_st << 8) | b;
+                        }
+
+                        if (t_st == STAT_SYSTEM_EXCLUSIVE ||
+                            t_st == STAT_SYSTEM_EXCLUSIVE_STOP ||
+                            t_st < 0) {
+
+                            if (!get_vlv(c, t_ln)) return false;
+                        }
+                        else {
+                            switch (t_st) {
+                                case STAT_SEQUENCE_POINTER:
+                                    t_ln += 1;
+                                    [[fallthrough]];
+                                case STAT_QUARTER_FRAME:
+                                case STAT_SEQUENCE_REQUEST:
+                                    t_ln += 1;
+                                default:
+                                    break;
+                            }
+                        }
+                        break;
+                }
+                if (t_ln > c.end - (c.offs - (c.buf.size() - c.pos))) return false;
+
+                //Payload may run over blocks
+                c.dat.clear();
+                while (c.dat.size() < t_ln) {
+                    if (!get_peek(c, b)) return false;
+                    unsigned siz = std::min<unsigned>(t_ln - c.dat.size(), c.buf.size() - c.pos);
+                    c.dat.insert(c.dat.end(), c.buf.begin() + c.pos, c.buf.begin() + c.pos + siz);
+                    c.pos += siz;
+                }
+
+                c.tm = c.time;
+                if (t_st <= STAT_NONE || t_st >= STAT_SYSTEM_EXCLUSIVE) { c.st = t_st; c.ch = -1; }
+                else { c.st = t_st & 0xF0; c.ch = t_st & 0x0F; }
+
+                //Cancel running status if applicable
+                if (t_st > STAT_NONE && t_st < STAT_SYSTEM_EXCLUSIVE) c.run = t_st;
+                else c.run = STAT_NONE;
+                return true;
+            }
         }
 };
 
@@ -130,7 +588,7 @@ struct midiinfo {
     ~midiinfo() = default;
     midiinfo(
         const unsigned short t_f = MIDI_SINGLE_TRACK, const unsigned short t_t = 0,
-        const unsigned short t_d = 0, const std::vector<std::vector<mesginfo>> t_m = {}
+        const unsigned short t_d = 0, const std::vector<mesgtrack> t_m = {}
         ) : fmt(t_f), trk(t_t), div(t_d), msg(t_m) {}
     midiinfo(
         const unsigned short t_f, const unsigned short t_t,
@@ -157,7 +615,7 @@ struct midiinfo {
     unsigned short div;
     std::vector<
         //const unsigned MTrk = 0x4D54726B;
-        std::vector<mesginfo>
+        mesgtrack
     > msg;
 
     //To make setting division easier
@@ -168,4 +626,85 @@ struct midiinfo {
 };
 
 
+///MIDI Event Cache Message
+///  Fixed-width record as laid out in the cache file
+struct mevmesg {
+    unsigned time;
+    short stat;
+    char chan;
+    unsigned char pad;
+    unsigned dsiz;                      //Payload size
+    unsigned dval;                      //Payload bytes if small, otherwise arena offset
+};
+
+///MIDI Event Cache Tempo
+///  Tempo from tick on, msec is playback time at tick
+struct mevtempo {
+    unsigned tick;
+    unsigned tempo;
+    unsigned msec;
+};
+
+///MIDI Event Cache Track
+///  Non-owning view of one track's records, reads like a mesgtrack
+struct mevtrack {
+    const mevmesg *recs = 0;
+    unsigned size_ = 0;
+    const unsigned char *arena = 0;
+
+    struct iterator {
+        const mevtrack *trk;
+        unsigned id;
+
+        mesgview operator*() const { return (*trk)[id]; }
+        iterator& operator++() { id += 1; return *this; }
+        bool operator==(const iterator &i) const { return id == i.id; }
+        bool operator!=(const iterator &i) const { return id != i.id; }
+    };
+
+    //Get number of messages
+    unsigned size() const { return size_; }
+    //Check if empty
+    bool empty() const { return !size_; }
+
+    //Get message stuff
+    mesgview operator[](const unsigned &id) const {
+        const auto &r = recs[id];
+        if (r.dsiz <= sizeof(unsigned)) return {r.time, r.stat, r.chan, {(const unsigned char*)&r.dval, r.dsiz}};
+        return {r.time, r.stat, r.chan, {arena + r.dval, r.dsiz}};
+    }
+    iterator begin() const { return {this, 0}; }
+    iterator end() const { return {this, size_}; }
+};
+
+///MIDI Event Cache Info
+///  Non-owning view of a cache file, valid while its data is
+struct mevinfo {
+    unsigned short fmt = 0;
+    unsigned short trk = 0;
+    unsigned short div = 0;
+    unsigned src = 0;                   //Size of MIDI data it was made from
+    unsigned long long hash = 0;        //Hash of MIDI data it was made from
+    unsigned lbeg = -1, lend = -1;      //Loop ticks, -1 if none
+    const mevtempo *tempo = 0;
+    unsigned tempo_size = 0;
+    std::vector<mevtrack> msg;
+
+    //Check if empty
+    bool empty() const { return msg.empty(); }
+    //Get playback time of tick in milliseconds
+    unsigned getMsec(const unsigned &tick) const {
+        unsigned lo = 0, hi = tempo_size;
+        while (lo < hi) {
+            unsigned md = (lo + hi) / 2;
+            if (tempo[md].tick <= tick) lo = md + 1;
+            else hi = md;
+        }
+        if (!lo) return (int)(tick * (500000 / (1000.0 * div)));
+        const auto &t = tempo[lo - 1];
+        return t.msec + (int)((tick - t.tick) * (t.tempo / (1000.0 * div)));
+    }
+};
+
+
 #endif
@@ -0,0 +1,40 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+///Get default number of worker threads
+static unsigned getJobs() {
+    unsigned ret = std::thread::hardware_concurrency();
+    return (ret) ? ret : 1;
+}
+
+///Run func(i) for every i in [0, count) on up to jobs threads
+///  Indices are handed out in order; results should go into per-index slots
+template<typename F>
+static void parallelFor(unsigned jobs, const unsigned count, F &&func) {
+    if (!jobs) jobs = getJobs();
+    if (jobs > count) jobs = count;
+    if (jobs < 2) {
+        for (unsigned i = 0; i < count; ++i) func(i);
+        return;
+    }
+
+    std::atomic<unsigned> next {0};
+    std::vector<std::thread> pool;
+
+    auto work = [&next, &count, &func]() -> void {
+        for (unsigned i; (i = next++) < count;) func(i);
+    };
+
+    pool.reserve(jobs - 1);
+    for (unsigned t = 1; t < jobs; ++t) pool.emplace_back(work);
+    work();
+    for (auto &t : pool) t.join();
+}
+
+
+#endif
@@ -6,6 +6,8 @@
 #include <vector>
 #include "sgxd_types.hpp"
 #include "sgxd_func.hpp"
+#include "parallel.hpp"
+#include "trace.hpp"
 #include "riff/riff_forms.hpp"
 #include "riff/riffsfbk_forms.hpp"
 #include "riff/riffsfbk_const.hpp"
@@ -15,15 +17,15 @@
 
 
 ///Unpacks variable region definitions from RGND data
-void unpackRgnd(unsigned char *in, const unsigned length) {
-    if (sgd_debug) fprintf(stderr, "    Unpack RGND\n");
+void unpackRgnd(sgxdctx &ctx, unsigned char *in, const unsigned length) {
+    TRACE_STEP(ctx.debug, "    Unpack RGND\n");
     
-    sgd_inf.rgnd = {};
-    if (!sgd_beg || !in || length < 8) return;
+    ctx.inf.rgnd = {};
+    if (!ctx.beg || !in || length < 8) return;
 
     const unsigned char *in_end = in + length;
     unsigned t_sz;
-    auto &out = sgd_inf.rgnd;
+    auto &out = ctx.inf.rgnd;
 
     auto get_int = [&in, &in_end](const unsigned length) -> unsigned {
         unsigned out = 0;
@@ -40,27 +42,27 @@ void unpackRgnd(unsigned char *in, const unsigned length) {
         return out;
     };
 
-    if (sgd_debug) fprintf(stderr, "    Read RGND Header\n");
+    TRACE_STEP(ctx.debug, "    Read RGND Header\n");
     out.flag = get_int(4);
     out.rgnd.resize(get_int(4));
     signed rgnoffs[out.rgnd.size()] {};
 
-    if (sgd_debug) fprintf(stderr, "        Global flag: 0x%08X\n", out.flag);
+    TRACE_STEP(ctx.debug, "        Global flag: 0x%08X\n", out.flag);
 
-    if (sgd_debug) fprintf(stderr, "    Read RGND Setup\n");
+    TRACE_STEP(ctx.debug, "    Read RGND Setup\n");
     for (int r = 0; r < out.rgnd.size(); ++r) {
         out.rgnd[r].resize(get_int(4));
         rgnoffs[r] = get_int(4);
     }
 
-    if (sgd_debug) fprintf(stderr, "    Read RGND Region\n");
+    TRACE_STEP(ctx.debug, "    Read RGND Region\n");
     for (int r = 0; r < out.rgnd.size(); ++r) {
-        in = (unsigned char*)sgd_beg + rgnoffs[r];
+        in = (unsigned char*)ctx.beg + rgnoffs[r];
 
-        if (sgd_debug) fprintf(stderr, "        Current region: %d\n", r);
+        TRACE_STEP(ctx.debug, "        Current region: %d\n", r);
         for (auto &t : out.rgnd[r]) {
             t.flag = get_int(4);
-            t.name = get_str(sgd_beg, get_int(4));
+            t.name = get_str(ctx.beg, get_int(4));
             t.rgnsiz = get_int(4);
             if (t.rgnsiz < 56) { in += 56 - t.rgnsiz - 12; continue; }
             else if (t.rgnsiz > 56) { in += t.rgnsiz - 56 - 12; continue; }
@@ -88,46 +90,47 @@ void unpackRgnd(unsigned char *in, const unsigned length) {
             t.bendhigh = *(in++);
             t.smpid = get_int(4);
 
-            if (sgd_debug) {
-                fprintf(stderr, "            Current tone: %d\n", &t - out.rgnd[r].data());
-                fprintf(stderr, "                Local flag: 0x%08X\n", t.flag);
-                fprintf(stderr, "                Name: %s\n", t.name.c_str());
-                fprintf(stderr, "                Region size: %d\n", t.rgnsiz);
-                fprintf(stderr, "                Priority: %d\n", t.voice);
-                fprintf(stderr, "                Group ID 1: %d\n", t.excl);
-                fprintf(stderr, "                Group mode: %d\n", t.bnkmode);
-                fprintf(stderr, "                Group ID 2: %d\n", t.bnkid);
-                fprintf(stderr, "                Effect: %d\n", t.effect);
-                fprintf(stderr, "                Note low: %d\n", t.notelow);
-                fprintf(stderr, "                Note high: %d\n", t.notehigh);
-                fprintf(stderr, "                Note root: %d\n", t.noteroot);
-                fprintf(stderr, "                Note tune: %d\n", t.notetune);
-                fprintf(stderr, "                Note pitch: %d\n", t.notepitch);
-                fprintf(stderr, "                Volume 1: %d\n", t.vol0);
-                fprintf(stderr, "                Volume 2: %d\n", t.vol1);
-                fprintf(stderr, "                Generator dry: %d\n", t.gendry);
-                fprintf(stderr, "                Generator wet: %d\n", t.genwet);
-                fprintf(stderr, "                Envelope 1: %d\n", t.env0);
-                fprintf(stderr, "                Envelope 2: %d\n", t.env1);
-                fprintf(stderr, "                Volume: %d\n", t.vol);
-                fprintf(stderr, "                Pan: %d\n", t.pan);
-                fprintf(stderr, "                Bend low: %d\n", t.bendlow);
-                fprintf(stderr, "                Bend high: %d\n", t.bendhigh);
-                fprintf(stderr, "                Sample ID: %d\n", t.smpid);
-            }
+            TRACE_FIELD(ctx.debug, "            Current tone: %d\n", &t - out.rgnd[r].data());
+            TRACE_FIELD(ctx.debug, "                Local flag: 0x%08X\n", t.flag);
+            TRACE_FIELD(ctx.debug, "                Name: %s\n", t.name.c_str());
+            TRACE_FIELD(ctx.debug, "                Region size: %d\n", t.rgnsiz);
+            TRACE_FIELD(ctx.debug, "                Priority: %d\n", t.voice);
+            TRACE_FIELD(ctx.debug, "                Group ID 1: %d\n", t.excl);
+            TRACE_FIELD(ctx.debug, "                Group mode: %d\n", t.bnkmode);
+            TRACE_FIELD(ctx.debug, "                Group ID 2: %d\n", t.bnkid);
+            TRACE_FIELD(ctx.debug, "                Effect: %d\n", t.effect);
+            TRACE_FIELD(ctx.debug, "                Note low: %d\n", t.notelow);
+            TRACE_FIELD(ctx.debug, "                Note high: %d\n", t.notehigh);
+            TRACE_FIELD(ctx.debug, "                Note root: %d\n", t.noteroot);
+            TRACE_FIELD(ctx.debug, "                Note tune: %d\n", t.notetune);
+            TRACE_FIELD(ctx.debug, "                Note pitch: %d\n", t.notepitch);
+            TRACE_FIELD(ctx.debug, "                Volume 1: %d\n", t.vol0);
+            TRACE_FIELD(ctx.debug, "                Volume 2: %d\n", t.vol1);
+            TRACE_FIELD(ctx.debug, "                Generator dry: %d\n", t.gendry);
+            TRACE_FIELD(ctx.debug, "                Generator wet: %d\n", t.genwet);
+            TRACE_FIELD(ctx.debug, "                Envelope 1: %d\n", t.env0);
+            TRACE_FIELD(ctx.debug, "                Envelope 2: %d\n", t.env1);
+            TRACE_FIELD(ctx.debug, "                Volume: %d\n", t.vol);
+            TRACE_FIELD(ctx.debug, "                Pan: %d\n", t.pan);
+            TRACE_FIELD(ctx.debug, "                Bend low: %d\n", t.bendlow);
+            TRACE_FIELD(ctx.debug, "                Bend high: %d\n", t.bendhigh);
+            TRACE_FIELD(ctx.debug, "                Sample ID: %d\n", t.smpid);
         }
     }
 }
 
+///Unpacks RGND data into global SGXD info
+void unpackRgnd(unsigned char *in, const unsigned length) { unpackRgnd(sgd_ctx, in, length); }
+
 ///Packs variable region definitions into soundfont data
-std::vector<unsigned char> rgndToSfbk() {
-    if (sgd_debug) fprintf(stderr, "    Extract SF2\n");
+std::vector<unsigned char> rgndToSfbk(sgxdctx &ctx) {
+    TRACE_STEP(ctx.debug, "    Extract SF2\n");
     
-    sf2_inf = {};
+    riffsfbk sfb {};
     if (
-        sgd_inf.file.empty() ||
-        sgd_inf.rgnd.empty() ||
-        sgd_inf.wave.empty()
+        ctx.inf.file.empty() ||
+        ctx.inf.rgnd.empty() ||
+        ctx.inf.wave.empty()
     ) return {};
     
     struct prst { unsigned short bid, pid; std::vector<baginfo> zon; };
@@ -143,61 +146,62 @@ std::vector<unsigned char> rgndToSfbk() {
         return itr;
     };
 
-    if (sgd_debug) fprintf(stderr, "        Set info to soundbank\n");
+    TRACE_STEP(ctx.debug, "        Set info to soundbank\n");
     
     //Version Level
-    if (sgd_debug) fprintf(stderr, "            Set version\n");
-    sf2_inf.setIfil(2, 4);
+    TRACE_STEP(ctx.debug, "            Set version\n");
+    sfb.setIfil(2, 4);
     
     //Sound Engine
-    if (sgd_debug) fprintf(stderr, "            Set sound engine\n");
-    sf2_inf.setIsng("EMU8000");
+    TRACE_STEP(ctx.debug, "            Set sound engine\n");
+    sfb.setIsng("EMU8000");
     
     //Title
-    if (sgd_debug) fprintf(stderr, "            Set title\n");
-    sf2_inf.setInam(sgd_inf.file.c_str());
+    TRACE_STEP(ctx.debug, "            Set title\n");
+    sfb.setInam(ctx.inf.file.c_str());
     
     //Software Package
-    if (sgd_debug) fprintf(stderr, "            Set software\n");
-    sf2_inf.setIsft(PROGRAMME_IDENTIFIER);
+    TRACE_STEP(ctx.debug, "            Set software\n");
+    sfb.setIsft(PROGRAMME_IDENTIFIER);
 
-    if (sgd_debug) fprintf(stderr, "        Set samples to soundbank\n");
-    const int siz = sgd_inf.wave.wave.size();
+    TRACE_STEP(ctx.debug, "        Set samples to soundbank\n");
+    const int siz = ctx.inf.wave.wave.size();
+    parallelFor(ctx.jobs, siz, [&ctx](const unsigned w) -> void { decodeWave(ctx, w); });
     for (int w = 0; w < siz; ++w) {
-        const auto &wav = sgd_inf.wave.wave[w];
+        const auto &wav = ctx.inf.wave.wave[w];
         const auto &pcm = (wav.chns != 1) ? std::vector<short>{} : wav.pcm;
         const auto &lpb = (pcm.empty()) ? 0 : wav.loopbeg;
         const auto &lpe = (pcm.empty()) ? 0 : wav.loopend;
         char nam[SFBK_NAME_MAX + 1] {};
         
-        if (sgd_debug) fprintf(stderr, "            Set sample %d and header\n", w);
+        TRACE_STEP(ctx.debug, "            Set sample %d and header\n", w);
         if (wav.chns != 1) set_nam(nam, SFBK_NAME_MAX, "empt_%03d", w);
         else if (!wav.name.empty()) set_nam(nam, SFBK_NAME_MAX, wav.name.c_str());
         else set_nam(nam, SFBK_NAME_MAX, "smpl_%03d", w);
         
-        sf2_inf.setShdr(nam, pcm, lpb, lpe, wav.smprate, 60, 0, 0, ST_RAM_MONO);
+        sfb.setShdr(nam, pcm, lpb, lpe, wav.smprate, 60, 0, 0, ST_RAM_MONO);
     }
 
-    if (sgd_debug) fprintf(stderr, "        Set instruments and presets to soundbank\n");
-    for (const auto &rgn : sgd_inf.rgnd.rgnd) {
+    TRACE_STEP(ctx.debug, "        Set instruments and presets to soundbank\n");
+    for (const auto &rgn : ctx.inf.rgnd.rgnd) {
         
         //new_val = (((old_val - old_min) * (new_max - new_min)) / (old_max - old_min)) + new_min
 
         prsts.clear();
         for (const auto &ton : rgn) {
-            const auto &wav = sgd_inf.wave.wave[ton.smpid];
-            const int i = sf2_inf.getInum();
-            auto itr = get_prs(ton.bnkid, &rgn - sgd_inf.rgnd.rgnd.data());
+            const auto &wav = ctx.inf.wave.wave[ton.smpid];
+            const int i = sfb.getInum();
+            auto itr = get_prs(ton.bnkid, &rgn - ctx.inf.rgnd.rgnd.data());
             std::vector<geninfo> tgn;
             std::vector<modinfo> tmd;
 
             char nam[SFBK_NAME_MAX + 1] {};
 
-            if (sgd_debug) fprintf(stderr, "            Set instrument %d header and zones\n", i);
+            TRACE_STEP(ctx.debug, "            Set instrument %d header and zones\n", i);
             if (!ton.name.empty()) set_nam(nam, SFBK_NAME_MAX, ton.name.c_str());
             else set_nam(nam, SFBK_NAME_MAX, "inst_%03d", i);
             
-            sf2_inf.setInst(
+            sfb.setInst(
                 nam, std::vector<baginfo>{{
                     std::vector<geninfo>{
                         {GN_KEY_RANGE, ton.notelow, ton.notehigh}, // Key range
@@ -240,19 +244,22 @@ std::vector<unsigned char> rgndToSfbk() {
         for (auto &p : prsts) {
             char nam[SFBK_NAME_MAX + 1] {};
             
-            if (sgd_debug) fprintf(stderr, "            Set bank %d preset %d header and zones\n", p.bid, p.pid);
+            TRACE_STEP(ctx.debug, "            Set bank %d preset %d header and zones\n", p.bid, p.pid);
             set_nam(nam, SFBK_NAME_MAX, "prst_%03d_%04d", p.bid, p.pid);
             
-            sf2_inf.setPhdr(nam, p.pid, p.bid, p.zon);
+            sfb.setPhdr(nam, p.pid, p.bid, p.zon);
         }
     }
 
-    return packRiffSfbk();
+    return packRiffSfbk(sfb);
 }
 
+///Packs variable region definitions from global SGXD info into soundfont data
+std::vector<unsigned char> rgndToSfbk() { return rgndToSfbk(sgd_ctx); }
+
 ///Extracts variable region definitions into string
-std::string extractRgnd() {
-    if (sgd_debug) fprintf(stderr, "    Extract RGND info\n");
+std::string extractRgnd(sgxdctx &ctx) {
+    TRACE_STEP(ctx.debug, "    Extract RGND info\n");
     
     std::string out;
     auto set_fstr = [&out]<typename... T>(const char *in, T&&... args) -> void {
@@ -260,10 +267,10 @@ std::string extractRgnd() {
         out.resize(s1 + s0 - 1); snprintf(out.data() + s1, s0, in, args...);
     };
 
-    set_fstr("Global Flags: %s\n", std::bitset<32>(sgd_inf.rgnd.flag).to_string().c_str());
+    set_fstr("Global Flags: %s\n", std::bitset<32>(ctx.inf.rgnd.flag).to_string().c_str());
     set_fstr("Regions:\n");
-    for (const auto &r : sgd_inf.rgnd.rgnd) {
-        set_fstr("    Region: %d\n", &r - sgd_inf.rgnd.rgnd.data());
+    for (const auto &r : ctx.inf.rgnd.rgnd) {
+        set_fstr("    Region: %d\n", &r - ctx.inf.rgnd.rgnd.data());
         for (const auto &t : r) {
             set_fstr("        Tone: %d\n", &t - r.data());
             set_fstr("            Tone Flags: %s\n", std::bitset<32>(t.flag).to_string().c_str());
@@ -293,3 +300,6 @@ std::string extractRgnd() {
 
     return out;
 }
+
+///Extracts variable region definitions from global SGXD info into string
+std::string extractRgnd() { return extractRgnd(sgd_ctx); }
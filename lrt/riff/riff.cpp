@@ -6,8 +6,8 @@
 
 
 ///Unpacks subchunk from RIFF data
-void unpackRiff(unsigned char *in, const unsigned length) {
-    riff_inf.riff = {};
+void unpackRiff(riffinfo &riff, unsigned char *in, const unsigned length) {
+    riff.riff = {};
     if (!in || length < 12) return;
 
     const unsigned char *in_end = in + length;
@@ -46,13 +46,19 @@ void unpackRiff(unsigned char *in, const unsigned length) {
     t_sz = get_int();
     if (in + t_sz > in_end) return;
 
-    riff_inf.riff.setRev(is_rv);
-    riff_inf.riff.setEnd(endian);
-    riff_inf.riff.setFcc(get_fcc());
-    riff_inf.riff.setArr(in, t_sz - 4);
+    riff.riff.setRev(is_rv);
+    riff.riff.setEnd(endian);
+    riff.riff.setFcc(get_fcc());
+    riff.riff.setArr(in, t_sz - 4);
 }
 
+///Unpacks subchunk from RIFF data into global RIFF info
+void unpackRiff(unsigned char *in, const unsigned length) { unpackRiff(riff_inf, in, length); }
+
 ///Unpacks subchunk from RIFF chunk
-void unpackRiff(const chunk chnk) {
-    unpackRiff(chnk.getAll().data(), chnk.size());
+void unpackRiff(riffinfo &riff, const chunk chnk) {
+    unpackRiff(riff, chnk.getAll().data(), chnk.size());
 }
+
+///Unpacks subchunk from RIFF chunk into global RIFF info
+void unpackRiff(const chunk chnk) { unpackRiff(riff_inf, chnk); }
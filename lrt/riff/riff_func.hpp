@@ -13,6 +13,8 @@
 
 inline extern riffinfo riff_inf = {};
 
+void unpackRiff(riffinfo &riff, const chunk chnk);
+void unpackRiff(riffinfo &riff, unsigned char *in, const unsigned length);
 void unpackRiff(const chunk chnk);
 void unpackRiff(unsigned char *in, const unsigned length);
 
@@ -88,8 +88,8 @@ void unpackRiffSfbk(const chunk chnk) {
 
 
 ///Packs SFBK info into array
-std::vector<unsigned char> packRiffSfbk() {
-    if (sf2_inf.info.empty()) return {};
+std::vector<unsigned char> packRiffSfbk(const riffsfbk &sf2) {
+    if (sf2.info.empty()) return {};
 
     chunk out, sfbk;
 
@@ -98,23 +98,23 @@ std::vector<unsigned char> packRiffSfbk() {
 
     //Set information chunk
     if (true) {
-        auto has_ifil = []() -> bool {
+        auto has_ifil = [&sf2]() -> bool {
             return std::find_if(
-                sf2_inf.info.begin(), sf2_inf.info.end(),
+                sf2.info.begin(), sf2.info.end(),
                 [](const chunk &c){return c.getFcc()==INFO_ifil;}
-            ) != sf2_inf.info.end();
+            ) != sf2.info.end();
         };
-        auto has_isng = []() -> bool {
+        auto has_isng = [&sf2]() -> bool {
             return std::find_if(
-                sf2_inf.info.begin(), sf2_inf.info.end(),
+                sf2.info.begin(), sf2.info.end(),
                 [](const chunk &c){return c.getFcc()==INFO_isng;}
-            ) != sf2_inf.info.end();
+            ) != sf2.info.end();
         };
-        auto has_inam = []() -> bool {
+        auto has_inam = [&sf2]() -> bool {
             return std::find_if(
-                sf2_inf.info.begin(), sf2_inf.info.end(),
+                sf2.info.begin(), sf2.info.end(),
                 [](const chunk &c){return c.getFcc()==INFO_INAM;}
-            ) != sf2_inf.info.end();
+            ) != sf2.info.end();
         };
 
         chunk list, info;
@@ -152,7 +152,8 @@ std::vector<unsigned char> packRiffSfbk() {
 
             info += inam;
         }
-        for (auto &i : sf2_inf.info) {
+        //Strings are trimmed on copies, info of caller stays as is
+        for (auto i : sf2.info) {
             std::vector<unsigned char> dat;
             std::string tmp;
             switch(i.getFcc().getInt()) {
@@ -184,17 +185,17 @@ std::vector<unsigned char> packRiffSfbk() {
 
     //Set sample data chunk
     if (true) {
-        auto has_smpl = []() -> bool {
+        auto has_smpl = [&sf2]() -> bool {
             return std::find_if(
-                sf2_inf.pdta.shdr.begin(), sf2_inf.pdta.shdr.end(),
+                sf2.pdta.shdr.begin(), sf2.pdta.shdr.end(),
                 [](const shdrinfo &s){return s.isRam();}
-            ) != sf2_inf.pdta.shdr.end();
+            ) != sf2.pdta.shdr.end();
         };
-        auto has_sm24 = []() -> bool {
+        auto has_sm24 = [&sf2]() -> bool {
             return std::find_if_not(
-                sf2_inf.pdta.shdr.begin(), sf2_inf.pdta.shdr.end(),
+                sf2.pdta.shdr.begin(), sf2.pdta.shdr.end(),
                 [](const shdrinfo &s){return s.is24b();}
-            ) == sf2_inf.pdta.shdr.end();
+            ) == sf2.pdta.shdr.end();
         };
         
         chunk list, sdta;
@@ -204,7 +205,7 @@ std::vector<unsigned char> packRiffSfbk() {
         if (has_smpl()) {
             chunk smpl;
             smpl.setFcc(SDTA_smpl);
-            for (const auto &shd : sf2_inf.pdta.shdr) {
+            for (const auto &shd : sf2.pdta.shdr) {
                 for (const auto &s : shd.smpdata.smpl) smpl.setInt(s, 2);
                 smpl.setPad(SFBK_SMPL_PAD * 2);
             }
@@ -213,7 +214,7 @@ std::vector<unsigned char> packRiffSfbk() {
         if (has_sm24()) {
             chunk sm24;
             sm24.setFcc(SDTA_sm24);
-            for (const auto &shd : sf2_inf.pdta.shdr) {
+            for (const auto &shd : sf2.pdta.shdr) {
                 sm24.setArr(shd.smpdata.sm24);
                 if (shd.smpdata.sm24.size() % 2) sm24.setPad();
                 sm24.setPad(SFBK_SMPL_PAD);
@@ -269,15 +270,15 @@ std::vector<unsigned char> packRiffSfbk() {
         if (true) {
             chunk phdr;
             phdr.setFcc(PDTA_phdr);
-            for (int p = 0, b = 0; p <= sf2_inf.pdta.phdr.size(); ++p) {
-                if (p == sf2_inf.pdta.phdr.size()) {
+            for (int p = 0, b = 0; p <= sf2.pdta.phdr.size(); ++p) {
+                if (p == sf2.pdta.phdr.size()) {
                     phdr.setStr("EOP", SFBK_NAME_MAX);
                     phdr.setPad(4);
                     phdr.setInt(b, 2);
                     phdr.setPad(12);
                 }
                 else {
-                    const auto &phd = sf2_inf.pdta.phdr[p];
+                    const auto &phd = sf2.pdta.phdr[p];
                     phdr.setStr(phd.name, SFBK_NAME_MAX);
                     phdr.setInt(phd.prstid, 2);
                     phdr.setInt(phd.bankid, 2);
@@ -296,7 +297,7 @@ std::vector<unsigned char> packRiffSfbk() {
             int g = 0, m = 0;
 
             pbag.setFcc(PDTA_pbag);
-            for (const auto &phd : sf2_inf.pdta.phdr) {
+            for (const auto &phd : sf2.pdta.phdr) {
                 pbag.setArr(get_bag(phd.pbag, g, m));
             }
             pbag.setInt(g, 2);
@@ -310,7 +311,7 @@ std::vector<unsigned char> packRiffSfbk() {
             chunk pmod;
 
             pmod.setFcc(PDTA_pmod);
-            for (const auto &phd : sf2_inf.pdta.phdr) {
+            for (const auto &phd : sf2.pdta.phdr) {
                 for (const auto &bag : phd.pbag) pmod.setArr(get_mod(bag.mods));
             }
             pmod.setPad(SFBK_MOD_SIZE);
@@ -322,7 +323,7 @@ std::vector<unsigned char> packRiffSfbk() {
             chunk pgen;
 
             pgen.setFcc(PDTA_pgen);
-            for (const auto &phd : sf2_inf.pdta.phdr) {
+            for (const auto &phd : sf2.pdta.phdr) {
                 for (const auto &bag : phd.pbag) pgen.setArr(get_gen(bag.gens));
             }
             pgen.setPad(SFBK_GEN_SIZE);
@@ -334,13 +335,13 @@ std::vector<unsigned char> packRiffSfbk() {
             chunk inst;
             
             inst.setFcc(PDTA_inst);
-            for (int i = 0, b = 0; i <= sf2_inf.pdta.inst.size(); ++i) {
-                if (i == sf2_inf.pdta.inst.size()) {
+            for (int i = 0, b = 0; i <= sf2.pdta.inst.size(); ++i) {
+                if (i == sf2.pdta.inst.size()) {
                     inst.setStr("EOI", SFBK_NAME_MAX);
                     inst.setInt(b, 2);
                 }
                 else {
-                    const auto &ihd = sf2_inf.pdta.inst[i];
+                    const auto &ihd = sf2.pdta.inst[i];
                     inst.setStr(ihd.name, SFBK_NAME_MAX);
                     inst.setInt(b, 2); b += ihd.ibag.size();
                 }
@@ -354,7 +355,7 @@ std::vector<unsigned char> packRiffSfbk() {
             int g = 0, m = 0;
 
             ibag.setFcc(PDTA_ibag);
-            for (const auto &ihd : sf2_inf.pdta.inst) {
+            for (const auto &ihd : sf2.pdta.inst) {
                 ibag.setArr(get_bag(ihd.ibag, g, m));
             }
             ibag.setInt(g, 2);
@@ -368,7 +369,7 @@ std::vector<unsigned char> packRiffSfbk() {
             chunk imod;
 
             imod.setFcc(PDTA_imod);
-            for (const auto &ihd : sf2_inf.pdta.inst) {
+            for (const auto &ihd : sf2.pdta.inst) {
                 for (const auto &bag : ihd.ibag) imod.setArr(get_mod(bag.mods));
             }
             imod.setPad(SFBK_MOD_SIZE);
@@ -380,7 +381,7 @@ std::vector<unsigned char> packRiffSfbk() {
             chunk igen;
 
             igen.setFcc(PDTA_igen);
-            for (const auto &ihd : sf2_inf.pdta.inst) {
+            for (const auto &ihd : sf2.pdta.inst) {
                 for (const auto &bag : ihd.ibag) igen.setArr(get_gen(bag.gens));
             }
             igen.setPad(SFBK_GEN_SIZE);
@@ -392,8 +393,8 @@ std::vector<unsigned char> packRiffSfbk() {
             chunk shdr;
             
             shdr.setFcc(PDTA_shdr);
-            for (int s = 0, sb = 0; s < sf2_inf.pdta.shdr.size(); ++s) {
-                const auto &shd = sf2_inf.pdta.shdr[s];
+            for (int s = 0, sb = 0; s < sf2.pdta.shdr.size(); ++s) {
+                const auto &shd = sf2.pdta.shdr[s];
                 shdr.setStr(shd.name, SFBK_NAME_MAX);
                 if (shd.isRom()) {
                     shdr.setInt(shd.begin(), 4);
@@ -433,3 +434,7 @@ std::vector<unsigned char> packRiffSfbk() {
 
     return out.getAll();
 }
+
+
+///Packs SFBK info from global SFBK info
+std::vector<unsigned char> packRiffSfbk() { return packRiffSfbk(sf2_inf); }
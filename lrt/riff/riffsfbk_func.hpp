@@ -25,6 +25,7 @@ void unpackRiffSfbk(
     unsigned char *in, const unsigned length,
     const EndianType endian = ENDIAN_LITTLE, const bool is_rv = 0
 );
+std::vector<unsigned char> packRiffSfbk(const riffsfbk &sf2);
 std::vector<unsigned char> packRiffSfbk();
 
 #ifdef UNPACKSDTA_IMPLEMENTATION
@@ -124,8 +124,8 @@ void unpackRiffWave(const chunk chnk) {
 
 
 ///Packs WAVE info into array
-std::vector<unsigned char> packRiffWave() {
-    if (wav_inf.fmt.empty() || wav_inf.wavl.empty()) return {};
+std::vector<unsigned char> packRiffWave(const riffwave &wav) {
+    if (wav.fmt.empty() || wav.wavl.empty()) return {};
 
     chunk out, wave;
 
@@ -138,27 +138,27 @@ std::vector<unsigned char> packRiffWave() {
         unsigned t_sz;
 
         fmt.setFcc(WAVE_fmt);
-        fmt.setInt(wav_inf.fmt.codec, 2);
-        fmt.setInt(wav_inf.fmt.chns, 2);
-        fmt.setInt(wav_inf.fmt.smprate, 4);
-        fmt.setInt(wav_inf.fmt.bytrate, 4);
-        fmt.setInt(wav_inf.fmt.align, 2);
-        fmt.setInt(wav_inf.fmt.bitrate, 2);
+        fmt.setInt(wav.fmt.codec, 2);
+        fmt.setInt(wav.fmt.chns, 2);
+        fmt.setInt(wav.fmt.smprate, 4);
+        fmt.setInt(wav.fmt.bytrate, 4);
+        fmt.setInt(wav.fmt.align, 2);
+        fmt.setInt(wav.fmt.bitrate, 2);
         t_sz = 0;
-        if (wav_inf.fmt.smpinfo != 0) t_sz += 2;
-        if (wav_inf.fmt.chnmask != 0) t_sz += 4;
-        if (wav_inf.fmt.guid != uuid{}) t_sz += 16;
-        t_sz += wav_inf.fmt.extra.size();
+        if (wav.fmt.smpinfo != 0) t_sz += 2;
+        if (wav.fmt.chnmask != 0) t_sz += 4;
+        if (wav.fmt.guid != uuid{}) t_sz += 16;
+        t_sz += wav.fmt.extra.size();
         fmt.setInt(t_sz, 2);
-        if (wav_inf.fmt.smpinfo != 0) fmt.setInt(wav_inf.fmt.smpinfo, 2);
-        if (wav_inf.fmt.chnmask != 0) fmt.setInt(wav_inf.fmt.chnmask, 4);
-        if (wav_inf.fmt.guid != uuid{}) {
-            fmt.setInt(wav_inf.fmt.guid.g0, 4);
-            fmt.setInt(wav_inf.fmt.guid.g1, 2);
-            fmt.setInt(wav_inf.fmt.guid.g2, 2);
-            fmt.setArr(wav_inf.fmt.guid.g3, 8);
+        if (wav.fmt.smpinfo != 0) fmt.setInt(wav.fmt.smpinfo, 2);
+        if (wav.fmt.chnmask != 0) fmt.setInt(wav.fmt.chnmask, 4);
+        if (wav.fmt.guid != uuid{}) {
+            fmt.setInt(wav.fmt.guid.g0, 4);
+            fmt.setInt(wav.fmt.guid.g1, 2);
+            fmt.setInt(wav.fmt.guid.g2, 2);
+            fmt.setArr(wav.fmt.guid.g3, 8);
         }
-        fmt.setArr(wav_inf.fmt.extra);
+        fmt.setArr(wav.fmt.extra);
 
         wave += fmt;
     }
@@ -168,7 +168,7 @@ std::vector<unsigned char> packRiffWave() {
         chunk data;
 
         data.setFcc(WAVL_data);
-        for (const auto &w : wav_inf.wavl) {
+        for (const auto &w : wav.wavl) {
             if (w.pcm.empty()) continue;
             for (const auto &s : w.pcm) data.setInt(s, 2);
         }
@@ -177,11 +177,11 @@ std::vector<unsigned char> packRiffWave() {
     }
 
     //Set information list chunk if applicable
-    if (!wav_inf.info.empty()) {
+    if (!wav.info.empty()) {
         chunk list, info;
 
         info.setFcc(LIST_INFO);
-        for (const auto &i : wav_inf.info) info += i;
+        for (const auto &i : wav.info) info += i;
 
         list.setFcc(RIFF_LIST);
         list.setChk(info, false);
@@ -190,7 +190,7 @@ std::vector<unsigned char> packRiffWave() {
     }
 
     //Set sampler chunk if applicable
-    for (const auto &s : wav_inf.smpl) {
+    for (const auto &s : wav.smpl) {
         chunk smpl;
 
         smpl.setFcc(WAVE_smpl);
@@ -217,17 +217,17 @@ std::vector<unsigned char> packRiffWave() {
     }
 
     //Set instrument chunk if applicable
-    if (!wav_inf.inst.empty()) {
+    if (!wav.inst.empty()) {
         chunk inst;
 
         inst.setFcc(WAVE_inst);
-        inst.setInt(wav_inf.inst.noteroot, 1);
-        inst.setInt(wav_inf.inst.notetune, 1);
-        inst.setInt(wav_inf.inst.notegain, 1);
-        inst.setInt(wav_inf.inst.notelow, 1);
-        inst.setInt(wav_inf.inst.notehigh, 1);
-        inst.setInt(wav_inf.inst.vellow, 1);
-        inst.setInt(wav_inf.inst.velhigh, 1);
+        inst.setInt(wav.inst.noteroot, 1);
+        inst.setInt(wav.inst.notetune, 1);
+        inst.setInt(wav.inst.notegain, 1);
+        inst.setInt(wav.inst.notelow, 1);
+        inst.setInt(wav.inst.notehigh, 1);
+        inst.setInt(wav.inst.vellow, 1);
+        inst.setInt(wav.inst.velhigh, 1);
 
         wave += inst;
     }
@@ -238,3 +238,7 @@ std::vector<unsigned char> packRiffWave() {
 
     return out.getAll();
 }
+
+
+///Packs WAVE info from global WAVE info
+std::vector<unsigned char> packRiffWave() { return packRiffWave(wav_inf); }
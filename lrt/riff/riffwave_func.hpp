@@ -40,6 +40,7 @@ void unpackRiffWave(
     unsigned char *in, const unsigned length,
     const EndianType endian = ENDIAN_LITTLE, const bool is_rv = 0
 );
+std::vector<unsigned char> packRiffWave(const riffwave &wav);
 std::vector<unsigned char> packRiffWave();
 
 #ifdef UNPACKFMT_IMPLEMENTATION
@@ -1,94 +1,222 @@
 #include <algorithm>
+#include <array>
 #include <bitset>
+#include <charconv>
+#include <climits>
 #include <cmath>
 #include <cstdio>
-#include <ctime>
+#include <cstring>
 #include <map>
 #include <utility>
 #include <vector>
 #include "sgxd_const.hpp"
 #include "sgxd_types.hpp"
 #include "sgxd_func.hpp"
+#include "parallel.hpp"
+#include "trace.hpp"
 #include "midi/midi_const.hpp"
 #include "midi/midi_types.hpp"
 #include "midi/midi_func.hpp"
 
 
-///Unpacks variable sequence definitions from SEQD data
-void unpackSeqd(unsigned char *in, const unsigned length) {
-    if (sgd_debug) fprintf(stderr, "    Unpack SEQD\n");
+///Packs SEQD messages up to end of sequence
+static std::vector<unsigned char> packSeqdMesg(const std::vector<mesginfo> &in) {
+    mesgtrack trk {in};
+    std::vector<unsigned char> out(trk.getBound());
+    out.resize(trk.getAll(out.data()) - out.data());
+    return out;
+}
+
+///SEQD Request Operand Info
+struct seqdops {
+    static const unsigned ARGS = seqdinst::ARGS;
+    unsigned char size = 0;
+    int def[ARGS] {};           //Used when operand is left out
+};
+
+///Gets operands read by a request status
+static const seqdops& getSeqdOps(const char op) {
+    static const auto tbl = []() {
+        std::array<seqdops, 256> out {};
+        auto set_ops = [&out](const char op, std::initializer_list<int> def) -> void {
+            auto &o = out[(unsigned char)op];
+            o.size = def.size();
+            std::copy(def.begin(), def.end(), o.def);
+        };
+
+        set_ops(SEQD_SUB_START, {0, 0, 0, 0});
+        set_ops(SEQD_SUB_STOP, {0});
+        set_ops(SEQD_SUB_STOPREL, {0});
+        set_ops(SEQD_SUB_GETSTAT, {0});
+        set_ops(SEQD_CONTROL, {0, 0, 0, 0, 0, 0});
+        set_ops(SEQD_ADSR, {0, 0, 0});
+        set_ops(SEQD_BEND, {0, 12, 12, 0});
+        set_ops(SEQD_ADSR_DIRECT, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+        set_ops(SEQD_START, {0, 0, 0, 4096});
+        set_ops(SEQD_STOP, {0, 0});
+        set_ops(SEQD_STOPREL, {0, 0});
+        set_ops(SEQD_GETPORTSTAT, {0, 0});
+        set_ops(SEQD_STARTSMPL, {0, 0, 4096, 128, 0, 0, 0});
+        set_ops(SEQD_STARTNOISE, {0, 0, 4096, 128, 0, 0, 0});
+        for (const char op : {
+            SEQD_SYSREG_INIT, SEQD_SYSREG_ADD, SEQD_SYSREG_MINUS,
+            SEQD_SYSREG_MULT, SEQD_SYSREG_DIVI, SEQD_SYSREG_MODU,
+            SEQD_SYSREG_AND, SEQD_SYSREG_OR, SEQD_SYSREG_XOR
+        }) set_ops(op, {0, 0, 0});
+        set_ops(SEQD_WAIT, {0});
+        set_ops(SEQD_JUMP, {0});
+        set_ops(SEQD_LOOPBEG, {0});
+        set_ops(SEQD_JUMPNEQ, {0, 0, 0});
+        set_ops(SEQD_JUMP3, {0, 0, 0});
+        set_ops(SEQD_JUMPGEQ, {0, 0, 0});
+        set_ops(SEQD_JUMPLES, {0, 0, 0});
+        set_ops(SEQD_CALLMKR, {0});
+        set_ops(SEQD_LOOPBREAK, {0, 0});
+        set_ops(SEQD_PRINT, {0});
+
+        return out;
+    }();
+
+    return tbl[(unsigned char)op];
+}
 
-    sgd_inf.seqd = {};
-    if (!sgd_beg || !in || length < 8) return;
+///Unpacks PSX-style request stream into programme, up to end of sequence
+static void unpackSeqdProg(seqdprog &out, const unsigned char *in, const unsigned length) {
+    out = {};
+    if (!in || !length) return;
 
     const unsigned char *in_end = in + length;
-    unsigned t_sz;
-    auto &out = sgd_inf.seqd;
     
-    struct seqd_vals {
-        int v[3] {};
-        int& operator[](const int &i) { return v[i]; }
-        const int& operator[](const int &i) const { return v[i]; }
-    };
+    //Past the end reads as a request, so operands left out there get defaults
+    auto get_peek = [&in, &in_end]() -> unsigned char { return (in < in_end) ? *in : 0xFF; };
+    //Packed decimal up to size bytes or next request, stops at first non-decimal digit
+    //  Too many digits saturate, as they did when read as text
+    auto get_bcd = [&in, &get_peek](int siz, const bool is_neg, const int def) -> int {
+        if (!get_peek()) return def;
 
-    auto get_int = [&in, &in_end](const unsigned length) -> unsigned {
-        unsigned out = 0;
-        for (int i = 0; i < length; ++i) {
-            if (in >= in_end) break;
-            out |= (unsigned)*(in++) << (8 * i);
+        long long out = 0;
+        bool is_dec = true;
+        for (; siz-- > 0 && get_peek() < 0xA0; ++in) {
+            for (const int d : {*in >> 4, *in & 0x0F}) {
+                if (d > 9) is_dec = false;
+                if (!is_dec) break;
+                out = (out > (LLONG_MAX - d) / 10) ? LLONG_MAX : out * 10 + d;
+            }
         }
-        return out;
-    };
-    auto get_str = [](const unsigned char *in, const unsigned adr) -> std::string {
-        std::string out;
-        if (!adr);
-        else { out = (const char*)(in + adr); if (!out[0]) out.clear(); }
-        return out;
-    };
-    auto get_fstr = []<typename... T>(const char *in, T&&... args) -> std::string {
-        std::string out; int s0 = snprintf(nullptr, 0, in, args...) + 1;
-        out.resize(s0 - 1); snprintf(out.data(), s0, in, args...);
-        return out;
+        return (int)(out * ((!is_neg) ? 1 : -1));
     };
-    auto get_bcd = [](auto &in, int siz, const bool is_neg, const unsigned def = 0) -> int {
-            if (!in[0]) return def;
-            
-            char tmp[16] {};
-            for (int z = 0; siz-- > 0 && *in < 0xA0; z += 2) {
-                snprintf(tmp + z, 3, "%02X", *in++);
-            }
-            
-            return strtol(tmp, nullptr, 10) * ((!is_neg) ? 1 : -1);
-        };
-    auto get_val = [&get_bcd](auto&& self, auto &in, const unsigned def = 0) -> int {
-        int typ, out;
-        if (*in >= 0xA0) return def;
+    auto set_arg = [&](auto&& self, const int def) -> void {
+        if (get_peek() >= 0xA0) { out.arg.push_back({SEQD_POSITIVE, def}); return; }
 
-        typ = *in++;
+        const int typ = *in++;
         if (typ >> 4 == SEQD_RANDOM) {
-            int b0, b1, b2, b3;
-            b0 = self(self, in);    // Minimum
-            b1 = self(self, in);    // Maximum
-            b2 = self(self, in);    // Increment
-            b3 = (!b2 ? 0 : abs(b1 - b0) / abs(b2)) + 1;
-            int b4[b3] {};
-            for (auto &b : b4) { b = b0; b0 += b2; }
-            out = b4[rand() % b3];
+            out.arg.push_back({SEQD_RANDOM, 0});
+            self(self, 0);          // Minimum
+            self(self, 0);          // Maximum
+            self(self, 0);          // Increment
         }
         else if (typ >> 4 < SEQD_SKIP) {
-            out = get_bcd(in, typ & 0x0F, typ >> 4 == SEQD_NEGATIVE, def);
+            //Registers keep their kind, conversion reads them as plain numbers
+            const char knd = (typ >> 4 == SEQD_SYSREG || typ >> 4 == SEQD_REG) ? typ >> 4 : SEQD_POSITIVE;
+            out.arg.push_back({knd, get_bcd(typ & 0x0F, typ >> 4 == SEQD_NEGATIVE, def)});
         }
         else {
-            auto end = in + (typ & 0x0F);
-            while (in < end) self(self, in);
-            out = def;
+            //Skipped operands are read and dropped
+            const auto siz = out.arg.size();
+            const auto end = in + (typ & 0x0F);
+            while (in < end && in < in_end) {
+                const auto pos = in;
+                self(self, 0);
+                if (in == pos) break;
+            }
+            out.arg.resize(siz);
+            out.arg.push_back({SEQD_POSITIVE, def});
         }
-        return out;
     };
-    auto set_bnk = [&sgd_inf](const int &prs, const int &nte, int &bnk) -> void {
+
+    while (in < in_end) {
+        while (in < in_end && *in < 0xA0) in += 1;
+        if (in >= in_end) break;
+
+        const char op = *in++;
+        const auto &ops = getSeqdOps(op);
+        out.inst.push_back({op, ops.size, (unsigned)out.arg.size()});
+        for (unsigned a = 0; a < ops.size; ++a) set_arg(set_arg, ops.def[a]);
+
+        if (op == SEQD_EOR) break;
+    }
+}
+
+///SEQD First Pass Output
+///  Kept apart from its sequence until every first pass is done, others are only read meanwhile
+struct seqdpass {
+    std::vector<unsigned char> data;
+    std::string asmdata;
+    seqdprog prog;
+};
+
+///Moves first pass output into its sequence
+static void setSeqdPass(seqdseq &seq, seqdpass &pass) {
+    seq.data = std::move(pass.data);
+    seq.asmdata = std::move(pass.asmdata);
+    seq.prog = std::move(pass.prog);
+}
+
+///Converts PSX-style requests or raw MIDI of a sequence into messages (first pass)
+///  Output goes into pass, 0 if there's nothing to convert
+static int convertSeqdFirst(const sgxdctx &ctx, const seqdseq &seq, seqdrng &rng, seqdpass &pass) {
+    if (seq.empty()) return 0;
+    if (seq.fmt != SEQD_REQUEST && seq.fmt != SEQD_RAWMIDI) return 0;
+
+    unsigned t_sz = 0;
+    midiinfo mid {};
+    
+    struct seqd_vals {
+        int v[3] {};
+        int& operator[](const int &i) { return v[i]; }
+        const int& operator[](const int &i) const { return v[i]; }
+    };
+
+    //Asm listing is only made when text output is on
+    //  % is a number and @ an address label, each from args in order
+    bool is_ins = false;
+    auto set_asm = [&ctx, &pass, &is_ins](const char *form, std::initializer_list<int> args = {}) -> void {
+        if (!ctx.text) return;
+
+        auto &out = pass.asmdata;
+        auto arg = args.begin();
+        char tmp[16];
+        bool is_lbl = false;
+        for (const char *in = form; *in; ++in) {
+            const char *nxt = strpbrk(in, "%@");
+            if (!nxt) { out += in; break; }
+            out.append(in, nxt); in = nxt;
+
+            const int val = *(arg++);
+            char *end = std::to_chars(tmp, tmp + sizeof(tmp), val).ptr;
+            //Labels are zero-padded to 6 characters, sign included
+            if (*in == '@') {
+                is_lbl = true;
+                if (val < 0) out += '-';
+                out.append(std::max<long>(0, 6 - (end - tmp)), '0');
+                out.append(tmp + (val < 0), end);
+            }
+            else out.append(tmp, end);
+        }
+        if (!is_lbl) is_ins = true;
+    };
+    //Random operands pick one of minimum, minimum + increment, ... up to maximum
+    auto get_arg = [&rng](auto&& self, const seqdarg *&in) -> int {
+        const auto &a = *in++;
+        if (a.typ != SEQD_RANDOM) return a.val;
+
+        const int b0 = self(self, in), b1 = self(self, in), b2 = self(self, in);
+        return rng.getPick(b0, b1, b2);
+    };
+    auto set_bnk = [&ctx](const int &prs, const int &nte, int &bnk) -> void {
         bnk = -1;
-        for (const auto &rgn : sgd_inf.rgnd.rgnd) {
-            if (&rgn - sgd_inf.rgnd.rgnd.data() != prs) continue;
+        for (const auto &rgn : ctx.inf.rgnd.rgnd) {
+            if (&rgn - ctx.inf.rgnd.rgnd.data() != prs) continue;
             for (const auto &ton : rgn) {
                 if (bnk < 0 && nte >= ton.notelow && nte <= ton.notehigh) {
                     bnk = ton.bnkid;
@@ -98,53 +226,758 @@ void unpackSeqd(unsigned char *in, const unsigned length) {
             break;
         }
     };
-    auto chk_seq = [&sgd_inf](const int &grp, const int &seq) -> bool {
-        return (grp >= 0 && grp < sgd_inf.seqd.seqd.size()) &&
-               (seq >= 0 && seq < sgd_inf.seqd.seqd[grp].seq.size()) &&
-               !sgd_inf.seqd.seqd[grp].seq[seq].empty();
+    auto chk_seq = [&ctx](const int &grp, const int &seq) -> bool {
+        return (grp >= 0 && grp < ctx.inf.seqd.seqd.size()) &&
+               (seq >= 0 && seq < ctx.inf.seqd.seqd[grp].seq.size()) &&
+               !ctx.inf.seqd.seqd[grp].seq[seq].empty();
     };
-    auto get_mid = [](const std::vector<mesginfo> &in) -> std::vector<unsigned char> {
-        std::vector<unsigned char> out;
-        const mesginfo *prv = 0;
-        for (const auto &m : in) {
-            auto dat = m.getAll(prv);
-            prv = &m;
-            out.insert(out.end(), dat.begin(), dat.end());
-            if (m.getStat() == META_END_OF_SEQUENCE) break;
+    
+    std::vector<mesginfo> tmp;
+    
+    if (seq.fmt == SEQD_REQUEST) {
+        //https://github.com/Nenkai/010GameTemplates/blob/main/Sony/SGXD.bt
+        
+        std::map<int, seqd_vals> ids;
+        
+        pass.prog = seq.prog;
+        if (pass.prog.empty()) unpackSeqdProg(pass.prog, seq.data.data(), seq.data.size());
+        
+        if (ctx.text) pass.asmdata.reserve(32 * pass.prog.inst.size() + 16);
+        set_asm("abstime_@:\n", {0});
+        
+        //Convert PSX-style requests into midi and asm
+        TRACE_STEP(ctx.debug, "                Convert PSX-style requests\n");
+        for (const auto &ins : pass.prog.inst) {
+            const seqdarg *arg = pass.prog.arg.data() + ins.argi;
+            int v[seqdops::ARGS] {};
+            for (unsigned a = 0; a < ins.argc; ++a) v[a] = get_arg(get_arg, arg);
+
+            switch(ins.op) {
+                //Auditory instructions
+                case SEQD_SUB_START: {
+                    TRACE_FIELD(ctx.debug, "                    Set song start\n");
+                    int id, prg, nte, vol;
+                    id = v[0];
+                    prg = v[1];
+                    nte = v[2];
+                    vol = v[3];
+                    TRACE_FIELD(ctx.debug, "                        ID: %d\n", id);
+                    TRACE_FIELD(ctx.debug, "                        Group: %d\n", prg);
+                    TRACE_FIELD(ctx.debug, "                        Sequence: %d\n", nte);
+                    TRACE_FIELD(ctx.debug, "                        Volume: %d\n", vol);
+                    
+                    if (chk_seq(prg, nte)) {
+                        tmp.emplace_back(
+                            t_sz,
+                            META_SEQUENCER_EXCLUSIVE,
+                            (unsigned char[]){(unsigned char)SEQD_SUB_START, (unsigned char)prg, (unsigned char)nte}
+                        );
+                        ids[id] = {prg, nte};
+                    }
+                    continue;
+                }
+                case SEQD_SUB_STOP: {
+                    TRACE_FIELD(ctx.debug, "                    Set song stop\n");
+                    int id;
+                    id = v[0];
+                    TRACE_FIELD(ctx.debug, "                        ID: %d\n", id);
+                    
+                    if (ids.find(id) != ids.end()) {
+                        tmp.emplace_back(
+                            t_sz,
+                            META_SEQUENCER_EXCLUSIVE,
+                            (unsigned char[]){(unsigned char)SEQD_SUB_STOP, (unsigned char)ids[id][0], (unsigned char)ids[id][1]}
+                        );
+                    }
+                    continue;
+                }
+                case SEQD_SUB_STOPREL: {
+                    TRACE_FIELD(ctx.debug, "                    Set song fade\n");
+                    int id;
+                    id = v[0];
+                    TRACE_FIELD(ctx.debug, "                        ID: %d\n", id);
+                    
+                    if (ids.find(id) != ids.end()) {
+                        tmp.emplace_back(
+                            t_sz,
+                            META_SEQUENCER_EXCLUSIVE,
+                            (unsigned char[]){(unsigned char)SEQD_SUB_STOPREL, (unsigned char)ids[id][0], (unsigned char)ids[id][1]}
+                        );
+                    }
+                    continue;
+                }
+                case SEQD_SUB_GETSTAT: {
+                    TRACE_FIELD(ctx.debug, "                    Set song status\n");
+                    int id;
+                    id = v[0];
+                    TRACE_FIELD(ctx.debug, "                        ID: %d\n", id);
+                    
+                    if (ids.find(id) != ids.end()) {
+                        tmp.emplace_back(
+                            t_sz,
+                            META_SEQUENCER_EXCLUSIVE,
+                            (unsigned char[]){(unsigned char)SEQD_SUB_GETSTAT, (unsigned char)ids[id][0], (unsigned char)ids[id][1]}
+                        );
+                    }
+                    continue;
+                }
+                case SEQD_CONTROL: {
+                    TRACE_FIELD(ctx.debug, "                    Set controller\n");
+                    int id, typ, val, tim, unk, glb;
+                    id = v[0];
+                    typ = v[1];
+                    val = v[2];
+                    tim = v[3];
+                    unk = v[4];
+                    glb = v[5];
+                    TRACE_FIELD(ctx.debug, "                        ID: %d\n", id);
+                    TRACE_FIELD(ctx.debug, "                        Type: %d\n", typ);
+                    TRACE_FIELD(ctx.debug, "                        Value: %d\n", val);
+                    TRACE_FIELD(ctx.debug, "                        Time: %d\n", tim);
+                    TRACE_FIELD(ctx.debug, "                        Unknown: %d\n", unk);
+                    TRACE_FIELD(ctx.debug, "                        Is global: %d\n", glb);
+                    //Dunno the controller types, come back later
+                    continue;
+                }
+                case SEQD_ADSR: {
+                    TRACE_FIELD(ctx.debug, "                    Set envelope id\n");
+                    int id, typ, glb;
+                    id = v[0];
+                    typ = v[1];
+                    glb = v[2];
+                    TRACE_FIELD(ctx.debug, "                        ID: %d\n", id);
+                    TRACE_FIELD(ctx.debug, "                        Type: %d\n", typ);
+                    TRACE_FIELD(ctx.debug, "                        Is global: %d\n", glb);
+                    //Dunno the ADSR indices, come back later
+                    continue;
+                }
+                case SEQD_BEND: {
+                    TRACE_FIELD(ctx.debug, "                    Set bend\n");
+                    int unk0, unk1, unk2, glb;
+                    unk0 = v[0];
+                    unk1 = v[1];
+                    unk2 = v[2];
+                    glb = v[3];
+                    TRACE_FIELD(ctx.debug, "                        Unknown 1: %d\n", unk0);
+                    TRACE_FIELD(ctx.debug, "                        Unknown 2: %d\n", unk1);
+                    TRACE_FIELD(ctx.debug, "                        Unknown 3: %d\n", unk2);
+                    TRACE_FIELD(ctx.debug, "                        Is global: %d\n", glb);
+                    //Dunno how bend works, come back later
+                    continue;
+                }
+                case SEQD_ADSR_DIRECT: {
+                    TRACE_FIELD(ctx.debug, "                    Set envelope\n");
+                    int p0, unk, p0_0, p0_1, p0_2, p0_3, p1_0, p1_1, p1_2, p1_3, glb;
+                    p0 = v[0];
+                    unk = v[1];
+                    p0_0 = v[2];
+                    p0_1 = std::min(127, v[3]);
+                    p0_2 = std::min(15, v[4]);
+                    p0_3 = std::min(15, v[5]);
+                    p1_0 = v[6];
+                    p1_1 = v[7];
+                    p1_2 = v[8];
+                    p1_3 = v[9];
+                    glb = v[10];
+                    TRACE_FIELD(ctx.debug, "                        Type: %d\n", p0);
+                    TRACE_FIELD(ctx.debug, "                        Value 1: 0x%02X02X02X02X\n", p0_0, p0_1, p0_2, p0_3);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: 0x%02X02X02X02X\n", p1_0, p1_1, p1_2, p1_3);
+                    TRACE_FIELD(ctx.debug, "                        Is global: %d\n", glb);
+                    //Too lazy, come back later
+                    continue;
+                }
+                case SEQD_START: {
+                    TRACE_FIELD(ctx.debug, "                    Set note start\n");
+                    int id, prg, nte, vol, bnk;
+                    id = v[0];
+                    prg = v[1];
+                    nte = v[2];
+                    vol = v[3];
+                    TRACE_FIELD(ctx.debug, "                        ID: %d\n", id);
+                    TRACE_FIELD(ctx.debug, "                        Region: %d\n", prg);
+                    TRACE_FIELD(ctx.debug, "                        Note: %d\n", nte);
+                    TRACE_FIELD(ctx.debug, "                        Volume: %d\n", vol);
+                    
+                    set_bnk(prg, nte, bnk);
+                    if (bnk >= 0) {
+                        TRACE_FIELD(ctx.debug, "                        Bank: %d\n", bnk);
+                        tmp.emplace_back(
+                            t_sz,
+                            META_SEQUENCER_EXCLUSIVE,
+                            (unsigned char[]){(unsigned char)SEQD_START, (unsigned char)bnk, (unsigned char)prg, (unsigned char)nte, (unsigned char)((vol * 127) / 4096)}
+                        );
+                        ids[id] = {bnk, prg, nte};
+                    }
+                    continue;
+                }
+                case SEQD_STOP: {
+                    TRACE_FIELD(ctx.debug, "                    Set note stop\n");
+                    int id, glb;
+                    id = v[0];
+                    glb = v[1];
+                    TRACE_FIELD(ctx.debug, "                        ID: %d\n", id);
+                    TRACE_FIELD(ctx.debug, "                        Is global: %d\n", glb);
+                    
+                    if (!glb && ids.find(id) == ids.end()) continue;
+                    if (glb) tmp.emplace_back(
+                        t_sz, META_SEQUENCER_EXCLUSIVE,
+                        (unsigned char[]){(unsigned char)SEQD_STOP}
+                    );
+                    else tmp.emplace_back(
+                        t_sz, META_SEQUENCER_EXCLUSIVE,
+                        (unsigned char[]){(unsigned char)SEQD_STOP, (unsigned char)ids[id][0], (unsigned char)ids[id][1], (unsigned char)ids[id][2], 0}
+                    );
+                    continue;
+                }
+                case SEQD_STOPREL: {
+                    TRACE_FIELD(ctx.debug, "                    Set note fade\n");
+                    int id, glb;
+                    id = v[0];
+                    glb = v[1];
+                    TRACE_FIELD(ctx.debug, "                        ID: %d\n", id);
+                    TRACE_FIELD(ctx.debug, "                        Is global: %d\n", glb);
+                    
+                    if (!glb && ids.find(id) == ids.end()) continue;
+                    if (glb) tmp.emplace_back(
+                        t_sz, META_SEQUENCER_EXCLUSIVE,
+                        (unsigned char[]){(unsigned char)SEQD_STOPREL}
+                    );
+                    else tmp.emplace_back(
+                        t_sz, META_SEQUENCER_EXCLUSIVE,
+                        (unsigned char[]){(unsigned char)SEQD_STOPREL, (unsigned char)ids[id][0], (unsigned char)ids[id][1], (unsigned char)ids[id][2], 127}
+                    );
+                    continue;
+                }
+                case SEQD_GETPORTSTAT: {
+                    TRACE_FIELD(ctx.debug, "                    Set note status\n");
+                    int id, glb;
+                    id = v[0];
+                    glb = v[1];
+                    TRACE_FIELD(ctx.debug, "                        ID: %d\n", id);
+                    TRACE_FIELD(ctx.debug, "                        Is global: %d\n", glb);
+                    
+                    if (!glb && ids.find(id) == ids.end()) continue;
+                    if (glb) tmp.emplace_back(
+                        t_sz, META_SEQUENCER_EXCLUSIVE,
+                        (unsigned char[]){(unsigned char)SEQD_GETPORTSTAT}
+                    );
+                    else tmp.emplace_back(
+                        t_sz, META_SEQUENCER_EXCLUSIVE,
+                        (unsigned char[]){(unsigned char)SEQD_GETPORTSTAT, (unsigned char)ids[id][0], (unsigned char)ids[id][1], (unsigned char)ids[id][2]}
+                    );
+                    continue;
+                }
+                case SEQD_STARTSMPL: {
+                    TRACE_FIELD(ctx.debug, "                    Set sample start\n");
+                    int id, sid, vol, pri, grp, gmd, gnm;
+                    id = v[0];
+                    sid = v[1];
+                    vol = v[2];
+                    pri = v[3];
+                    grp = v[4];
+                    gmd = v[5];
+                    gnm = v[6];
+                    TRACE_FIELD(ctx.debug, "                        ID: %d\n", id);
+                    TRACE_FIELD(ctx.debug, "                        Sample ID: %d\n", sid);
+                    TRACE_FIELD(ctx.debug, "                        Volume: %d\n", vol);
+                    TRACE_FIELD(ctx.debug, "                        Priority: %d\n", pri);
+                    TRACE_FIELD(ctx.debug, "                        Group ID 1: %d\n", grp);
+                    TRACE_FIELD(ctx.debug, "                        Group mode: %d\n", gmd);
+                    TRACE_FIELD(ctx.debug, "                        Group ID 2: %d\n", gnm);
+                    //Need example, come back later
+                    continue;
+                }
+                case SEQD_STARTNOISE: {
+                    TRACE_FIELD(ctx.debug, "                    Set noise start\n");
+                    int id, nid, vol, pri, grp, gmd, gnm;
+                    id = v[0];
+                    nid = v[1];
+                    vol = v[2];
+                    pri = v[3];
+                    grp = v[4];
+                    gmd = v[5];
+                    gnm = v[6];
+                    TRACE_FIELD(ctx.debug, "                        ID: %d\n", id);
+                    TRACE_FIELD(ctx.debug, "                        Noise ID: %d\n", nid);
+                    TRACE_FIELD(ctx.debug, "                        Volume: %d\n", vol);
+                    TRACE_FIELD(ctx.debug, "                        Priority: %d\n", pri);
+                    TRACE_FIELD(ctx.debug, "                        Group ID 1: %d\n", grp);
+                    TRACE_FIELD(ctx.debug, "                        Group mode: %d\n", gmd);
+                    TRACE_FIELD(ctx.debug, "                        Group ID 2: %d\n", gnm);
+                    //Need example, come back later
+                    continue;
+                }
+                //MIPS R4000 instructions (guesstimate)
+                case SEQD_SYSREG_INIT: {
+                    TRACE_FIELD(ctx.debug, "                    Set register\n");
+                    int typ, vl0, vl1;
+                    typ = v[0];
+                    vl0 = v[1];
+                    vl1 = v[2];
+                    TRACE_FIELD(ctx.debug, "                        Register: %d\n", typ);
+                    TRACE_FIELD(ctx.debug, "                        Value 1: %d\n", vl0);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: %d\n", vl1);
+                    
+                    set_asm("    li $s%, %\n", {typ, vl0});
+                    set_asm("    addi $s%, $s%, %\n", {typ, typ, vl1});
+                    continue;
+                }
+                case SEQD_SYSREG_ADD: {
+                    TRACE_FIELD(ctx.debug, "                    Set register ADD\n");
+                    int typ, vl0, vl1;
+                    typ = v[0];
+                    vl0 = v[1];
+                    vl1 = v[2];
+                    TRACE_FIELD(ctx.debug, "                        Register: %d\n", typ);
+                    TRACE_FIELD(ctx.debug, "                        Value 1: %d\n", vl0);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: %d\n", vl1);
+                    
+                    set_asm("    addi $s%, $0, %\n", {typ, vl0});
+                    set_asm("    addi $s%, $s%, %\n", {typ, typ, vl1});
+                    continue;
+                }
+                case SEQD_SYSREG_MINUS: {
+                    TRACE_FIELD(ctx.debug, "                    Set register SUBTRACT\n");
+                    int typ, vl0, vl1;
+                    typ = v[0];
+                    vl0 = v[1];
+                    vl1 = v[2];
+                    TRACE_FIELD(ctx.debug, "                        Register: %d\n", typ);
+                    TRACE_FIELD(ctx.debug, "                        Value 1: %d\n", vl0);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: %d\n", vl1);
+                    
+                    set_asm("    addi $s%, $0, %\n", {typ, vl0});
+                    set_asm("    addi $s%, $s%, %\n", {typ, typ, -1 * vl1});
+                    continue;
+                }
+                case SEQD_SYSREG_MULT: {
+                    TRACE_FIELD(ctx.debug, "                    Set register MULTIPLY\n");
+                    int typ, vl0, vl1;
+                    typ = v[0];
+                    vl0 = v[1];
+                    vl1 = v[2];
+                    TRACE_FIELD(ctx.debug, "                        Register: %d\n", typ);
+                    TRACE_FIELD(ctx.debug, "                        Value 1: %d\n", vl0);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: %d\n", vl1);
+                    
+                    set_asm("    addi $s%, $0, %\n", {typ, vl0});
+                    set_asm("    li $t4, %\n", {vl1});
+                    set_asm("    mult $s%, $t4\n", {typ});
+                    set_asm("    mfhi $v1\n");
+                    set_asm("    mflo $s%\n", {typ});
+                    continue;
+                }
+                case SEQD_SYSREG_DIVI: {
+                    TRACE_FIELD(ctx.debug, "                    Set register DIVISION\n");
+                    int typ, vl0, vl1;
+                    typ = v[0];
+                    vl0 = v[1];
+                    vl1 = v[2];
+                    TRACE_FIELD(ctx.debug, "                        Register: %d\n", typ);
+                    TRACE_FIELD(ctx.debug, "                        Value 1: %d\n", vl0);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: %d\n", vl1);
+                    
+                    set_asm("    addi $s%, $0, %\n", {typ, vl0});
+                    set_asm("    li $t4, %\n", {vl1});
+                    set_asm("    div $s%, $t4\n", {typ});
+                    set_asm("    mfhi $v1\n");
+                    set_asm("    mflo $s%\n", {typ});
+                    continue;
+                }
+                case SEQD_SYSREG_MODU: {
+                    TRACE_FIELD(ctx.debug, "                    Set register MODULUS\n");
+                    int typ, vl0, vl1;
+                    typ = v[0];
+                    vl0 = v[1];
+                    vl1 = v[2];
+                    TRACE_FIELD(ctx.debug, "                        Register: %d\n", typ);
+                    TRACE_FIELD(ctx.debug, "                        Value 1: %d\n", vl0);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: %d\n", vl1);
+                    
+                    set_asm("    addi $s%, $0, %\n", {typ, vl0});
+                    set_asm("    li $t4, %\n", {vl1});
+                    set_asm("    div $s%, $t4\n", {typ});
+                    set_asm("    mfhi $s%\n", {typ});
+                    set_asm("    mflo $v0\n");
+                    continue;
+                }
+                case SEQD_SYSREG_AND: {
+                    TRACE_FIELD(ctx.debug, "                    Set register AND\n");
+                    int typ, vl0, vl1;
+                    typ = v[0];
+                    vl0 = v[1];
+                    vl1 = v[2];
+                    TRACE_FIELD(ctx.debug, "                        Register: %d\n", typ);
+                    TRACE_FIELD(ctx.debug, "                        Value 1: %d\n", vl0);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: %d\n", vl1);
+                    
+                    set_asm("    addi $s%, $0, %\n", {typ, vl0});
+                    set_asm("    andi $s%, $s%, %\n", {typ, typ, vl1});
+                    continue;
+                }
+                case SEQD_SYSREG_OR: {
+                    TRACE_FIELD(ctx.debug, "                    Set register OR\n");
+                    int typ, vl0, vl1;
+                    typ = v[0];
+                    vl0 = v[1];
+                    vl1 = v[2];
+                    TRACE_FIELD(ctx.debug, "                        Register: %d\n", typ);
+                    TRACE_FIELD(ctx.debug, "                        Value 1: %d\n", vl0);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: %d\n", vl1);
+                    
+                    set_asm("    addi $s%, $0, %\n", {typ, vl0});
+                    set_asm("    ori $s%, $s%, %\n", {typ, typ, vl1});
+                    continue;
+                }
+                case SEQD_SYSREG_XOR: {
+                    TRACE_FIELD(ctx.debug, "                    Set register XOR\n");
+                    int typ, vl0, vl1;
+                    typ = v[0];
+                    vl0 = v[1];
+                    vl1 = v[2];
+                    TRACE_FIELD(ctx.debug, "                        Register: %d\n", typ);
+                    TRACE_FIELD(ctx.debug, "                        Value 1: %d\n", vl0);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: %d\n", vl1);
+                    
+                    set_asm("    addi $s%, $0, %\n", {typ, vl0});
+                    set_asm("    xori $s%, $s%, %\n", {typ, typ, vl1});
+                    continue;
+                }
+                //Misc instructions
+                case SEQD_WAIT: {
+                    TRACE_FIELD(ctx.debug, "                    Set WAIT\n");
+                    int tim;
+                    tim = v[0];
+                    TRACE_FIELD(ctx.debug, "                        Time: %d\n", tim);
+                    
+                    t_sz += tim;
+                    set_asm("abstime_@:\n", {(int)t_sz});
+                    continue;
+                }
+                case SEQD_JUMP: {
+                    TRACE_FIELD(ctx.debug, "                    Set JUMP\n");
+                    int tim;
+                    tim = v[0];
+                    TRACE_FIELD(ctx.debug, "                        Time: %d\n", tim);
+                    
+                    set_asm("    j abstime_@\n", {tim});
+                    continue;
+                }
+                case SEQD_LOOPBEG: {
+                    TRACE_FIELD(ctx.debug, "                    Set LOOP START\n");
+                    int cnt;
+                    cnt = v[0];
+                    TRACE_FIELD(ctx.debug, "                        Count: %d\n", cnt);
+                    //Too lazy, come back later
+                    continue;
+                }
+                case SEQD_LOOPEND: {
+                    TRACE_FIELD(ctx.debug, "                    Set LOOP STOP\n");
+                    //Too lazy, come back later
+                    continue;
+                }
+                case SEQD_JUMPNEQ: {
+                    TRACE_FIELD(ctx.debug, "                    Set JUMP IF NOT EQUAL\n");
+                    int vl0, vl1, tim;
+                    vl0 = v[0];
+                    vl1 = v[1];
+                    tim = v[2];
+                    TRACE_FIELD(ctx.debug, "                        Value 1: %d\n", vl0);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: %d\n", vl1);
+                    TRACE_FIELD(ctx.debug, "                        Time: %d\n", tim);
+                    
+                    set_asm("    li $t3, %\n", {vl0});
+                    set_asm("    li $t4, %\n", {vl1});
+                    set_asm("    bne $t3, $t4, abstime_@\n", {tim});
+                    set_asm("    nop\n");
+                    continue;
+                }
+                case SEQD_JUMP3: {
+                    TRACE_FIELD(ctx.debug, "                    Set JUMP?\n");
+                    int vl0, vl1, tim;
+                    vl0 = v[0];
+                    vl1 = v[1];
+                    tim = v[2];
+                    TRACE_FIELD(ctx.debug, "                        Value 1: %d\n", vl0);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: %d\n", vl1);
+                    TRACE_FIELD(ctx.debug, "                        Time: %d\n", tim);
+                    
+                    //Assumption based off of surrounding instructions
+                    set_asm("    li $t3, %\n", {vl0});
+                    set_asm("    li $t4, %\n", {vl1});
+                    set_asm("    beq $t3, $t4, abstime_@\n", {tim});
+                    set_asm("    nop\n");
+                    continue;
+                }
+                case SEQD_JUMPGEQ: {
+                    TRACE_FIELD(ctx.debug, "                    Set JUMP IF GREATER OR EQUAL\n");
+                    int vl0, vl1, tim;
+                    vl0 = v[0];
+                    vl1 = v[1];
+                    tim = v[2];
+                    TRACE_FIELD(ctx.debug, "                        Value 1: %d\n", vl0);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: %d\n", vl1);
+                    TRACE_FIELD(ctx.debug, "                        Time: %d\n", tim);
+                    
+                    set_asm("    li $t2, %\n", {vl0});
+                    set_asm("    li $t3, %\n", {vl1});
+                    set_asm("    slt $t4, $t2, $t3\n");
+                    set_asm("    beq $t4, $0, abstime_@\n", {tim});
+                    set_asm("    nop\n");
+                    continue;
+                }
+                case SEQD_JUMPLES: {
+                    TRACE_FIELD(ctx.debug, "                    Set JUMP IF LESSER\n");
+                    int vl0, vl1, tim;
+                    vl0 = v[0];
+                    vl1 = v[1];
+                    tim = v[2];
+                    TRACE_FIELD(ctx.debug, "                        Value 1: %d\n", vl0);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: %d\n", vl1);
+                    TRACE_FIELD(ctx.debug, "                        Time: %d\n", tim);
+                    
+                    set_asm("    li $t2, %\n", {vl0});
+                    set_asm("    li $t3, %\n", {vl1});
+                    set_asm("    slt $t4, $t2, $t3\n");
+                    set_asm("    bne $t4, $0, abstime_@\n", {tim});
+                    set_asm("    nop\n");
+                    continue;
+                }
+                case SEQD_CALLMKR: {
+                    TRACE_FIELD(ctx.debug, "                    Set marker\n");
+                    int mkr;
+                    mkr = v[0];
+                    TRACE_FIELD(ctx.debug, "                        Marker: %d\n", mkr);
+                    
+                    tmp.emplace_back(
+                        t_sz,
+                        META_SEQUENCER_EXCLUSIVE,
+                        (unsigned char[]){(unsigned char)SEQD_CALLMKR, (unsigned char)mkr}
+                    );
+                    continue;
+                }
+                case SEQD_LOOPBREAK: {
+                    TRACE_FIELD(ctx.debug, "                    Set LOOP BREAK\n");
+                    int vl0, vl1;
+                    vl0 = v[0];
+                    vl1 = v[1];
+                    TRACE_FIELD(ctx.debug, "                        Value 1: %d\n", vl0);
+                    TRACE_FIELD(ctx.debug, "                        Value 2: %d\n", vl1);
+                    //Too lazy, come back later
+                    continue;
+                }
+                case SEQD_PRINT: {
+                    TRACE_FIELD(ctx.debug, "                    Set PRINT\n");
+                    int val;
+                    val = v[0];
+                    TRACE_FIELD(ctx.debug, "                        Value: %d\n", val);
+                    
+                    set_asm("    li $a0, %\n", {val});
+                    set_asm("    li $v0, 11\n");
+                    set_asm("    syscall\n");
+                    continue;
+                }
+                case SEQD_EOR: {
+                    TRACE_FIELD(ctx.debug, "                    Set end of sequence\n");
+                    tmp.emplace_back(t_sz, META_END_OF_SEQUENCE);
+                    break;
+                }
+                default: {
+                    TRACE_FIELD(ctx.debug, "                    Request 0x%02X\n", (unsigned char)ins.op);
+                    continue;
+                }
+            }
+            break;
+        }
+    }
+    if (seq.fmt == SEQD_RAWMIDI) {
+        unpackMesg(mid, (unsigned char*)seq.data.data(), seq.data.size());
+        tmp = mid.msg[0].getMesgs();
+        
+        //Replace PSX-style controllers with more common ones
+        TRACE_STEP(ctx.debug, "                Replace PSX-style MIDI controls\n");
+        for (auto &md : tmp) {
+            const auto &st = md.getStat();
+            if (st == STAT_CONTROLLER) {
+                //Keep original data, message may be replaced below
+                const auto org = md;
+                const auto dt = org.getData();
+                if (dt[0] == SEQD_CC_PSX_LOOP) {
+                    if (dt[1] == SEQD_CC_PSX_LOOPSTART) {
+                        TRACE_FIELD(ctx.debug, "                Set loop start controller\n");
+                        md = {
+                            md.getTime(), st,
+                            (unsigned char[]){CC_XML_LOOPSTART, CC_XML_LOOPINFINITE}
+                        };
+                    }
+                    if (dt[1] == SEQD_CC_PSX_LOOPEND) {
+                        TRACE_FIELD(ctx.debug, "                Set loop stop controller\n");
+                        md = {
+                            md.getTime(), st,
+                            (unsigned char[]){CC_XML_LOOPEND, CC_XML_LOOPRESERVED}
+                        };
+                    }
+                }
+
+                //Replaces psx event with sequencer specific event
+                if (dt[0] == SEQD_CC_SONGEVENT || dt[0] == SEQD_CC_UNKNOWN1) {
+                    TRACE_FIELD(ctx.debug, "                Set unknown controller 0x%02X\n", dt[0]);
+                    md = {
+                        md.getTime(),
+                        META_SEQUENCER_EXCLUSIVE,
+                        (unsigned char[]){(unsigned char)dt[0], (unsigned char)(md.getChan()), (unsigned char)dt[1]}
+                    };
+                }
+            }
+        }
+    }
+    pass.data = packSeqdMesg(tmp);
+    
+    //Clear asm holding nothing but labels
+    if (!is_ins) pass.asmdata.clear();
+    return 1;
+}
+
+///Splices sub-sequences into a request sequence (second pass)
+///  Sub-sequences are linked before being spliced, so nested ones come out resolved
+///  In-order linking only resolved those stored before their parent, leaving the rest as sub markers
+///  Results then depended on conversion order, which lazy and single sequence conversion have not
+static void convertSeqdSecond(sgxdctx &ctx, seqdseq &seq) {
+    if (seq.empty()) return;
+    if (seq.fmt != SEQD_REQUEST) return;
+    if (seq.data.empty()) return;
+
+    unsigned t_sz;
+    midiinfo mid {};
+    
+    std::vector<mesginfo> tmp;
+    
+    unpackMesg(mid, (unsigned char*)seq.data.data(), seq.data.size());
+    tmp = mid.msg[0].getMesgs();
+    
+    //Replace sub sections
+    for (int t = 0, ofs = 0; t < tmp.size(); ++t) {
+        tmp[t].setTime(tmp[t].getTime() + ofs);
+        
+        const auto tm = tmp[t].getTime();
+        const auto st = tmp[t].getStat();
+        const auto dt = tmp[t].getData();
+        
+        if (st != META_SEQUENCER_EXCLUSIVE) continue;
+        if (dt.size() != 3) continue;
+        if (
+            (char)dt[0] != SEQD_SUB_START &&
+            (char)dt[0] != SEQD_SUB_STOP &&
+            (char)dt[0] != SEQD_SUB_STOPREL
+        ) continue;
+        t_sz = tm;
+        
+        TRACE_FIELD(ctx.debug, "                Assign sub-sequence %d from group %d\n", dt[2], dt[1]);
+        if (dt[1] >= ctx.inf.seqd.seqd.size() || dt[2] >= ctx.inf.seqd.seqd[dt[1]].seq.size()) continue;
+        convertSeqd(ctx, dt[1], dt[2]);
+        const auto &sub = ctx.inf.seqd.seqd[dt[1]].seq[dt[2]]; mid = {};
+        if (sub.data.empty()) continue;
+        unpackMesg(mid, (unsigned char*)sub.data.data(), sub.data.size());
+        auto msg = mid.msg[0].getMesgs();
+        for (auto &s : msg) {
+            if (s.getStat() == META_END_OF_SEQUENCE) s.setStat(STAT_NONE);
+            else if (
+                s.getStat() == META_SEQUENCER_EXCLUSIVE &&
+                s.getData().size() > 1 && (
+                    (char)dt[0] == SEQD_SUB_STOP ||
+                    (char)dt[0] == SEQD_SUB_STOPREL
+                )
+            ) {
+                const auto tdt = s.getData();
+                if ((char)tdt[0] == SEQD_START) {
+                    s = {
+                        s.getTime(),
+                        s.getStat(),
+                        (unsigned char[]){
+                            (unsigned char)(((char)dt[0] == SEQD_SUB_STOP) ? SEQD_STOP : SEQD_STOPREL),
+                            tdt[1], tdt[2], tdt[3],
+                            (unsigned char)(((char)dt[0] == SEQD_SUB_STOP) ? 0 : 127)
+                        }
+                    };
+                }
+                else if ((char)tdt[0] == SEQD_STOP || (char)tdt[0] == SEQD_STOPREL) {
+                    s.setStat(STAT_NONE);
+                }
+            }
+            s.setTime(t_sz + s.getTime());
+        }
+        ofs += msg.back().getTime();
+        std::erase_if(
+            msg,
+            [](const mesginfo &m) { return m.getStat() == STAT_NONE; }
+        );
+        
+        tmp[t] = msg[0];
+        tmp.insert(tmp.begin() + t + 1, msg.begin() + 1, msg.end());
+    }
+    
+    //Assign end of track event and sort
+    t_sz = (*std::max_element(tmp.begin(), tmp.end())).getTime() + 8000;
+    if (tmp.back().getStat() != META_END_OF_SEQUENCE) tmp.emplace_back(t_sz, META_END_OF_SEQUENCE);
+    else tmp.back().setTime(t_sz);
+    std::sort(tmp.begin(), tmp.end());
+    seq.data = packSeqdMesg(tmp);
+}
+
+///Unpacks variable sequence definitions from SEQD data
+void unpackSeqd(sgxdctx &ctx, unsigned char *in, const unsigned length) {
+    TRACE_STEP(ctx.debug, "    Unpack SEQD\n");
+
+    ctx.inf.seqd = {};
+    if (!ctx.beg || !in || length < 8) return;
+
+    const unsigned char *in_end = in + length;
+    unsigned t_sz;
+    auto &out = ctx.inf.seqd;
+    
+    auto get_int = [&in, &in_end](const unsigned length) -> unsigned {
+        unsigned out = 0;
+        for (int i = 0; i < length; ++i) {
+            if (in >= in_end) break;
+            out |= (unsigned)*(in++) << (8 * i);
         }
-        return std::move(out);
+        return out;
+    };
+    auto get_str = [](const unsigned char *in, const unsigned adr) -> std::string {
+        std::string out;
+        if (!adr);
+        else { out = (const char*)(in + adr); if (!out[0]) out.clear(); }
+        return out;
     };
     
     
-    if (sgd_debug) fprintf(stderr, "    Read SEQD Header\n");
+    TRACE_STEP(ctx.debug, "    Read SEQD Header\n");
     out.flag = get_int(4);
     out.seqd.resize(get_int(4));
     signed seq0offs[out.seqd.size()] {};
 
-    if (sgd_debug) fprintf(stderr, "        Global flag: 0x%08X\n", out.flag);
+    TRACE_STEP(ctx.debug, "        Global flag: 0x%08X\n", out.flag);
 
-    if (sgd_debug) fprintf(stderr, "    Read SEQD Setup\n");
+    TRACE_STEP(ctx.debug, "    Read SEQD Setup\n");
     for (auto &f : seq0offs) f = get_int(4);
 
-    if (sgd_debug) fprintf(stderr, "    Read SEQD Group\n");
+    TRACE_STEP(ctx.debug, "    Read SEQD Group\n");
     for (int g = 0; g < out.seqd.size(); ++g) {
         if (!seq0offs[g]) continue;
-        in = (unsigned char*)sgd_beg + seq0offs[g];
+        in = (unsigned char*)ctx.beg + seq0offs[g];
         out.seqd[g].flag = get_int(4);
         out.seqd[g].seq.resize(get_int(4));
         signed seq1offs[out.seqd[g].seq.size()] {};
         for (auto &f : seq1offs) f = get_int(4);
 
-        if (sgd_debug) {
-            fprintf(stderr, "        Current SEQD Group: %d\n", g);
-            fprintf(stderr, "            Group flag: 0x%08X\n", out.seqd[g].flag);
-        }
+        TRACE_STEP(ctx.debug, "        Current SEQD Group: %d\n", g);
+        TRACE_STEP(ctx.debug, "            Group flag: 0x%08X\n", out.seqd[g].flag);
 
         for (int f = 0; f < out.seqd[g].seq.size(); ++f) {
             if (!seq1offs[f]) continue;
-            in = (unsigned char*)sgd_beg + seq1offs[f];
+            in = (unsigned char*)ctx.beg + seq1offs[f];
             out.seqd[g].seq[f].flag = get_int(4);
-            out.seqd[g].seq[f].name = get_str(sgd_beg, get_int(4));
+            out.seqd[g].seq[f].name = get_str(ctx.beg, get_int(4));
             out.seqd[g].seq[f].fmt = get_int(2);
             out.seqd[g].seq[f].div = get_int(2);
             out.seqd[g].seq[f].volleft = get_int(2);
@@ -152,799 +985,100 @@ void unpackSeqd(unsigned char *in, const unsigned length) {
             t_sz = get_int(4);
             if (in + t_sz <= in_end) out.seqd[g].seq[f].data.assign(in, in + t_sz);
 
-            if (sgd_debug) {
-                fprintf(stderr, "            Current SEQD: %d\n", f);
-                fprintf(stderr, "                Local flag: 0x%08X\n", out.seqd[g].seq[f].flag);
-                fprintf(stderr, "                Name: %s\n", out.seqd[g].seq[f].name.c_str());
-                fprintf(stderr, "                Format: %d\n", out.seqd[g].seq[f].fmt);
-                fprintf(stderr, "                Division: 0x%04X\n", out.seqd[g].seq[f].div);
-                fprintf(stderr, "                Left volume: %d\n", out.seqd[g].seq[f].volleft);
-                fprintf(stderr, "                Right volume: %d\n", out.seqd[g].seq[f].volright);
-                fprintf(stderr, "                Sequence size: %d\n", out.seqd[g].seq[f].data.size());
-            }
+            TRACE_FIELD(ctx.debug, "            Current SEQD: %d\n", f);
+            TRACE_FIELD(ctx.debug, "                Local flag: 0x%08X\n", out.seqd[g].seq[f].flag);
+            TRACE_FIELD(ctx.debug, "                Name: %s\n", out.seqd[g].seq[f].name.c_str());
+            TRACE_FIELD(ctx.debug, "                Format: %d\n", out.seqd[g].seq[f].fmt);
+            TRACE_FIELD(ctx.debug, "                Division: 0x%04X\n", out.seqd[g].seq[f].div);
+            TRACE_FIELD(ctx.debug, "                Left volume: %d\n", out.seqd[g].seq[f].volleft);
+            TRACE_FIELD(ctx.debug, "                Right volume: %d\n", out.seqd[g].seq[f].volright);
+            TRACE_FIELD(ctx.debug, "                Sequence size: %d\n", out.seqd[g].seq[f].data.size());
         }
     }
     
-    if (sgd_debug) fprintf(stderr, "    Convert SEQD (First Pass)\n");
-    srand(time(0));
-    for (auto &grp : out.seqd) {
-        if (grp.seq.empty()) continue;
-        
-        if (sgd_debug) fprintf(stderr, "        Current SEQD Group: %d\n", &grp - out.seqd.data());
-        for (auto &seq : grp.seq) {
-            if (seq.empty()) continue;
-            if (seq.fmt != SEQD_REQUEST && seq.fmt != SEQD_RAWMIDI) continue;
-            
-            std::vector<mesginfo> tmp;
-            mid_inf = {};
-            t_sz = 0;
-            
-            if (sgd_debug) fprintf(stderr, "            Current SEQD: %d\n", &seq - grp.seq.data());
-            if (seq.fmt == SEQD_REQUEST) {
-                //https://github.com/Nenkai/010GameTemplates/blob/main/Sony/SGXD.bt
-                
-                std::map<int, seqd_vals> ids;
-                
-                seq.asmdata = "abstime_000000:\n";
-                
-                //Convert PSX-style requests into midi and asm
-                if (sgd_debug) fprintf(stderr, "                Convert PSX-style requests\n");
-                for (auto ptr = seq.data.begin(); ptr < seq.data.end();) {
-                    while (*ptr < 0xA0) ptr += 1;
+    //Sequences are converted on request when lazy
+    if (ctx.lazy) return;
+    TRACE_STEP(ctx.debug, "    Convert SEQD\n");
+    convertSeqd(ctx);
+}
 
-                    switch((char)(*ptr++)) {
-                        //Auditory instructions
-                        case SEQD_SUB_START: {
-                            if (sgd_debug) fprintf(stderr, "                    Set song start\n");
-                            int id, prg, nte, vol;
-                            id = get_val(get_val, ptr);
-                            prg = get_val(get_val, ptr);
-                            nte = get_val(get_val, ptr);
-                            vol = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        ID: %d\n", id);
-                                fprintf(stderr, "                        Group: %d\n", prg);
-                                fprintf(stderr, "                        Sequence: %d\n", nte);
-                                fprintf(stderr, "                        Volume: %d\n", vol);
-                            }
-                            
-                            if (chk_seq(prg, nte)) {
-                                tmp.emplace_back(
-                                    t_sz,
-                                    META_SEQUENCER_EXCLUSIVE,
-                                    (unsigned char[]){SEQD_SUB_START, prg, nte}
-                                );
-                                ids[id] = {prg, nte};
-                            }
-                            continue;
-                        }
-                        case SEQD_SUB_STOP: {
-                            if (sgd_debug) fprintf(stderr, "                    Set song stop\n");
-                            int id;
-                            id = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        ID: %d\n", id);
-                            }
-                            
-                            if (ids.find(id) != ids.end()) {
-                                tmp.emplace_back(
-                                    t_sz,
-                                    META_SEQUENCER_EXCLUSIVE,
-                                    (unsigned char[]){SEQD_SUB_STOP, ids[id][0], ids[id][1]}
-                                );
-                            }
-                            continue;
-                        }
-                        case SEQD_SUB_STOPREL: {
-                            if (sgd_debug) fprintf(stderr, "                    Set song fade\n");
-                            int id;
-                            id = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        ID: %d\n", id);
-                            }
-                            
-                            if (ids.find(id) != ids.end()) {
-                                tmp.emplace_back(
-                                    t_sz,
-                                    META_SEQUENCER_EXCLUSIVE,
-                                    (unsigned char[]){SEQD_SUB_STOPREL, ids[id][0], ids[id][1]}
-                                );
-                            }
-                            continue;
-                        }
-                        case SEQD_SUB_GETSTAT: {
-                            if (sgd_debug) fprintf(stderr, "                    Set song status\n");
-                            int id;
-                            id = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        ID: %d\n", id);
-                            }
-                            
-                            if (ids.find(id) != ids.end()) {
-                                tmp.emplace_back(
-                                    t_sz,
-                                    META_SEQUENCER_EXCLUSIVE,
-                                    (unsigned char[]){SEQD_SUB_GETSTAT, ids[id][0], ids[id][1]}
-                                );
-                            }
-                            continue;
-                        }
-                        case SEQD_CONTROL: {
-                            if (sgd_debug) fprintf(stderr, "                    Set controller\n");
-                            int id, typ, val, tim, unk, glb;
-                            id = get_val(get_val, ptr);
-                            typ = get_val(get_val, ptr);
-                            val = get_val(get_val, ptr);
-                            tim = get_val(get_val, ptr);
-                            unk = get_val(get_val, ptr);
-                            glb = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        ID: %d\n", id);
-                                fprintf(stderr, "                        Type: %d\n", typ);
-                                fprintf(stderr, "                        Value: %d\n", val);
-                                fprintf(stderr, "                        Time: %d\n", tim);
-                                fprintf(stderr, "                        Unknown: %d\n", unk);
-                                fprintf(stderr, "                        Is global: %d\n", glb);
-                            }
-                            //Dunno the controller types, come back later
-                            continue;
-                        }
-                        case SEQD_ADSR: {
-                            if (sgd_debug) fprintf(stderr, "                    Set envelope id\n");
-                            int id, typ, glb;
-                            id = get_val(get_val, ptr);
-                            typ = get_val(get_val, ptr);
-                            glb = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        ID: %d\n", id);
-                                fprintf(stderr, "                        Type: %d\n", typ);
-                                fprintf(stderr, "                        Is global: %d\n", glb);
-                            }
-                            //Dunno the ADSR indices, come back later
-                            continue;
-                        }
-                        case SEQD_BEND: {
-                            if (sgd_debug) fprintf(stderr, "                    Set bend\n");
-                            int unk0, unk1, unk2, glb;
-                            unk0 = get_val(get_val, ptr);
-                            unk1 = get_val(get_val, ptr, 12);
-                            unk2 = get_val(get_val, ptr, 12);
-                            glb = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Unknown 1: %d\n", unk0);
-                                fprintf(stderr, "                        Unknown 2: %d\n", unk1);
-                                fprintf(stderr, "                        Unknown 3: %d\n", unk2);
-                                fprintf(stderr, "                        Is global: %d\n", glb);
-                            }
-                            //Dunno how bend works, come back later
-                            continue;
-                        }
-                        case SEQD_ADSR_DIRECT: {
-                            if (sgd_debug) fprintf(stderr, "                    Set envelope\n");
-                            int p0, unk, p0_0, p0_1, p0_2, p0_3, p1_0, p1_1, p1_2, p1_3, glb;
-                            p0 = get_val(get_val, ptr);
-                            unk = get_val(get_val, ptr);
-                            p0_0 = get_val(get_val, ptr);
-                            p0_1 = std::min(127, get_val(get_val, ptr));
-                            p0_2 = std::min(15, get_val(get_val, ptr));
-                            p0_3 = std::min(15, get_val(get_val, ptr));
-                            p1_0 = get_val(get_val, ptr);
-                            p1_1 = get_val(get_val, ptr);
-                            p1_2 = get_val(get_val, ptr);
-                            p1_3 = get_val(get_val, ptr);
-                            glb = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Type: %d\n", p0);
-                                fprintf(stderr, "                        Value 1: 0x%02X02X02X02X\n", p0_0, p0_1, p0_2, p0_3);
-                                fprintf(stderr, "                        Value 2: 0x%02X02X02X02X\n", p1_0, p1_1, p1_2, p1_3);
-                                fprintf(stderr, "                        Is global: %d\n", glb);
-                            }
-                            //Too lazy, come back later
-                            continue;
-                        }
-                        case SEQD_START: {
-                            if (sgd_debug) fprintf(stderr, "                    Set note start\n");
-                            int id, prg, nte, vol, bnk;
-                            id = get_val(get_val, ptr);
-                            prg = get_val(get_val, ptr);
-                            nte = get_val(get_val, ptr);
-                            vol = get_val(get_val, ptr, 4096);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        ID: %d\n", id);
-                                fprintf(stderr, "                        Region: %d\n", prg);
-                                fprintf(stderr, "                        Note: %d\n", nte);
-                                fprintf(stderr, "                        Volume: %d\n", vol);
-                            }
-                            
-                            set_bnk(prg, nte, bnk);
-                            if (bnk >= 0) {
-                                if (sgd_debug) fprintf(stderr, "                        Bank: %d\n", bnk);
-                                tmp.emplace_back(
-                                    t_sz,
-                                    META_SEQUENCER_EXCLUSIVE,
-                                    (unsigned char[]){SEQD_START, bnk, prg, nte, (vol * 127) / 4096}
-                                );
-                                ids[id] = {bnk, prg, nte};
-                            }
-                            continue;
-                        }
-                        case SEQD_STOP: {
-                            if (sgd_debug) fprintf(stderr, "                    Set note stop\n");
-                            int id, glb;
-                            id = get_val(get_val, ptr);
-                            glb = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        ID: %d\n", id);
-                                fprintf(stderr, "                        Is global: %d\n", glb);
-                            }
-                            
-                            if (!glb && ids.find(id) == ids.end()) continue;
-                            if (glb) tmp.emplace_back(
-                                t_sz, META_SEQUENCER_EXCLUSIVE,
-                                (unsigned char[]){SEQD_STOP}
-                            );
-                            else tmp.emplace_back(
-                                t_sz, META_SEQUENCER_EXCLUSIVE,
-                                (unsigned char[]){SEQD_STOP, ids[id][0], ids[id][1], ids[id][2], 0}
-                            );
-                            continue;
-                        }
-                        case SEQD_STOPREL: {
-                            if (sgd_debug) fprintf(stderr, "                    Set note fade\n");
-                            int id, glb;
-                            id = get_val(get_val, ptr);
-                            glb = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        ID: %d\n", id);
-                                fprintf(stderr, "                        Is global: %d\n", glb);
-                            }
-                            
-                            if (!glb && ids.find(id) == ids.end()) continue;
-                            if (glb) tmp.emplace_back(
-                                t_sz, META_SEQUENCER_EXCLUSIVE,
-                                (unsigned char[]){SEQD_STOPREL}
-                            );
-                            else tmp.emplace_back(
-                                t_sz, META_SEQUENCER_EXCLUSIVE,
-                                (unsigned char[]){SEQD_STOPREL, ids[id][0], ids[id][1], ids[id][2], 127}
-                            );
-                            continue;
-                        }
-                        case SEQD_GETPORTSTAT: {
-                            if (sgd_debug) fprintf(stderr, "                    Set note status\n");
-                            int id, glb;
-                            id = get_val(get_val, ptr);
-                            glb = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        ID: %d\n", id);
-                                fprintf(stderr, "                        Is global: %d\n", glb);
-                            }
-                            
-                            if (!glb && ids.find(id) == ids.end()) continue;
-                            if (glb) tmp.emplace_back(
-                                t_sz, META_SEQUENCER_EXCLUSIVE,
-                                (unsigned char[]){SEQD_GETPORTSTAT}
-                            );
-                            else tmp.emplace_back(
-                                t_sz, META_SEQUENCER_EXCLUSIVE,
-                                (unsigned char[]){SEQD_GETPORTSTAT, ids[id][0], ids[id][1], ids[id][2]}
-                            );
-                            continue;
-                        }
-                        case SEQD_STARTSMPL: {
-                            if (sgd_debug) fprintf(stderr, "                    Set sample start\n");
-                            int id, sid, vol, pri, grp, gmd, gnm;
-                            id = get_val(get_val, ptr);
-                            sid = get_val(get_val, ptr);
-                            vol = get_val(get_val, ptr, 4096);
-                            pri = get_val(get_val, ptr, 128);
-                            grp = get_val(get_val, ptr);
-                            gmd = get_val(get_val, ptr);
-                            gnm = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        ID: %d\n", id);
-                                fprintf(stderr, "                        Sample ID: %d\n", sid);
-                                fprintf(stderr, "                        Volume: %d\n", vol);
-                                fprintf(stderr, "                        Priority: %d\n", pri);
-                                fprintf(stderr, "                        Group ID 1: %d\n", grp);
-                                fprintf(stderr, "                        Group mode: %d\n", gmd);
-                                fprintf(stderr, "                        Group ID 2: %d\n", gnm);
-                            }
-                            //Need example, come back later
-                            continue;
-                        }
-                        case SEQD_STARTNOISE: {
-                            if (sgd_debug) fprintf(stderr, "                    Set noise start\n");
-                            int id, nid, vol, pri, grp, gmd, gnm;
-                            id = get_val(get_val, ptr);
-                            nid = get_val(get_val, ptr);
-                            vol = get_val(get_val, ptr, 4096);
-                            pri = get_val(get_val, ptr, 128);
-                            grp = get_val(get_val, ptr);
-                            gmd = get_val(get_val, ptr);
-                            gnm = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        ID: %d\n", id);
-                                fprintf(stderr, "                        Noise ID: %d\n", nid);
-                                fprintf(stderr, "                        Volume: %d\n", vol);
-                                fprintf(stderr, "                        Priority: %d\n", pri);
-                                fprintf(stderr, "                        Group ID 1: %d\n", grp);
-                                fprintf(stderr, "                        Group mode: %d\n", gmd);
-                                fprintf(stderr, "                        Group ID 2: %d\n", gnm);
-                            }
-                            //Need example, come back later
-                            continue;
-                        }
-                        //MIPS R4000 instructions (guesstimate)
-                        case SEQD_SYSREG_INIT: {
-                            if (sgd_debug) fprintf(stderr, "                    Set register\n");
-                            int typ, vl0, vl1;
-                            typ = get_val(get_val, ptr);
-                            vl0 = get_val(get_val, ptr);
-                            vl1 = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Register: %d\n", typ);
-                                fprintf(stderr, "                        Value 1: %d\n", vl0);
-                                fprintf(stderr, "                        Value 2: %d\n", vl1);
-                            }
-                            
-                            seq.asmdata += get_fstr("    li $s%d, %d\n", typ, vl0);
-                            seq.asmdata += get_fstr("    addi $s%d, $s%d, %d\n", typ, typ, vl1);
-                            continue;
-                        }
-                        case SEQD_SYSREG_ADD: {
-                            if (sgd_debug) fprintf(stderr, "                    Set register ADD\n");
-                            int typ, vl0, vl1;
-                            typ = get_val(get_val, ptr);
-                            vl0 = get_val(get_val, ptr);
-                            vl1 = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Register: %d\n", typ);
-                                fprintf(stderr, "                        Value 1: %d\n", vl0);
-                                fprintf(stderr, "                        Value 2: %d\n", vl1);
-                            }
-                            
-                            seq.asmdata += get_fstr("    addi $s%d, $0, %d\n", typ, vl0);
-                            seq.asmdata += get_fstr("    addi $s%d, $s%d, %d\n", typ, typ, vl1);
-                            continue;
-                        }
-                        case SEQD_SYSREG_MINUS: {
-                            if (sgd_debug) fprintf(stderr, "                    Set register SUBTRACT\n");
-                            int typ, vl0, vl1;
-                            typ = get_val(get_val, ptr);
-                            vl0 = get_val(get_val, ptr);
-                            vl1 = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Register: %d\n", typ);
-                                fprintf(stderr, "                        Value 1: %d\n", vl0);
-                                fprintf(stderr, "                        Value 2: %d\n", vl1);
-                            }
-                            
-                            seq.asmdata += get_fstr("    addi $s%d, $0, %d\n", typ, vl0);
-                            seq.asmdata += get_fstr("    addi $s%d, $s%d, %d\n", typ, typ, -1 * vl1);
-                            continue;
-                        }
-                        case SEQD_SYSREG_MULT: {
-                            if (sgd_debug) fprintf(stderr, "                    Set register MULTIPLY\n");
-                            int typ, vl0, vl1;
-                            typ = get_val(get_val, ptr);
-                            vl0 = get_val(get_val, ptr);
-                            vl1 = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Register: %d\n", typ);
-                                fprintf(stderr, "                        Value 1: %d\n", vl0);
-                                fprintf(stderr, "                        Value 2: %d\n", vl1);
-                            }
-                            
-                            seq.asmdata += get_fstr("    addi $s%d, $0, %d\n", typ, vl0);
-                            seq.asmdata += get_fstr("    li $t4, %d\n", vl1);
-                            seq.asmdata += get_fstr("    mult $s%d, $t4\n", typ);
-                            seq.asmdata += get_fstr("    mfhi $v1\n");
-                            seq.asmdata += get_fstr("    mflo $s%d\n", typ);
-                            continue;
-                        }
-                        case SEQD_SYSREG_DIVI: {
-                            if (sgd_debug) fprintf(stderr, "                    Set register DIVISION\n");
-                            int typ, vl0, vl1;
-                            typ = get_val(get_val, ptr);
-                            vl0 = get_val(get_val, ptr);
-                            vl1 = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Register: %d\n", typ);
-                                fprintf(stderr, "                        Value 1: %d\n", vl0);
-                                fprintf(stderr, "                        Value 2: %d\n", vl1);
-                            }
-                            
-                            seq.asmdata += get_fstr("    addi $s%d, $0, %d\n", typ, vl0);
-                            seq.asmdata += get_fstr("    li $t4, %d\n", vl1);
-                            seq.asmdata += get_fstr("    div $s%d, $t4\n", typ);
-                            seq.asmdata += get_fstr("    mfhi $v1\n");
-                            seq.asmdata += get_fstr("    mflo $s%d\n", typ);
-                            continue;
-                        }
-                        case SEQD_SYSREG_MODU: {
-                            if (sgd_debug) fprintf(stderr, "                    Set register MODULUS\n");
-                            int typ, vl0, vl1;
-                            typ = get_val(get_val, ptr);
-                            vl0 = get_val(get_val, ptr);
-                            vl1 = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Register: %d\n", typ);
-                                fprintf(stderr, "                        Value 1: %d\n", vl0);
-                                fprintf(stderr, "                        Value 2: %d\n", vl1);
-                            }
-                            
-                            seq.asmdata += get_fstr("    addi $s%d, $0, %d\n", typ, vl0);
-                            seq.asmdata += get_fstr("    li $t4, %d\n", vl1);
-                            seq.asmdata += get_fstr("    div $s%d, $t4\n", typ);
-                            seq.asmdata += get_fstr("    mfhi $s%d\n", typ);
-                            seq.asmdata += get_fstr("    mflo $v0\n");
-                            continue;
-                        }
-                        case SEQD_SYSREG_AND: {
-                            if (sgd_debug) fprintf(stderr, "                    Set register AND\n");
-                            int typ, vl0, vl1;
-                            typ = get_val(get_val, ptr);
-                            vl0 = get_val(get_val, ptr);
-                            vl1 = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Register: %d\n", typ);
-                                fprintf(stderr, "                        Value 1: %d\n", vl0);
-                                fprintf(stderr, "                        Value 2: %d\n", vl1);
-                            }
-                            
-                            seq.asmdata += get_fstr("    addi $s%d, $0, %d\n", typ, vl0);
-                            seq.asmdata += get_fstr("    andi $s%d, $s%d, %d\n", typ, typ, vl1);
-                            continue;
-                        }
-                        case SEQD_SYSREG_OR: {
-                            if (sgd_debug) fprintf(stderr, "                    Set register OR\n");
-                            int typ, vl0, vl1;
-                            typ = get_val(get_val, ptr);
-                            vl0 = get_val(get_val, ptr);
-                            vl1 = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Register: %d\n", typ);
-                                fprintf(stderr, "                        Value 1: %d\n", vl0);
-                                fprintf(stderr, "                        Value 2: %d\n", vl1);
-                            }
-                            
-                            seq.asmdata += get_fstr("    addi $s%d, $0, %d\n", typ, vl0);
-                            seq.asmdata += get_fstr("    ori $s%d, $s%d, %d\n", typ, typ, vl1);
-                            continue;
-                        }
-                        case SEQD_SYSREG_XOR: {
-                            if (sgd_debug) fprintf(stderr, "                    Set register XOR\n");
-                            int typ, vl0, vl1;
-                            typ = get_val(get_val, ptr);
-                            vl0 = get_val(get_val, ptr);
-                            vl1 = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Register: %d\n", typ);
-                                fprintf(stderr, "                        Value 1: %d\n", vl0);
-                                fprintf(stderr, "                        Value 2: %d\n", vl1);
-                            }
-                            
-                            seq.asmdata += get_fstr("    addi $s%d, $0, %d\n", typ, vl0);
-                            seq.asmdata += get_fstr("    xori $s%d, $s%d, %d\n", typ, typ, vl1);
-                            continue;
-                        }
-                        //Misc instructions
-                        case SEQD_WAIT: {
-                            if (sgd_debug) fprintf(stderr, "                    Set WAIT\n");
-                            int tim;
-                            tim = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Time: %d\n", tim);
-                            }
-                            
-                            seq.asmdata += get_fstr("abstime_%06d:\n", (t_sz += tim));
-                            continue;
-                        }
-                        case SEQD_JUMP: {
-                            if (sgd_debug) fprintf(stderr, "                    Set JUMP\n");
-                            int tim;
-                            tim = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Time: %d\n", tim);
-                            }
-                            
-                            seq.asmdata += get_fstr("    j abstime_%06d\n", tim);
-                            continue;
-                        }
-                        case SEQD_LOOPBEG: {
-                            if (sgd_debug) fprintf(stderr, "                    Set LOOP START\n");
-                            int cnt;
-                            cnt = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Count: %d\n", cnt);
-                            }
-                            //Too lazy, come back later
-                            continue;
-                        }
-                        case SEQD_LOOPEND: {
-                            if (sgd_debug) fprintf(stderr, "                    Set LOOP STOP\n");
-                            //Too lazy, come back later
-                            continue;
-                        }
-                        case SEQD_JUMPNEQ: {
-                            if (sgd_debug) fprintf(stderr, "                    Set JUMP IF NOT EQUAL\n");
-                            int vl0, vl1, tim;
-                            vl0 = get_val(get_val, ptr);
-                            vl1 = get_val(get_val, ptr);
-                            tim = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Value 1: %d\n", vl0);
-                                fprintf(stderr, "                        Value 2: %d\n", vl1);
-                                fprintf(stderr, "                        Time: %d\n", tim);
-                            }
-                            
-                            seq.asmdata += get_fstr("    li $t3, %d\n", vl0);
-                            seq.asmdata += get_fstr("    li $t4, %d\n", vl1);
-                            seq.asmdata += get_fstr("    bne $t3, $t4, abstime_%06d\n", tim);
-                            seq.asmdata += get_fstr("    nop\n");
-                            continue;
-                        }
-                        case SEQD_JUMP3: {
-                            if (sgd_debug) fprintf(stderr, "                    Set JUMP?\n");
-                            int vl0, vl1, tim;
-                            vl0 = get_val(get_val, ptr);
-                            vl1 = get_val(get_val, ptr);
-                            tim = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Value 1: %d\n", vl0);
-                                fprintf(stderr, "                        Value 2: %d\n", vl1);
-                                fprintf(stderr, "                        Time: %d\n", tim);
-                            }
-                            
-                            //Assumption based off of surrounding instructions
-                            seq.asmdata += get_fstr("    li $t3, %d\n", vl0);
-                            seq.asmdata += get_fstr("    li $t4, %d\n", vl1);
-                            seq.asmdata += get_fstr("    beq $t3, $t4, abstime_%06d\n", tim);
-                            seq.asmdata += get_fstr("    nop\n");
-                            continue;
-                        }
-                        case SEQD_JUMPGEQ: {
-                            if (sgd_debug) fprintf(stderr, "                    Set JUMP IF GREATER OR EQUAL\n");
-                            int vl0, vl1, tim;
-                            vl0 = get_val(get_val, ptr);
-                            vl1 = get_val(get_val, ptr);
-                            tim = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Value 1: %d\n", vl0);
-                                fprintf(stderr, "                        Value 2: %d\n", vl1);
-                                fprintf(stderr, "                        Time: %d\n", tim);
-                            }
-                            
-                            seq.asmdata += get_fstr("    li $t2, %d\n", vl0);
-                            seq.asmdata += get_fstr("    li $t3, %d\n", vl1);
-                            seq.asmdata += get_fstr("    slt $t4, $t2, $t3\n");
-                            seq.asmdata += get_fstr("    beq $t4, $0, abstime_%06d\n", tim);
-                            seq.asmdata += get_fstr("    nop\n");
-                            continue;
-                        }
-                        case SEQD_JUMPLES: {
-                            if (sgd_debug) fprintf(stderr, "                    Set JUMP IF LESSER\n");
-                            int vl0, vl1, tim;
-                            vl0 = get_val(get_val, ptr);
-                            vl1 = get_val(get_val, ptr);
-                            tim = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Value 1: %d\n", vl0);
-                                fprintf(stderr, "                        Value 2: %d\n", vl1);
-                                fprintf(stderr, "                        Time: %d\n", tim);
-                            }
-                            
-                            seq.asmdata += get_fstr("    li $t2, %d\n", vl0);
-                            seq.asmdata += get_fstr("    li $t3, %d\n", vl1);
-                            seq.asmdata += get_fstr("    slt $t4, $t2, $t3\n");
-                            seq.asmdata += get_fstr("    bne $t4, $0, abstime_%06d\n", tim);
-                            seq.asmdata += get_fstr("    nop\n");
-                            continue;
-                        }
-                        case SEQD_CALLMKR: {
-                            if (sgd_debug) fprintf(stderr, "                    Set marker\n");
-                            int mkr;
-                            mkr = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Marker: %d\n", mkr);
-                            }
-                            
-                            tmp.emplace_back(
-                                t_sz,
-                                META_SEQUENCER_EXCLUSIVE,
-                                (unsigned char[]){SEQD_CALLMKR, mkr}
-                            );
-                            continue;
-                        }
-                        case SEQD_LOOPBREAK: {
-                            if (sgd_debug) fprintf(stderr, "                    Set LOOP BREAK\n");
-                            int vl0, vl1;
-                            vl0 = get_val(get_val, ptr);
-                            vl1 = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Value 1: %d\n", vl0);
-                                fprintf(stderr, "                        Value 2: %d\n", vl1);
-                            }
-                            //Too lazy, come back later
-                            continue;
-                        }
-                        case SEQD_PRINT: {
-                            if (sgd_debug) fprintf(stderr, "                    Set PRINT\n");
-                            int val;
-                            val = get_val(get_val, ptr);
-                            if (sgd_debug) {
-                                fprintf(stderr, "                        Value: %d\n", val);
-                            }
-                            
-                            seq.asmdata += get_fstr("    li $a0, %d\n", val);
-                            seq.asmdata += get_fstr("    li $v0, 11\n");
-                            seq.asmdata += get_fstr("    syscall\n");
-                            continue;
-                        }
-                        case SEQD_EOR: {
-                            if (sgd_debug) fprintf(stderr, "                    Set end of sequence\n");
-                            tmp.emplace_back(t_sz, META_END_OF_SEQUENCE);
-                            break;
-                        }
-                        default: {
-                            if (sgd_debug) fprintf(stderr, "                    Request 0x%02X\n", *(ptr - 1));
-                            continue;
-                        }
-                    }
-                    break;
-                }
-            }
-            if (seq.fmt == SEQD_RAWMIDI) {
-                unpackMesg((unsigned char*)seq.data.data(), seq.data.size());
-                tmp.swap(mid_inf.msg[0]);
-                
-                //Replace PSX-style controllers with more common ones
-                if (sgd_debug) fprintf(stderr, "                Replace PSX-style MIDI controls\n");
-                for (auto &md : tmp) {
-                    const auto &st = md.getStat();
-                    if (st == STAT_CONTROLLER) {
-                        const auto &dt = md.getData();
-                        if (dt[0] == SEQD_CC_PSX_LOOP) {
-                            if (dt[1] == SEQD_CC_PSX_LOOPSTART) {
-                                if (sgd_debug) fprintf(stderr, "                Set loop start controller\n");
-                                md = {
-                                    md.getTime(), st,
-                                    (unsigned char[]){CC_XML_LOOPSTART, CC_XML_LOOPINFINITE}
-                                };
-                            }
-                            if (dt[1] == SEQD_CC_PSX_LOOPEND) {
-                                if (sgd_debug) fprintf(stderr, "                Set loop stop controller\n");
-                                md = {
-                                    md.getTime(), st,
-                                    (unsigned char[]){CC_XML_LOOPEND, CC_XML_LOOPRESERVED}
-                                };
-                            }
-                        }
+///Unpacks SEQD data into global SGXD info
+void unpackSeqd(unsigned char *in, const unsigned length) { unpackSeqd(sgd_ctx, in, length); }
 
-                        //Replaces psx event with sequencer specific event
-                        if (dt[0] == SEQD_CC_SONGEVENT || dt[0] == SEQD_CC_UNKNOWN1) {
-                            if (sgd_debug) fprintf(stderr, "                Set unknown controller 0x%02X\n", dt[0]);
-                            md = {
-                                md.getTime(),
-                                META_SEQUENCER_EXCLUSIVE,
-                                (unsigned char[]){dt[0], md.getChan(), dt[1]}
-                            };
-                        }
-                    }
-                }
-            }
-            seq.data = get_mid(tmp);
-            
-            //Clear empty asm if applicable
-            if (!seq.asmdata.empty()) {
-                std::string tmp0 = seq.asmdata, tmp1;
-                bool is_diff = false;
-                auto pos = std::string::npos;
-                while ((pos = tmp0.find("\n")) != std::string::npos) {
-                    tmp1 = tmp0.substr(0, pos); tmp0.erase(0, pos + 1);
-                    if (tmp1.find("abstime_") == std::string::npos) { is_diff = true; break; }
-                }
-                if (!is_diff) seq.asmdata.clear();
-            }
-        }
+///Converts specified sequence, if not yet converted
+void convertSeqd(sgxdctx &ctx, const int &grp, const int &seq) {
+    if (
+        grp < 0 || grp >= ctx.inf.seqd.seqd.size() ||
+        seq < 0 || seq >= ctx.inf.seqd.seqd[grp].seq.size()
+    ) return;
+
+    auto &sq = ctx.inf.seqd.seqd[grp].seq[seq];
+    if (sq.stage == SEQD_STAGE_RAW) {
+        TRACE_STEP(ctx.debug, "        Convert SEQD %d from group %d (First Pass)\n", seq, grp);
+        seqdrng rng {ctx.seed, ctx.inf.file, grp, seq};
+        seqdpass pass;
+        if (convertSeqdFirst(ctx, sq, rng, pass)) setSeqdPass(sq, pass);
+        sq.stage = SEQD_STAGE_EVENTS;
     }
-    
-    if (sgd_debug) fprintf(stderr, "    Convert SEQD (Second Pass)\n");
-    for (auto &grp : out.seqd) {
-        if (grp.seq.empty()) continue;
-        
-        if (sgd_debug) fprintf(stderr, "        Current SEQD Group: %d\n", &grp - out.seqd.data());
-        for (auto &seq : grp.seq) {
-            if (seq.empty()) continue;
-            if (seq.fmt != SEQD_REQUEST) continue;
-            if (seq.data.empty()) continue;
-            
-            std::vector<mesginfo> tmp;
-            mid_inf = {};
-            
-            if (sgd_debug) fprintf(stderr, "            Current SEQD: %d\n", &seq - grp.seq.data());
-            unpackMesg((unsigned char*)seq.data.data(), seq.data.size());
-            tmp.swap(mid_inf.msg[0]);
-            
-            //Replace sub sections
-            for (int t = 0, ofs = 0; t < tmp.size(); ++t) {
-                tmp[t].setTime(tmp[t].getTime() + ofs);
-                
-                const auto tm = tmp[t].getTime();
-                const auto st = tmp[t].getStat();
-                const auto dt = tmp[t].getData();
-                
-                if (st != META_SEQUENCER_EXCLUSIVE) continue;
-                if (dt.size() != 3) continue;
-                if (
-                    (char)dt[0] != SEQD_SUB_START &&
-                    (char)dt[0] != SEQD_SUB_STOP &&
-                    (char)dt[0] != SEQD_SUB_STOPREL
-                ) continue;
-                t_sz = tm;
-                
-                if (sgd_debug) fprintf(stderr, "                Assign sub-sequence %d from group %d\n", dt[2], dt[1]);
-                const auto &sub = sgd_inf.seqd.seqd[dt[1]].seq[dt[2]]; mid_inf = {};
-                unpackMesg((unsigned char*)sub.data.data(), sub.data.size());
-                for (auto &s : mid_inf.msg[0]) {
-                    if (s.getStat() == META_END_OF_SEQUENCE) s.setStat(STAT_NONE);
-                    else if (
-                        s.getStat() == META_SEQUENCER_EXCLUSIVE &&
-                        s.getData().size() > 1 && (
-                            (char)dt[0] == SEQD_SUB_STOP ||
-                            (char)dt[0] == SEQD_SUB_STOPREL
-                        )
-                    ) {
-                        const auto tdt = s.getData();
-                        if ((char)tdt[0] == SEQD_START) {
-                            s = {
-                                s.getTime(),
-                                s.getStat(),
-                                (unsigned char[]){
-                                    ((char)dt[0] == SEQD_SUB_STOP) ? SEQD_STOP : SEQD_STOPREL,
-                                    tdt[1], tdt[2], tdt[3],
-                                    ((char)dt[0] == SEQD_SUB_STOP) ? 0 : 127
-                                }
-                            };
-                        }
-                        else if ((char)tdt[0] == SEQD_STOP || (char)tdt[0] == SEQD_STOPREL) {
-                            s.setStat(STAT_NONE);
-                        }
-                    }
-                    s.setTime(t_sz + s.getTime());
-                }
-                ofs += mid_inf.msg[0].back().getTime();
-                std::erase_if(
-                    mid_inf.msg[0],
-                    [](const mesginfo &m) { return m.getStat() == STAT_NONE; }
-                );
-                
-                tmp[t] = mid_inf.msg[0][0];
-                tmp.insert(tmp.begin() + t + 1, mid_inf.msg[0].begin() + 1, mid_inf.msg[0].end());
-            }
-            
-            //Assign end of track event and sort
-            t_sz = (*std::max_element(tmp.begin(), tmp.end())).getTime() + 8000;
-            if (tmp.back().getStat() != META_END_OF_SEQUENCE) tmp.emplace_back(t_sz, META_END_OF_SEQUENCE);
-            else tmp.back().setTime(t_sz);
-            std::sort(tmp.begin(), tmp.end());
-            seq.data = get_mid(tmp);
+    //Sub-sequences get linked first, one already being linked (cyclic) is used as is
+    if (sq.stage == SEQD_STAGE_EVENTS) {
+        TRACE_STEP(ctx.debug, "        Convert SEQD %d from group %d (Second Pass)\n", seq, grp);
+        sq.stage = SEQD_STAGE_LINKING;
+        convertSeqdSecond(ctx, sq);
+        sq.stage = SEQD_STAGE_DONE;
+    }
+}
+
+///Converts specified sequence from global SGXD info, if not yet converted
+void convertSeqd(const int &grp, const int &seq) { convertSeqd(sgd_ctx, grp, seq); }
+
+///Converts every sequence not yet converted
+///  Sequences are independent until linked, so first passes run in parallel into buffers of their own
+///  Linking splices sub-sequences in and runs in order afterwards
+void convertSeqd(sgxdctx &ctx) {
+    auto &sqd = ctx.inf.seqd.seqd;
+    std::vector<std::array<int, 2>> ids;
+
+    for (int g = 0; g < sqd.size(); ++g) {
+        for (int s = 0; s < sqd[g].seq.size(); ++s) {
+            if (sqd[g].seq[s].stage == SEQD_STAGE_RAW) ids.push_back({g, s});
         }
     }
+
+    std::vector<seqdpass> pass(ids.size());
+    std::vector<char> is_cnv(ids.size());
+    parallelFor(ctx.jobs, ids.size(), [&ctx, &sqd, &ids, &pass, &is_cnv](const unsigned i) -> void {
+        const int &grp = ids[i][0], &seq = ids[i][1];
+        TRACE_STEP(ctx.debug, "        Convert SEQD %d from group %d (First Pass)\n", seq, grp);
+        seqdrng rng {ctx.seed, ctx.inf.file, grp, seq};
+        is_cnv[i] = convertSeqdFirst(ctx, sqd[grp].seq[seq], rng, pass[i]);
+    });
+    for (unsigned i = 0; i < ids.size(); ++i) {
+        auto &sq = sqd[ids[i][0]].seq[ids[i][1]];
+        if (is_cnv[i]) setSeqdPass(sq, pass[i]);
+        sq.stage = SEQD_STAGE_EVENTS;
+    }
+
+    for (int g = 0; g < sqd.size(); ++g) {
+        for (int s = 0; s < sqd[g].seq.size(); ++s) convertSeqd(ctx, g, s);
+    }
 }
 
+///Converts every sequence of global SGXD info not yet converted
+void convertSeqd() { convertSeqd(sgd_ctx); }
+
 ///Packs specified sequence into MIDI data
-std::vector<unsigned char> seqdToMidi(const int &grp, const int &seq) {
-    if (sgd_debug) fprintf(stderr, "    Extract sequence\n");
+std::vector<unsigned char> seqdToMidi(sgxdctx &ctx, const int &grp, const int &seq) {
+    TRACE_STEP(ctx.debug, "    Extract sequence\n");
 
     if (
-        sgd_inf.seqd.empty() ||
-        grp < 0 || grp >= sgd_inf.seqd.seqd.size() ||
-        seq < 0 || seq >= sgd_inf.seqd.seqd[grp].seq.size()
+        ctx.inf.seqd.empty() ||
+        grp < 0 || grp >= ctx.inf.seqd.seqd.size() ||
+        seq < 0 || seq >= ctx.inf.seqd.seqd[grp].seq.size()
     ) return {};
 
-    const auto &sq = sgd_inf.seqd.seqd[grp].seq[seq];
+    convertSeqd(ctx, grp, seq);
+    const auto &sq = ctx.inf.seqd.seqd[grp].seq[seq];
     midiinfo out;
     
     auto get_fstr = []<typename... T>(const char *in, T&&... args) -> std::string {
@@ -954,17 +1088,17 @@ std::vector<unsigned char> seqdToMidi(const int &grp, const int &seq) {
     };
 
     if (sq.fmt != SEQD_REQUEST && sq.fmt != SEQD_RAWMIDI) {
-        if (sgd_debug) fprintf(stderr, "        Unknown sequence type %d\n", sq.fmt);
+        TRACE_STEP(ctx.debug, "        Unknown sequence type %d\n", sq.fmt);
         return sq.data;
     }
     if (sq.data.size() < 6) return {};
 
-    if (sgd_debug) fprintf(stderr, "        Set MIDI header\n");
-    out = {MIDI_SINGLE_TRACK, 1, sq.div};
+    TRACE_STEP(ctx.debug, "        Set MIDI header\n");
+    out = {MIDI_SINGLE_TRACK, 1, (unsigned short)sq.div};
 
-    if (sgd_debug) fprintf(stderr, "        Set MIDI sequences\n");
-    mid_inf = {};
-    unpackMesg((unsigned char*)sq.data.data(), sq.data.size());
+    TRACE_STEP(ctx.debug, "        Set MIDI sequences\n");
+    midiinfo mid {};
+    unpackMesg(mid, (unsigned char*)sq.data.data(), sq.data.size());
     
     if (sq.fmt == SEQD_REQUEST) {
         struct seqd_vals {
@@ -978,7 +1112,7 @@ std::vector<unsigned char> seqdToMidi(const int &grp, const int &seq) {
         //out.msg[0].emplace_back(0, META_TIME_SIGNATURE, (unsigned char[]){1, 5, 24, 8});
         //out.msg[0].emplace_back(0, META_TEMPO, (unsigned char[]){0x03, 0x97, 0x1E});
         //out.msg[0].emplace_back(0, META_SMPTE, (unsigned char[]){0x60, 0x00, 0x00, 0x00, 0x00, 0x00});
-        for (const auto &m : mid_inf.msg[0]) {
+        for (const auto &m : mid.msg[0]) {
             const auto tm = m.getTime();
             const auto st = m.getStat();
             const auto dt = m.getData();
@@ -989,12 +1123,12 @@ std::vector<unsigned char> seqdToMidi(const int &grp, const int &seq) {
                     (char)dt[0] != SEQD_STOP &&
                     (char)dt[0] != SEQD_STOPREL
                 )
-            ) { out.msg[0].emplace_back(m); continue; }
+            ) { out.msg[0].push_back(m.getMesg()); continue; }
             
             if (dt.size() == 1) {
                 int cc;
                 cc = ((char)dt[0] == SEQD_STOPREL) ? CC_RESET_NOTES : CC_RESET_SOUND;
-                out.msg[0].emplace_back(tm, STAT_CONTROLLER, (unsigned char[]){cc, 0});
+                out.msg[0].emplace_back(tm, STAT_CONTROLLER, (unsigned char[]){(unsigned char)cc, 0});
             }
             else {
                 short stt, bnk, prs, nte, vel;
@@ -1009,30 +1143,32 @@ std::vector<unsigned char> seqdToMidi(const int &grp, const int &seq) {
                 }
                 if (seq_chns.find(prs) == seq_chns.end() || seq_chns[prs][0] != bnk) {
                     seq_chns[prs] = {bnk, -1};
-                    out.msg[0].emplace_back(tm, STAT_CONTROLLER | prs, (unsigned char[]){CC_BANK_SELECT_C, bnk});
+                    out.msg[0].emplace_back(tm, STAT_CONTROLLER | prs, (unsigned char[]){(unsigned char)CC_BANK_SELECT_C, (unsigned char)bnk});
                 }
                 if (seq_chns[prs][1] != prs) {
                     seq_chns[prs][1] = prs;
-                    out.msg[0].emplace_back(tm, STAT_PROGRAMME_CHANGE | prs, (unsigned char[]){prs});
+                    out.msg[0].emplace_back(tm, STAT_PROGRAMME_CHANGE | prs, (unsigned char[]){(unsigned char)prs});
                 }
-                out.msg[0].emplace_back(tm, stt | prs, (unsigned char[]){nte, vel});
+                out.msg[0].emplace_back(tm, stt | prs, (unsigned char[]){(unsigned char)nte, (unsigned char)vel});
             }
         }
     }
-    if (sq.fmt == SEQD_RAWMIDI) out.msg.swap(mid_inf.msg);
+    if (sq.fmt == SEQD_RAWMIDI) out.msg.swap(mid.msg);
     
     if (!sq.name.empty()) {
-        if (sgd_debug) fprintf(stderr, "        Set MIDI title\n");
-        out.msg[0].insert(out.msg[0].begin(), {0, META_TRACK_NAME, sq.name.c_str()});
+        TRACE_STEP(ctx.debug, "        Set MIDI title\n");
+        out.msg[0].insert(0, {0, META_TRACK_NAME, sq.name.c_str()});
     }
-    mid_inf = std::move(out);
 
-    return std::move(packMidi());
+    return packMidi(out);
 }
 
+///Packs specified sequence from global SGXD info into MIDI data
+std::vector<unsigned char> seqdToMidi(const int &grp, const int &seq) { return seqdToMidi(sgd_ctx, grp, seq); }
+
 ///Extracts variable sequence definitions into string
-std::string extractSeqd() {
-    if (sgd_debug) fprintf(stderr, "    Extract SEQD info\n");
+std::string extractSeqd(sgxdctx &ctx) {
+    TRACE_STEP(ctx.debug, "    Extract SEQD info\n");
 
     std::string out;
     auto set_fstr = [&out]<typename... T>(const char *in, T&&... args) -> void {
@@ -1040,11 +1176,11 @@ std::string extractSeqd() {
         out.resize(s1 + s0 - 1); snprintf(out.data() + s1, s0, in, args...);
     };
 
-    set_fstr("Global Flags: %s\n", std::bitset<32>(sgd_inf.seqd.flag).to_string().c_str());
+    set_fstr("Global Flags: %s\n", std::bitset<32>(ctx.inf.seqd.flag).to_string().c_str());
     set_fstr("Sequences:\n");
-    for (const auto &g : sgd_inf.seqd.seqd) {
+    for (const auto &g : ctx.inf.seqd.seqd) {
         if (g.empty()) continue;
-        set_fstr("    Sequence Group: %d\n", &g - sgd_inf.seqd.seqd.data());
+        set_fstr("    Sequence Group: %d\n", &g - ctx.inf.seqd.seqd.data());
         set_fstr("        Group Flags: %s\n", std::bitset<32>(g.flag).to_string().c_str());
         for (const auto &s : g.seq) {
             if (s.empty()) continue;
@@ -1069,3 +1205,6 @@ std::string extractSeqd() {
 
     return out;
 }
+
+///Extracts variable sequence definitions from global SGXD info into string
+std::string extractSeqd() { return extractSeqd(sgd_ctx); }
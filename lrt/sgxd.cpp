@@ -7,47 +7,64 @@
 #include "sgxd_types.hpp"
 #include "sgxd_func.hpp"
 #include "directory.hpp"
+#include "filequeue.hpp"
+#include "parallel.hpp"
+#include "trace.hpp"
 
 
 ///Unpacks SGXD info from SGXD file(s)
-void unpackSgxd(const char *file0, const char *file1) {
+void unpackSgxd(sgxdctx &ctx, const char *file0, const char *file1) {
+    closeSgxd(ctx);
     if (!file0 || !file0[0]) return;
 
-    std::vector<unsigned char> tmp;
+    const unsigned char *data0 = 0, *data1 = 0;
+    unsigned size0 = 0, size1 = 0;
 
-    if (true) {
-        unsigned char *data = 0;
-        unsigned size = 0;
+    if (!mapFileData(file0, data0, size0)) {
+        fprintf(stderr, "Unable to open %s\n", file0);
+        ctx.inf = {}; return;
+    }
 
-        if (!getFileData(file0, data, size)) {
-            fprintf(stderr, "Unable to open %s\n", file0);
-            sgd_inf = {}; return;
-        }
-        tmp.insert(tmp.end(), data, data + size);
+    if (file1 && file1[0] && !mapFileData(file1, data1, size1)) {
+        fprintf(stderr, "Unable to open %s\n", file1);
+        unmapFileData(data0, size0);
+        ctx.inf = {}; return;
     }
 
-    if (file1 && file0[0]) {
-        unsigned char *data = 0;
-        unsigned size = 0;
+    unpackSgxd(ctx, (unsigned char*)data0, size0, (unsigned char*)data1, size1);
 
-        if (!getFileData(file1, data, size)) {
-            fprintf(stderr, "Unable to open %s\n", file1);
-            sgd_inf = {}; return;
-        }
-        tmp.insert(tmp.end(), data, data + size);
+    //Lazy decoding reads from the files until closed
+    if (ctx.lazy && ctx.beg) {
+        ctx.map0 = data0; ctx.map0_size = size0;
+        ctx.map1 = data1; ctx.map1_size = size1;
+        return;
     }
 
-    unpackSgxd(tmp.data(), tmp.size());
+    unmapFileData(data0, size0);
+    unmapFileData(data1, size1);
 }
 
+///Unpacks SGXD file(s) into global SGXD info
+void unpackSgxd(const char *file0, const char *file1) { unpackSgxd(sgd_ctx, file0, file1); }
+
 ///Unpacks SGXD info from SGXD data
-void unpackSgxd(unsigned char *in, const unsigned length) {
-    sgd_inf = {};
+void unpackSgxd(sgxdctx &ctx, unsigned char *in, const unsigned length) {
+    unpackSgxd(ctx, in, length, 0, 0);
+}
+
+///Unpacks SGXD data into global SGXD info
+void unpackSgxd(unsigned char *in, const unsigned length) { unpackSgxd(sgd_ctx, in, length); }
+
+///Unpacks SGXD info from SGXD header data and separate body data
+void unpackSgxd(sgxdctx &ctx, unsigned char *in, const unsigned length, unsigned char *dat, const unsigned dat_length) {
+    ctx.inf = {};
+    ctx.chnk.clear();
+    ctx.body.clear(); ctx.body_offs = 0; ctx.body_size = 0;
     if (!in || length < 16) return;
 
-    sgd_beg = in;
-    const unsigned char *in_end = sgd_beg + length;
-    unsigned n_add, s_add, s_siz; bool s_flg;
+    ctx.beg = in;
+    const unsigned char *in_end = ctx.beg + length;
+    unsigned n_add, s_add, s_ofs, s_siz, s_len; bool s_flg;
 
     auto get_fcc = [&in, &in_end]() -> unsigned {
         unsigned out = 0;
@@ -75,7 +92,7 @@ void unpackSgxd(unsigned char *in, const unsigned length) {
     //Check if SGXD
     if (get_fcc() != FOURCC_SGXD) {
         fprintf(stderr, "This is not an SGXD file\n");
-        sgd_beg = 0; return;
+        ctx.beg = 0; return;
     }
 
     //Set name address, stream address, stream size
@@ -85,26 +102,28 @@ void unpackSgxd(unsigned char *in, const unsigned length) {
     s_flg = s_siz & 0x80000000;
     s_siz = s_siz & 0x7FFFFFFF;
 
-    if (s_add > length) s_add = length;
-    if (s_add + s_siz > length) s_siz = length - s_add;
+    //Stream address is relative to body data if separate
+    if (!dat) { dat = (unsigned char*)ctx.beg; s_len = length; s_ofs = s_add; }
+    else { s_len = dat_length; s_ofs = (s_add > length) ? s_add - length : 0; }
+
+    if (s_ofs > s_len) s_ofs = s_len;
+    if (s_ofs + s_siz > s_len) s_siz = s_len - s_ofs;
 
     //Set file name
-    if (sgd_beg + n_add >= sgd_beg + s_add) {
+    if (n_add >= s_add || n_add >= length) {
         fprintf(stderr, "File name located outside header chunk\n");
-        sgd_beg = 0; return;
+        ctx.beg = 0; return;
     }
-    else sgd_inf.file = get_str(sgd_beg, n_add);
+    else ctx.inf.file = get_str(ctx.beg, n_add);
 
     //Set stream chunk
-    sgd_dat_beg = sgd_beg + s_add;
-    sgd_dat_end = sgd_dat_beg + s_siz;
-
-    if (sgd_debug) {
-        fprintf(stderr, "    Stream Name: %s\n", sgd_inf.file.c_str());
-        fprintf(stderr, "    Stream Address: 0x%08X\n", s_add);
-        fprintf(stderr, "    Stream Size: %d\n", s_siz);
-        fprintf(stderr, "    Stream Flag: %s\n", s_flg ? "TRUE" : "FALSE");
-    }
+    ctx.dat_beg = dat + s_ofs;
+    ctx.dat_end = ctx.dat_beg + s_siz;
+
+    TRACE_STEP(ctx.debug, "    Stream Name: %s\n", ctx.inf.file.c_str());
+    TRACE_STEP(ctx.debug, "    Stream Address: 0x%08X\n", s_add);
+    TRACE_STEP(ctx.debug, "    Stream Size: %d\n", s_siz);
+    TRACE_STEP(ctx.debug, "    Stream Flag: %s\n", s_flg ? "TRUE" : "FALSE");
 
     //Get misc chunks
     while (in < in_end) {
@@ -113,58 +132,59 @@ void unpackSgxd(unsigned char *in, const unsigned length) {
         t_fc = get_fcc();
         t_sz = get_int();
         if (in + t_sz > in_end) break;
+        ctx.chnk.push_back({t_fc, (unsigned)(in - ctx.beg), t_sz});
 
         switch(t_fc) {
 #ifdef UNPACKBUSS_IMPLEMENTATION
             case SGXD_BUSS:
-                unpackBuss(in, t_sz);
+                unpackBuss(ctx, in, t_sz);
                 break;
 #endif
 #ifdef UNPACKRGND_IMPLEMENTATION
             case SGXD_RGND:
-                unpackRgnd(in, t_sz);
+                unpackRgnd(ctx, in, t_sz);
                 break;
 #endif
 #ifdef UNPACKSEQD_IMPLEMENTATION
             case SGXD_SEQD:
-                unpackSeqd(in, t_sz);
+                unpackSeqd(ctx, in, t_sz);
                 break;
 #endif
 #ifdef UNPACKWAVE_IMPLEMENTATION
             case SGXD_WAVE:
-                unpackWave(in, t_sz);
+                unpackWave(ctx, in, t_sz);
                 break;
 #endif
 #ifdef UNPACKWSUR_IMPLEMENTATION
             case SGXD_WSUR:
-                unpackWsur(in, t_sz);
+                unpackWsur(ctx, in, t_sz);
                 break;
 #endif
 #ifdef UNPACKWMKR_IMPLEMENTATION
             case SGXD_WMKR:
             case SGXD_WMRK:
-                unpackWmkr(in, t_sz);
+                unpackWmkr(ctx, in, t_sz);
                 break;
 #endif
 #ifdef UNPACKCONF_IMPLEMENTATION
             case SGXD_CONF:
-                unpackConf(in, t_sz);
+                unpackConf(ctx, in, t_sz);
                 break;
 #endif
 #ifdef UNPACKTUNE_IMPLEMENTATION
             case SGXD_TUNE:
-                unpackTune(in, t_sz);
+                unpackTune(ctx, in, t_sz);
                 break;
 #endif
 #ifdef UNPACKADSR_IMPLEMENTATION
             case SGXD_ADSR:
             case SGXD_ASDR:
-                unpackAdsr(in, t_sz);
+                unpackAdsr(ctx, in, t_sz);
                 break;
 #endif
 #ifdef UNPACKNAME_IMPLEMENTATION
             case SGXD_NAME:
-                unpackName(in, t_sz);
+                unpackName(ctx, in, t_sz);
                 break;
 #endif
             default:
@@ -174,42 +194,104 @@ void unpackSgxd(unsigned char *in, const unsigned length) {
         in += t_sz;
     }
 
-    sgd_beg = 0; sgd_dat_beg = 0; sgd_dat_end = 0;
+    //Lazy decoding needs data until closed
+    if (!ctx.lazy) { ctx.beg = 0; ctx.dat_beg = 0; ctx.dat_end = 0; }
+}
+
+///Unpacks SGXD header data and separate body data into global SGXD info
+void unpackSgxd(unsigned char *in, const unsigned length, unsigned char *dat, const unsigned dat_length) {
+    unpackSgxd(sgd_ctx, in, length, dat, dat_length);
+}
+
+///Unpacks SGXD info from SGXD header only, body is read on request
+void unpackSgxdHead(sgxdctx &ctx, const char *file0, const char *file1) {
+    closeSgxd(ctx);
+    if (!file0 || !file0[0]) return;
+
+    const unsigned char *data0 = 0;
+    unsigned size0 = 0, s_add = 0, s_siz = 0, length;
+    const bool is_sgd = !file1 || !file1[0];
+    const bool lazy = ctx.lazy;
+
+    auto get_int = [](const unsigned char *in) -> unsigned {
+        return (unsigned)in[0] | (unsigned)in[1] << 8 | (unsigned)in[2] << 16 | (unsigned)in[3] << 24;
+    };
+
+    if (!mapFileData(file0, data0, size0)) {
+        fprintf(stderr, "Unable to open %s\n", file0);
+        ctx.inf = {}; return;
+    }
+    if (size0 >= 16) {
+        s_add = get_int(data0 + 8);
+        s_siz = get_int(data0 + 12) & 0x7FFFFFFF;
+    }
+
+    //Stop at stream when it shares the file, nothing past it is touched
+    length = (is_sgd && s_add < size0) ? s_add : size0;
+    ctx.lazy = true;
+    unpackSgxd(ctx, (unsigned char*)data0, length);
+    ctx.lazy = lazy;
+    ctx.beg = 0; ctx.dat_beg = 0; ctx.dat_end = 0;
+    unmapFileData(data0, size0);
+
+    if (ctx.inf.empty()) return;
+    ctx.body = (is_sgd) ? file0 : file1;
+    ctx.body_offs = (is_sgd) ? s_add : (s_add > size0) ? s_add - size0 : 0;
+    ctx.body_size = s_siz;
+}
+
+///Unpacks SGXD header file into global SGXD info
+void unpackSgxdHead(const char *file0, const char *file1) { unpackSgxdHead(sgd_ctx, file0, file1); }
+
+///Releases SGXD data kept for lazy decoding
+void closeSgxd(sgxdctx &ctx) {
+    unmapFileData(ctx.map0, ctx.map0_size);
+    unmapFileData(ctx.map1, ctx.map1_size);
+    ctx.map0 = 0; ctx.map0_size = 0;
+    ctx.map1 = 0; ctx.map1_size = 0;
+    ctx.beg = 0; ctx.dat_beg = 0; ctx.dat_end = 0;
 }
 
+///Releases SGXD data kept for lazy decoding of global SGXD info
+void closeSgxd() { closeSgxd(sgd_ctx); }
+
+///Releases SGXD data kept for lazy decoding once context is gone
+sgxdctx::~sgxdctx() { closeSgxd(*this); }
+
 
 ///Extracts misc data from SGXD info
-void extractSgxd(const char *folder) {
-    if (sgd_inf.empty() || !folder || !folder[0]) return;
+int extractSgxd(sgxdctx &ctx, const char *folder) {
+    int ret = 1;
+    if (ctx.inf.empty() || !folder || !folder[0]) return 0;
 
     std::string out = "", tmp;
     out += folder;
-    out += "@" + sgd_inf.file;
+    out += "@" + ctx.inf.file;
 
     fprintf(stdout, "Extract SGXD contents to %s/\n", out.c_str());
-    if (!createFolder((out + "/").c_str())) {
+    if (!createFolder(ctx.queue, (out + "/").c_str())) {
         fprintf(stderr, "Unable to create %s/\n", out.c_str());
-        return;
+        return 0;
     }
 
 #ifdef UNPACKBUSS_IMPLEMENTATION
-    while (!sgd_inf.buss.empty()) {
+    while (!ctx.inf.buss.empty()) {
         tmp = "/buss";
         fprintf(stdout, "    Extract BUSS contents to %s/\n", tmp.c_str());
-        if (!createFolder((out + tmp + "/").c_str())) {
+        if (!createFolder(ctx.queue, (out + tmp + "/").c_str())) {
             fprintf(stderr, "    Unable to create %s/\n", tmp.c_str());
-            break;
+            ret = 0; break;
         }
 
-        for (int b = 0; b < sgd_inf.buss.buss.size(); ++b) {
-            const auto &bus = sgd_inf.buss.buss[b];
+        for (int b = 0; b < ctx.inf.buss.buss.size(); ++b) {
+            const auto &bus = ctx.inf.buss.buss[b];
 
             std::string tmp1, tmp2, tmp3 = "", tmp4;
             tmp1 = "/" + ((!bus.name.empty()) ? bus.name : "setup_" + std::to_string(b));
             fprintf(stdout, "        Extract SETUP contents to %s/\n", tmp1.c_str());
-            if (!createFolder((out + tmp + tmp1 + "/").c_str())) {
+            if (!createFolder(ctx.queue, (out + tmp + tmp1 + "/").c_str())) {
                 fprintf(stderr, "        Unable to create %s/\n", tmp1.c_str());
-                continue;
+                ret = 0; continue;
             }
 
             fprintf(stdout, "            Extract UNIT contents to /units.txt\n");
@@ -218,10 +300,10 @@ void extractSgxd(const char *folder) {
             }
             if (tmp3.empty()) tmp3 = "(none)";
 
-            if (createFile((out + tmp + tmp1 + "/units.txt").c_str(), tmp3.data(), tmp3.size())) {
+            if (createFile(ctx.queue, (out + tmp + tmp1 + "/units.txt").c_str(), tmp3.data(), tmp3.size())) {
                 fprintf(stdout, "                Extracted /units.txt\n");
             }
-            else fprintf(stderr, "                Unable to extract /units.txt\n");
+            else { fprintf(stderr, "                Unable to extract /units.txt\n"); ret = 0; }
 
             fprintf(stdout, "            Extract EFFECT contents to %s/\n", tmp1.c_str());
             std::vector<std::string> mods {""};
@@ -234,9 +316,9 @@ void extractSgxd(const char *folder) {
                 tmp2 = "";
                 if (id != mods.begin()) {
                     tmp2 = "/" + efx.module;
-                    if (!createFolder((out + tmp + tmp1 + tmp2 + "/").c_str())) {
+                    if (!createFolder(ctx.queue, (out + tmp + tmp1 + tmp2 + "/").c_str())) {
                         fprintf(stderr, "                Unable to create %s/\n", tmp2.c_str());
-                        continue;
+                        ret = 0; continue;
                     }
                 }
 
@@ -244,16 +326,16 @@ void extractSgxd(const char *folder) {
                 tmp3 = "/" + tmp3 + ".txt";
                 tmp4 = (!efx.preset.empty()) ? efx.preset : "(none)";
 
-                if (createFile((out + tmp + tmp1 + tmp2 + tmp3).c_str(), tmp4.data(), tmp4.size())) {
+                if (createFile(ctx.queue, (out + tmp + tmp1 + tmp2 + tmp3).c_str(), tmp4.data(), tmp4.size())) {
                     fprintf(stdout, "                Extracted %s\n", (tmp2 + tmp3).c_str());
                 }
-                else fprintf(stderr, "                Unable to extract %s\n", (tmp2 + tmp3).c_str());
+                else { fprintf(stderr, "                Unable to extract %s\n", (tmp2 + tmp3).c_str()); ret = 0; }
             }
         }
 
-        if (sgd_text) {
-            auto bus = extractBuss();
-            if (createFile((out + "/buss.txt").c_str(), bus.data(), bus.size())) {
+        if (ctx.text) {
+            auto bus = extractBuss(ctx);
+            if (createFile(ctx.queue, (out + "/buss.txt").c_str(), bus.data(), bus.size())) {
                 fprintf(stdout, "        Extracted /buss.txt\n");
             }
         }
@@ -263,25 +345,25 @@ void extractSgxd(const char *folder) {
 #endif
 
 #ifdef UNPACKRGND_IMPLEMENTATION
-    while (!sgd_inf.rgnd.empty()) {
+    while (!ctx.inf.rgnd.empty()) {
         tmp = "/rgnd";
         fprintf(stdout, "    Extract RGND contents to %s/\n", tmp.c_str());
 
-        if (!createFolder((out + tmp + "/").c_str())) {
+        if (!createFolder(ctx.queue, (out + tmp + "/").c_str())) {
             fprintf(stderr, "    Unable to create %s/\n", tmp.c_str());
-            break;
+            ret = 0; break;
         }
 
-        std::string nam = "/" + sgd_inf.file + ".sf2";
-        const auto sf2 = rgndToSfbk();
-        if (!sf2.empty() && createFile((out + tmp + nam).c_str(), (unsigned char*)sf2.data(), sf2.size())) {
+        std::string nam = "/" + ctx.inf.file + ".sf2";
+        auto sf2 = rgndToSfbk(ctx);
+        if (!sf2.empty() && createFile(ctx.queue, (out + tmp + nam).c_str(), std::move(sf2))) {
             fprintf(stdout, "        Extracted %s\n", nam.c_str());
         }
-        else fprintf(stderr, "        Unable to extract %s\n", nam.c_str());
+        else { fprintf(stderr, "        Unable to extract %s\n", nam.c_str()); ret = 0; }
 
-        if (sgd_text) {
-            const auto rgn = extractRgnd();
-            if (createFile((out + "/rgnd.txt").c_str(), rgn.data(), rgn.size())) {
+        if (ctx.text) {
+            const auto rgn = extractRgnd(ctx);
+            if (createFile(ctx.queue, (out + "/rgnd.txt").c_str(), rgn.data(), rgn.size())) {
                 fprintf(stdout, "        Extracted /rgnd.txt\n");
             }
         }
@@ -291,22 +373,24 @@ void extractSgxd(const char *folder) {
 #endif
 
 #ifdef UNPACKSEQD_IMPLEMENTATION
-    while (!sgd_inf.seqd.empty()) {
+    while (!ctx.inf.seqd.empty()) {
         tmp = "/seqd";
         fprintf(stdout, "    Extract SEQD contents to %s/\n", tmp.c_str());
 
-        if (!createFolder((out + tmp + "/").c_str())) {
+        if (!createFolder(ctx.queue, (out + tmp + "/").c_str())) {
             fprintf(stderr, "    Unable to create %s/\n", tmp.c_str());
-            break;
+            ret = 0; break;
         }
 
-        for (int g = 0; g < sgd_inf.seqd.seqd.size(); ++g) {
-            if (sgd_inf.seqd.seqd[g].seq.empty()) continue;
-            for (int s = 0; s < sgd_inf.seqd.seqd[g].seq.size(); ++s) {
-                if (sgd_inf.seqd.seqd[g].seq[s].empty()) continue;
+        //Convert any sequences left unconverted before packing them in order
+        convertSeqd(ctx);
+        for (int g = 0; g < ctx.inf.seqd.seqd.size(); ++g) {
+            if (ctx.inf.seqd.seqd[g].seq.empty()) continue;
+            for (int s = 0; s < ctx.inf.seqd.seqd[g].seq.size(); ++s) {
+                if (ctx.inf.seqd.seqd[g].seq[s].empty()) continue;
 
-                const auto &sq = sgd_inf.seqd.seqd[g].seq[s];
-                const auto seq = seqdToMidi(g, s);
+                const auto &sq = ctx.inf.seqd.seqd[g].seq[s];
+                auto seq = seqdToMidi(ctx, g, s);
                 const auto &asd = sq.asmdata;
                 std::string nam, ext;
 
@@ -318,19 +402,19 @@ void extractSgxd(const char *folder) {
                 nam = "/" + nam.substr(0, nam.find_first_of("."));
                 ext = (sq.fmt > SEQD_RAWMIDI) ? ".unk" : ".mid";
 
-                if (!seq.empty() && createFile((out + tmp + nam + ext).c_str(), (unsigned char*)seq.data(), seq.size())) {
+                if (!seq.empty() && createFile(ctx.queue, (out + tmp + nam + ext).c_str(), std::move(seq))) {
                     fprintf(stdout, "        Extracted %s\n", (nam + ext).c_str());
                 }
                 
-                if (sgd_text && !asd.empty() && createFile((out + tmp + nam + ".asm").c_str(), asd.c_str(), asd.size())) {
+                if (ctx.text && !asd.empty() && createFile(ctx.queue, (out + tmp + nam + ".asm").c_str(), asd.c_str(), asd.size())) {
                     fprintf(stdout, "        Extracted %s.asm\n", nam.c_str());
                 }
             }
         }
 
-        if (sgd_text) {
-            const auto seq = extractSeqd();
-            if (createFile((out + "/seqd.txt").c_str(), seq.data(), seq.size())) {
+        if (ctx.text) {
+            const auto seq = extractSeqd(ctx);
+            if (createFile(ctx.queue, (out + "/seqd.txt").c_str(), seq.data(), seq.size())) {
                 fprintf(stdout, "        Extracted /seqd.txt\n");
             }
         }
@@ -340,35 +424,37 @@ void extractSgxd(const char *folder) {
 #endif
 
 #ifdef UNPACKWAVE_IMPLEMENTATION
-    while (!sgd_inf.wave.empty()) {
+    while (!ctx.inf.wave.empty()) {
         tmp = "/wave";
         fprintf(stdout, "    Extract WAVE contents to %s/\n", tmp.c_str());
 
-        if (!createFolder((out + tmp + "/").c_str())) {
+        if (!createFolder(ctx.queue, (out + tmp + "/").c_str())) {
             fprintf(stderr, "    Unable to create %s/\n", tmp.c_str());
-            break;
+            ret = 0; break;
         }
 
-        for (int w = 0; w < sgd_inf.wave.wave.size(); ++w) {
-            const auto wav = waveToWave(w);
+        //Decode any waves left undecoded before packing them in order
+        parallelFor(ctx.jobs, ctx.inf.wave.wave.size(), [&ctx](const unsigned w) -> void { decodeWave(ctx, w); });
+        for (int w = 0; w < ctx.inf.wave.wave.size(); ++w) {
+            auto wav = waveToWave(ctx, w);
             std::string nam;
 
-            if (!sgd_inf.wave.wave[w].name.empty()) nam = sgd_inf.wave.wave[w].name;
+            if (!ctx.inf.wave.wave[w].name.empty()) nam = ctx.inf.wave.wave[w].name;
             else {
                 nam.resize(snprintf(nullptr, 0, "smpl_%03d", w));
                 snprintf(nam.data(), nam.size() + 1, "smpl_%03d", w);
             }
             nam = "/" + nam + ".wav";
 
-            if (!wav.empty() && createFile((out + tmp + nam).c_str(), (unsigned char*)wav.data(), wav.size())) {
+            if (!wav.empty() && createFile(ctx.queue, (out + tmp + nam).c_str(), std::move(wav))) {
                 fprintf(stdout, "        Extracted %s\n", nam.c_str());
             }
-            else fprintf(stderr, "        Unable to extract %s\n", nam.c_str());
+            else { fprintf(stderr, "        Unable to extract %s\n", nam.c_str()); ret = 0; }
         }
 
-        if (sgd_text) {
-            const auto wav = extractWave();
-            if (createFile((out + "/wave.txt").c_str(), wav.data(), wav.size())) {
+        if (ctx.text) {
+            const auto wav = extractWave(ctx);
+            if (createFile(ctx.queue, (out + "/wave.txt").c_str(), wav.data(), wav.size())) {
                 fprintf(stdout, "        Extracted /wave.txt\n");
             }
         }
@@ -378,37 +464,37 @@ void extractSgxd(const char *folder) {
 #endif
 
 #ifdef UNPACKWSUR_IMPLEMENTATION
-    if (!sgd_inf.wsur.empty() && sgd_text) {
+    if (!ctx.inf.wsur.empty() && ctx.text) {
         fprintf(stdout, "    Extract WSUR contents to %s/\n", out.c_str());
-        const auto sur = extractWsur();
-        if (createFile((out + "/wsur.txt").c_str(), sur.data(), sur.size())) {
+        const auto sur = extractWsur(ctx);
+        if (createFile(ctx.queue, (out + "/wsur.txt").c_str(), sur.data(), sur.size())) {
             fprintf(stdout, "        Extracted /wsur.txt\n");
         }
     }
 #endif
 
 #ifdef UNPACKWMKR_IMPLEMENTATION
-    if (!sgd_inf.wmkr.empty() && sgd_text) {
+    if (!ctx.inf.wmkr.empty() && ctx.text) {
         fprintf(stdout, "    Extract WMKR contents to %s/\n", out.c_str());
-        const auto mkr = extractWmkr();
-        if (createFile((out + "/wmkr.txt").c_str(), mkr.data(), mkr.size())) {
+        const auto mkr = extractWmkr(ctx);
+        if (createFile(ctx.queue, (out + "/wmkr.txt").c_str(), mkr.data(), mkr.size())) {
             fprintf(stdout, "        Extracted /wmkr.txt\n");
         }
     }
 #endif
 
 #ifdef UNPACKCONF_IMPLEMENTATION
-    while (!sgd_inf.conf.empty()) {
+    while (!ctx.inf.conf.empty()) {
         tmp = "/conf";
         fprintf(stdout, "    Extract CONF contents to %s/\n", tmp.c_str());
 
-        if (!createFolder((out + tmp + "/").c_str())) {
+        if (!createFolder(ctx.queue, (out + tmp + "/").c_str())) {
             fprintf(stderr, "    Unable to create %s/\n", tmp.c_str());
-            break;
+            ret = 0; break;
         }
 
-        for (int c = 0; c < sgd_inf.conf.conf.size(); ++c) {
-            const auto &cnf = sgd_inf.conf.conf[c];
+        for (int c = 0; c < ctx.inf.conf.conf.size(); ++c) {
+            const auto &cnf = ctx.inf.conf.conf[c];
             std::string nam;
 
             if (!cnf.name.empty()) nam = cnf.name;
@@ -418,15 +504,15 @@ void extractSgxd(const char *folder) {
             }
             nam = "/" + nam + ".txt";
 
-            if (!cnf.text.empty() && createFile((out + tmp + nam).c_str(), cnf.text.data(), cnf.text.size())) {
+            if (!cnf.text.empty() && createFile(ctx.queue, (out + tmp + nam).c_str(), cnf.text.data(), cnf.text.size())) {
                 fprintf(stdout, "        Extracted %s\n", nam.c_str());
             }
-            else fprintf(stderr, "        Unable to extract %s\n", nam.c_str());
+            else { fprintf(stderr, "        Unable to extract %s\n", nam.c_str()); ret = 0; }
         }
 
-        if (sgd_text) {
-            const auto cnf = extractConf();
-            if (createFile((out + "/conf.txt").c_str(), cnf.data(), cnf.size())) {
+        if (ctx.text) {
+            const auto cnf = extractConf(ctx);
+            if (createFile(ctx.queue, (out + "/conf.txt").c_str(), cnf.data(), cnf.size())) {
                 fprintf(stdout, "        Extracted /conf.txt\n");
             }
         }
@@ -436,34 +522,113 @@ void extractSgxd(const char *folder) {
 #endif
 
 #ifdef UNPACKTUNE_IMPLEMENTATION
-    if (!sgd_inf.tune.empty() && sgd_text) {
+    if (!ctx.inf.tune.empty() && ctx.text) {
         fprintf(stdout, "    Extract TUNE contents to %s/\n", out.c_str());
-        const auto tun = extractTune();
-        if (createFile((out + "/tune.txt").c_str(), tun.data(), tun.size())) {
+        const auto tun = extractTune(ctx);
+        if (createFile(ctx.queue, (out + "/tune.txt").c_str(), tun.data(), tun.size())) {
             fprintf(stdout, "        Extracted /tune.txt\n");
         }
     }
 #endif
 
 #ifdef UNPACKADSR_IMPLEMENTATION
-    if (!sgd_inf.adsr.empty() && sgd_text) {
+    if (!ctx.inf.adsr.empty() && ctx.text) {
         fprintf(stdout, "    Extract ADSR contents to %s/\n", out.c_str());
-        const auto env = extractAdsr();
-        if (createFile((out + "/adsr.txt").c_str(), env.data(), env.size())) {
+        const auto env = extractAdsr(ctx);
+        if (createFile(ctx.queue, (out + "/adsr.txt").c_str(), env.data(), env.size())) {
             fprintf(stdout, "        Extracted /adsr.txt\n");
         }
     }
 #endif
 
 #ifdef UNPACKNAME_IMPLEMENTATION
-    if (!sgd_inf.name.empty() && sgd_text) {
+    if (!ctx.inf.name.empty() && ctx.text) {
         fprintf(stdout, "    Extract NAME contents to %s/\n", out.c_str());
-        const auto nam = extractName();
-        if (createFile((out + "/name.txt").c_str(), nam.data(), nam.size())) {
+        const auto nam = extractName(ctx);
+        if (createFile(ctx.queue, (out + "/name.txt").c_str(), nam.data(), nam.size())) {
             fprintf(stdout, "        Extracted /name.txt\n");
         }
     }
 #endif
 
     fprintf(stdout, "End extraction\n");
+
+    return ret;
 }
+
+///Extracts misc data from global SGXD info
+int extractSgxd(const char *folder) { return extractSgxd(sgd_ctx, folder); }
+
+///Extracts SGXD metadata into string, nothing is decoded
+std::string probeSgxd(sgxdctx &ctx) {
+    std::string out;
+    auto set_fstr = [&out]<typename... T>(const char *in, T&&... args) -> void {
+        int s0 = snprintf(nullptr, 0, in, args...) + 1, s1 = out.size();
+        out.resize(s1 + s0 - 1); snprintf(out.data() + s1, s0, in, args...);
+    };
+    [[maybe_unused]] auto get_cdc = [](const unsigned char &cdc) -> const char* {
+        switch(cdc) {
+            case SGXD_CODEC_PCM16LE: return "PCM16LE";
+            case SGXD_CODEC_PCM16BE: return "PCM16BE";
+            case SGXD_CODEC_OGG_VORBIS: return "OGG";
+            case SGXD_CODEC_SONY_ADPCM: return "ADPCM";
+            case SGXD_CODEC_SONY_ATRAC3PLUS: return "AT3P";
+            case SGXD_CODEC_SONY_SHORT_ADPCM: return "SHORT_ADPCM";
+            case SGXD_CODEC_DOLBY_AC_3: return "AC3";
+            default: return "UNKNOWN";
+        }
+    };
+
+    if (ctx.inf.empty()) return out;
+
+    set_fstr("SGXD: %s\n", ctx.inf.file.c_str());
+    if (!ctx.body.empty()) {
+        set_fstr("    Body: %s\n", ctx.body.c_str());
+        set_fstr("    Stream Offset: %u\n", ctx.body_offs);
+        set_fstr("    Stream Size: %u\n", ctx.body_size);
+    }
+    set_fstr("    Chunks: %zu\n", ctx.chnk.size());
+    for (const auto &c : ctx.chnk) {
+        set_fstr(
+            "        %c%c%c%c: offset %u, size %u\n",
+            (c.fcc >> 24) & 0xFF, (c.fcc >> 16) & 0xFF, (c.fcc >> 8) & 0xFF, c.fcc & 0xFF,
+            c.offs, c.size
+        );
+    }
+
+#ifdef UNPACKWAVE_IMPLEMENTATION
+    set_fstr("    Waveforms: %zu\n", ctx.inf.wave.wave.size());
+    for (const auto &w : ctx.inf.wave.wave) {
+        set_fstr("        Waveform: %td\n", &w - ctx.inf.wave.wave.data());
+        set_fstr("            Name: %s\n", (!w.name.empty()) ? w.name.c_str() : "(none)");
+        set_fstr("            Codec: %s (0x%02X)\n", get_cdc(w.codec), w.codec);
+        set_fstr("            Channels: %d\n", w.chns);
+        set_fstr("            Sample Rate: %d\n", w.smprate);
+        set_fstr("            Loop Samples: %d\n", w.loopsmp);
+        set_fstr("            Loop Begin: %d\n", w.loopbeg);
+        set_fstr("            Loop End: %d\n", w.loopend);
+        set_fstr("            Stream Offset: %d\n", w.strmbeg);
+        set_fstr("            Stream Size: %d\n", w.strmsize);
+    }
+#endif
+
+#ifdef UNPACKSEQD_IMPLEMENTATION
+    set_fstr("    Sequence Groups: %zu\n", ctx.inf.seqd.seqd.size());
+    for (const auto &g : ctx.inf.seqd.seqd) {
+        for (const auto &s : g.seq) {
+            if (s.empty()) continue;
+            set_fstr("        Sequence: %td %td\n", &g - ctx.inf.seqd.seqd.data(), &s - g.seq.data());
+            set_fstr("            Name: %s\n", (!s.name.empty()) ? s.name.c_str() : "(none)");
+            set_fstr("            Format: %s\n", (s.fmt == SEQD_REQUEST) ? "REQUEST" :
+                                                 (s.fmt == SEQD_RAWMIDI) ? "MIDI" : "UNKNOWN");
+            set_fstr("            Division: %d\n", s.div);
+            set_fstr("            Size: %zu\n", s.data.size());
+        }
+    }
+#endif
+
+    return out;
+}
+
+///Extracts metadata from global SGXD info into string
+std::string probeSgxd() { return probeSgxd(sgd_ctx); }
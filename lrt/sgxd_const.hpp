@@ -27,6 +27,9 @@ enum SgxdSeqdFlag : unsigned {
 ///SGXD Sequence Type
 enum SgxdSeqdType : short { SEQD_REQUEST = 0, SEQD_RAWMIDI };
 
+///SGXD Sequence Conversion Stage
+enum SgxdSeqdStage : unsigned char { SEQD_STAGE_RAW = 0, SEQD_STAGE_EVENTS, SEQD_STAGE_LINKING, SEQD_STAGE_DONE };
+
 ///SGXD Sequence Request Statuses
 enum SgxdSeqdStatus : char {
     SEQD_SUB_START              = -80,
@@ -30,64 +30,109 @@
 #endif
 
 
-inline extern bool sgd_debug = false, sgd_text = false;
-inline extern const unsigned char *sgd_beg = 0, *sgd_dat_beg = 0, *sgd_dat_end = 0;
-inline extern sgxdinfo sgd_inf = {};
-
+inline extern sgxdctx sgd_ctx {};
+inline extern bool &sgd_debug = sgd_ctx.debug, &sgd_text = sgd_ctx.text;
+inline extern const unsigned char *&sgd_beg = sgd_ctx.beg, *&sgd_dat_beg = sgd_ctx.dat_beg, *&sgd_dat_end = sgd_ctx.dat_end;
+inline extern sgxdinfo &sgd_inf = sgd_ctx.inf;
+
+void unpackSgxd(sgxdctx &ctx, const char *file0, const char *file1 = 0);
+void unpackSgxd(sgxdctx &ctx, unsigned char *in, const unsigned length);
+void unpackSgxd(sgxdctx &ctx, unsigned char *in, const unsigned length, unsigned char *dat, const unsigned dat_length);
+void unpackSgxdHead(sgxdctx &ctx, const char *file0, const char *file1 = 0);
+void closeSgxd(sgxdctx &ctx);
+int extractSgxd(sgxdctx &ctx, const char *folder = 0);
+std::string probeSgxd(sgxdctx &ctx);
 void unpackSgxd(const char *file0, const char *file1 = 0);
 void unpackSgxd(unsigned char *in, const unsigned length);
-void extractSgxd(const char *folder = 0);
+void unpackSgxd(unsigned char *in, const unsigned length, unsigned char *dat, const unsigned dat_length);
+void unpackSgxdHead(const char *file0, const char *file1 = 0);
+void closeSgxd();
+int extractSgxd(const char *folder = 0);
+std::string probeSgxd();
+
+//Called across parts, so declared whichever parts are built
+void convertSeqd(sgxdctx &ctx, const int &grp, const int &seq);
+void convertSeqd(const int &grp, const int &seq);
+void convertSeqd(sgxdctx &ctx);
+void convertSeqd();
+void decodeWave(sgxdctx &ctx, const int &wav);
+void decodeWave(const int &wav);
 
 #ifdef UNPACKBUSS_IMPLEMENTATION
+void unpackBuss(sgxdctx &ctx, unsigned char *in, const unsigned length);
 void unpackBuss(unsigned char *in, const unsigned length);
+std::string extractBuss(sgxdctx &ctx);
 std::string extractBuss();
 #endif
 
 #ifdef UNPACKRGND_IMPLEMENTATION
+void unpackRgnd(sgxdctx &ctx, unsigned char *in, const unsigned length);
 void unpackRgnd(unsigned char *in, const unsigned length);
+std::vector<unsigned char> rgndToSfbk(sgxdctx &ctx);
 std::vector<unsigned char> rgndToSfbk();
+std::string extractRgnd(sgxdctx &ctx);
 std::string extractRgnd();
 #endif
 
 #ifdef UNPACKSEQD_IMPLEMENTATION
+void unpackSeqd(sgxdctx &ctx, unsigned char *in, const unsigned length);
 void unpackSeqd(unsigned char *in, const unsigned length);
+std::vector<unsigned char> seqdToMidi(sgxdctx &ctx, const int &grp, const int &seq);
 std::vector<unsigned char> seqdToMidi(const int &grp, const int &seq);
+std::string extractSeqd(sgxdctx &ctx);
 std::string extractSeqd();
 #endif
 
 #ifdef UNPACKWAVE_IMPLEMENTATION
+void unpackWave(sgxdctx &ctx, unsigned char *in, const unsigned length);
 void unpackWave(unsigned char *in, const unsigned length);
+std::vector<unsigned char> waveToWave(sgxdctx &ctx, const int &wav);
 std::vector<unsigned char> waveToWave(const int &wav);
+std::vector<unsigned char> probeWave(sgxdctx &ctx, const int &wav);
+std::vector<unsigned char> probeWave(const int &wav);
+std::string extractWave(sgxdctx &ctx);
 std::string extractWave();
 #endif
 
 #ifdef UNPACKWSUR_IMPLEMENTATION
+void unpackWsur(sgxdctx &ctx, unsigned char *in, const unsigned length);
 void unpackWsur(unsigned char *in, const unsigned length);
+std::string extractWsur(sgxdctx &ctx);
 std::string extractWsur();
 #endif
 
 #ifdef UNPACKWMKR_IMPLEMENTATION
+void unpackWmkr(sgxdctx &ctx, unsigned char *in, const unsigned length);
 void unpackWmkr(unsigned char *in, const unsigned length);
+std::string extractWmkr(sgxdctx &ctx);
 std::string extractWmkr();
 #endif
 
 #ifdef UNPACKCONF_IMPLEMENTATION
+void unpackConf(sgxdctx &ctx, unsigned char *in, const unsigned length);
 void unpackConf(unsigned char *in, const unsigned length);
+std::string extractConf(sgxdctx &ctx);
 std::string extractConf();
 #endif
 
 #ifdef UNPACKTUNE_IMPLEMENTATION
+void unpackTune(sgxdctx &ctx, unsigned char *in, const unsigned length);
 void unpackTune(unsigned char *in, const unsigned length);
+std::string extractTune(sgxdctx &ctx);
 std::string extractTune();
 #endif
 
 #ifdef UNPACKADSR_IMPLEMENTATION
+void unpackAdsr(sgxdctx &ctx, unsigned char *in, const unsigned length);
 void unpackAdsr(unsigned char *in, const unsigned length);
+std::string extractAdsr(sgxdctx &ctx);
 std::string extractAdsr();
 #endif
 
 #ifdef UNPACKNAME_IMPLEMENTATION
+void unpackName(sgxdctx &ctx, unsigned char *in, const unsigned length);
 void unpackName(unsigned char *in, const unsigned length);
+std::string extractName(sgxdctx &ctx);
 std::string extractName();
 #endif
 
@@ -1,6 +1,9 @@
 #ifndef SGXD_TYPES_HPP
 #define SGXD_TYPES_HPP
 
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -98,6 +101,65 @@ struct rgndinfo {
     bool empty() const { return !flag && rgnd.empty(); }
 };
 
+///Sequence Random Generator
+///  Seeded from seed, bank name, group and sequence, so picks don't depend on what's converted first
+///  Every component is mixed in on its own, so close seeds or banks don't give overlapping streams
+struct seqdrng {
+    unsigned long long state = 0;
+
+    seqdrng() = default;
+    seqdrng(const unsigned long long seed, const std::string &bnk, const int grp, const int seq) {
+        unsigned long long id = 0xCBF29CE484222325ULL;
+        for (const auto &c : bnk) id = (id ^ (unsigned char)c) * 0x100000001B3ULL;
+
+        state = getMix(seed);
+        state = getMix(state ^ id);
+        state = getMix(state ^ (unsigned)grp);
+        state = getMix(state ^ (unsigned)seq);
+    }
+
+    ///Gets next number (splitmix64)
+    unsigned long long getNext() { return getMix(state += 0x9E3779B97F4A7C15ULL); }
+    ///Picks one of minimum, minimum + increment, ... up to maximum
+    int getPick(const int min, const int max, const int inc) {
+        const long long cnt = (!inc ? 0 : llabs((long long)max - min) / llabs(inc)) + 1;
+        return min + (long long)(getNext() % cnt) * inc;
+    }
+
+    private:
+        ///Scrambles bits of a number (splitmix64 finalizer)
+        static unsigned long long getMix(unsigned long long z) {
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+};
+
+///Sequence Request Operand
+///  Constants are decoded once, random ones are followed by their minimum, maximum and increment
+struct seqdarg {
+    char typ;       //SEQD_POSITIVE for constants, SEQD_SYSREG or SEQD_REG for registers, SEQD_RANDOM otherwise
+    int val;        //Value or register number
+};
+
+///Sequence Request Instruction
+struct seqdinst {
+    static const unsigned ARGS = 11;    //Most operands any request reads
+
+    char op;        //See SgxdSeqdStatus
+    unsigned char argc;
+    unsigned argi;  //First operand in seqdprog::arg
+};
+
+///Sequence Request Programme
+///  Request stream decoded once, operands already read
+struct seqdprog {
+    std::vector<seqdinst> inst;
+    std::vector<seqdarg> arg;
+    
+    bool empty() const { return inst.empty(); }
+};
+
 ///Sequence Definition Fields
 struct seqdseq {
     unsigned flag;
@@ -108,6 +170,8 @@ struct seqdseq {
     short volright;
     std::vector<unsigned char> data;
     std::string asmdata;
+    seqdprog prog;
+    unsigned char stage = 0; //Conversion progress, see SgxdSeqdStage
     
     bool empty() const {
         return
@@ -118,7 +182,8 @@ struct seqdseq {
             !volleft &&
             !volright &&
             data.empty() &&
-            asmdata.empty();
+            asmdata.empty() &&
+            prog.empty();
     }
 };
 
@@ -142,7 +207,7 @@ struct seqdinfo {
 struct wavewav {
     unsigned flag;
     std::string name;
-    //char codec;
+    unsigned char codec;
     char chns;
     char numloop;
     //unsigned char res0;
@@ -155,10 +220,12 @@ struct wavewav {
     signed loopsmp;
     signed loopbeg;
     signed loopend;
-    //signed strmsize;
-    //signed strmbeg;
-    //signed strmend;
+    signed strmsize;
+    signed strmbeg;
+    signed strmend;
     std::vector<short> pcm;
+    bool is_dec = false;    //PCM complete
+    bool is_run = false;    //PCM being decoded by some thread
 };
 
 ///Waveform Definition Fields Main
@@ -290,5 +357,34 @@ struct sgxdinfo {
     }
 };
 
+///SGXD Chunk Index Fields
+struct sgxdchnk {
+    unsigned fcc;
+    unsigned offs;
+    unsigned size;
+};
+
+struct filequeue;
+
+///SGXD Conversion Context
+struct sgxdctx {
+    bool debug = false, text = false;
+    bool lazy = false; //Decode waves and convert sequences on first request
+    unsigned jobs = 0; //Worker threads, 0 for all cores
+    unsigned long long seed = 0; //Random request operands, mixed with bank, group and sequence
+    filequeue *queue = 0; //Write-behind output, 0 for direct writes
+    const unsigned char *beg = 0, *dat_beg = 0, *dat_end = 0;
+    const unsigned char *map0 = 0, *map1 = 0; //Files kept mapped while lazy
+    unsigned map0_size = 0, map1_size = 0;
+    std::vector<sgxdchnk> chnk;
+    std::string body; //Body file read on request after header-only unpack
+    unsigned body_offs = 0, body_size = 0;
+    std::mutex wave_lock; //Guards decode state of waves
+    std::condition_variable wave_wait;
+    sgxdinfo inf {};
+
+    ~sgxdctx(); //Releases files kept mapped while lazy
+};
+
 
 #endif
@@ -0,0 +1,233 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+///Trace Levels
+///  TRACE_LEVEL is the most detailed level built in, anything past it compiles to nothing
+///  Hot loops stay clean unless built with -DTRACE_LEVEL=2
+#define TRACE_LEVEL_NONE    0       //No tracing
+#define TRACE_LEVEL_STEP    1       //Steps and headers
+#define TRACE_LEVEL_FIELD   2       //Every event and field, hot loops included
+#ifndef TRACE_LEVEL
+    #define TRACE_LEVEL TRACE_LEVEL_STEP
+#endif
+
+///Trace a printf-style line if on, arguments aren't evaluated otherwise
+#define TRACE_AT(lvl, on, ...) do { if constexpr ((lvl) <= TRACE_LEVEL) { if (on) setTrace(__VA_ARGS__); } } while (0)
+#define TRACE_STEP(on, ...) TRACE_AT(TRACE_LEVEL_STEP, on, __VA_ARGS__)
+#define TRACE_FIELD(on, ...) TRACE_AT(TRACE_LEVEL_FIELD, on, __VA_ARGS__)
+
+
+///Trace Record
+///  Format and raw arguments of one line, formatted when its ring is drained
+struct tracerec {
+    enum : unsigned char { ARG_INT, ARG_LONG, ARG_DBL, ARG_STR };
+    static const unsigned ARGS = 6, TEXT = 64;
+
+    const char *form;                   //Format, has to be a literal
+    unsigned char size;
+    unsigned char type[ARGS];
+    union { long long i; double d; } args[ARGS];
+    char text[TEXT];                    //String arguments, cut off past the end
+};
+
+///Trace Ring
+///  Written by its own thread only, drained by whoever holds the drain lock
+struct tracering {
+    static const unsigned SIZE = 1 << 10;
+
+    tracerec recs[SIZE];
+    std::atomic<unsigned> head {0}, tail {0};
+    std::atomic<unsigned> lost {0};     //Records dropped while full
+    bool real = false;                  //Real-time thread, never drains itself
+};
+
+///Trace State
+///  Rings of every thread that traced, and the lock for draining them
+struct tracestate {
+    std::mutex lock;
+    std::vector<tracering*> rings;
+    FILE *out = stderr;
+};
+inline tracestate trace_state;
+
+///Ring given to current thread ahead of time, plain pointer so using it never allocates
+inline thread_local tracering *trace_ring = 0;
+
+
+///Format a record into out
+///  Conversions are done one at a time with the type the argument was recorded as,
+///  so length modifiers in the format don't matter
+static inline void getTrace(const tracerec &rec, std::string &out) {
+    char tmp[128];
+    unsigned a = 0;
+
+    for (const char *in = rec.form; *in;) {
+        const char *p0 = strchr(in, '%');
+        if (!p0) { out += in; break; }
+        out.append(in, p0);
+
+        //Take conversion apart, dropping length modifiers
+        std::string spc = "%";
+        const char *p1 = p0 + 1;
+        while (*p1 && strchr("-+ #0123456789.", *p1)) spc += *(p1++);
+        while (*p1 && strchr("hlLqjzt", *p1)) p1 += 1;
+        if (!*p1) break;
+        if (*p1 == '%') { out += '%'; in = p1 + 1; continue; }
+        in = p1 + 1;
+        if (a >= rec.size) continue;
+
+        const auto &arg = rec.args[a];
+        int siz = 0;
+        switch (rec.type[a++]) {
+            case tracerec::ARG_INT:
+                spc += *p1;
+                siz = snprintf(tmp, sizeof(tmp), spc.c_str(), (int)arg.i);
+                break;
+            case tracerec::ARG_LONG:
+                spc += "ll"; spc += *p1;
+                siz = snprintf(tmp, sizeof(tmp), spc.c_str(), arg.i);
+                break;
+            case tracerec::ARG_DBL:
+                spc += *p1;
+                siz = snprintf(tmp, sizeof(tmp), spc.c_str(), arg.d);
+                break;
+            case tracerec::ARG_STR:
+                spc += 's';
+                siz = snprintf(tmp, sizeof(tmp), spc.c_str(), rec.text + arg.i);
+                break;
+        }
+        if (siz > 0) out.append(tmp, std::min<unsigned>(siz, sizeof(tmp) - 1));
+    }
+}
+
+///Drain ring into trace output, drain lock has to be held
+static inline void getTrace(tracering &ring) {
+    std::string out;
+    unsigned tl = ring.tail.load(std::memory_order_relaxed);
+    const unsigned hd = ring.head.load(std::memory_order_acquire);
+
+    for (; tl != hd; ++tl) getTrace(ring.recs[tl % tracering::SIZE], out);
+    ring.tail.store(tl, std::memory_order_release);
+
+    if (const unsigned lst = ring.lost.exchange(0)) {
+        out += "    (" + std::to_string(lst) + " trace lines dropped)\n";
+    }
+    if (!out.empty()) fwrite(out.data(), 1, out.size(), trace_state.out);
+}
+
+///Get ring of current thread, made on first use and drained once the thread ends
+///  Inline so every file shares the thread's one ring
+inline tracering& getTraceRing() {
+    if (trace_ring) return *trace_ring;
+
+    struct owner {
+        tracering *ring = 0;
+        ~owner() {
+            if (!ring) return;
+            std::lock_guard<std::mutex> lck(trace_state.lock);
+            getTrace(*ring);
+            auto &rs = trace_state.rings;
+            rs.erase(std::remove(rs.begin(), rs.end(), ring), rs.end());
+            delete ring;
+        }
+    };
+    static thread_local owner own;
+
+    if (!own.ring) {
+        own.ring = new tracering;
+        std::lock_guard<std::mutex> lck(trace_state.lock);
+        trace_state.rings.push_back(own.ring);
+    }
+    return *own.ring;
+}
+
+///Mark current thread as real-time, its full ring drops lines instead of draining
+static inline void setTraceRealtime(const bool real = true) { getTraceRing().real = real; }
+
+///Make real-time ring ahead, for a thread that can't allocate or lock when it first traces
+///  The thread takes it with setTraceRing, it's dropped with dropTraceRing once the thread is stopped
+static inline tracering* getTraceRealtime() {
+    tracering *ring = new tracering;
+    ring->real = true;
+    std::lock_guard<std::mutex> lck(trace_state.lock);
+    trace_state.rings.push_back(ring);
+    return ring;
+}
+
+///Give current thread a ring made ahead, none goes back to its own
+static inline void setTraceRing(tracering *ring) { trace_ring = ring; }
+
+///Drain and drop ring made ahead, no thread can be using it anymore
+static inline void dropTraceRing(tracering *ring) {
+    if (!ring) return;
+    std::lock_guard<std::mutex> lck(trace_state.lock);
+    getTrace(*ring);
+    auto &rs = trace_state.rings;
+    rs.erase(std::remove(rs.begin(), rs.end(), ring), rs.end());
+    delete ring;
+}
+
+///Write every waiting line of every thread
+static inline void flushTrace() {
+    std::lock_guard<std::mutex> lck(trace_state.lock);
+    for (auto *r : trace_state.rings) getTrace(*r);
+    fflush(trace_state.out);
+}
+
+///Record a line into ring of current thread
+template<typename... T>
+static inline void setTrace(const char *form, const T&... args) {
+    static_assert(sizeof...(T) <= tracerec::ARGS, "Too many trace arguments");
+    auto &ring = getTraceRing();
+    const unsigned hd = ring.head.load(std::memory_order_relaxed);
+
+    if (hd - ring.tail.load(std::memory_order_acquire) >= tracering::SIZE) {
+        if (ring.real) { ring.lost += 1; return; }
+        std::lock_guard<std::mutex> lck(trace_state.lock);
+        getTrace(ring);
+    }
+
+    auto &rec = ring.recs[hd % tracering::SIZE];
+    unsigned txt = 0;
+    rec.form = form;
+    rec.size = 0;
+
+    [[maybe_unused]] auto set_arg = [&rec, &txt]<typename A>(const A &arg) -> void {
+        const auto a = rec.size++;
+        if constexpr (std::is_floating_point_v<A>) {
+            rec.type[a] = tracerec::ARG_DBL; rec.args[a].d = arg;
+        }
+        else if constexpr (std::is_integral_v<A> || std::is_enum_v<A>) {
+            rec.type[a] = (sizeof(A) > sizeof(int)) ? tracerec::ARG_LONG : tracerec::ARG_INT;
+            rec.args[a].i = (long long)arg;
+        }
+        else {
+            const char *str;
+            if constexpr (std::is_same_v<A, std::string>) str = arg.c_str();
+            else str = arg;
+            const unsigned pos = std::min(txt, tracerec::TEXT - 1);
+            const unsigned siz = std::min<unsigned>(strlen(str), tracerec::TEXT - 1 - pos);
+
+            rec.type[a] = tracerec::ARG_STR; rec.args[a].i = pos;
+            memcpy(rec.text + pos, str, siz);
+            rec.text[pos + siz] = 0;
+            txt = pos + siz + 1;
+        }
+    };
+    (set_arg(args), ...);
+
+    ring.head.store(hd + 1, std::memory_order_release);
+}
+
+
+#endif
@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <bitset>
 #include <cstdio>
+#include <mutex>
 #include <vector>
 #ifdef DECODESONYAT3P_IMPLEMENTATION
 #define NEEDEDRIFFWAVE_IMPLEMENTATION
@@ -8,6 +9,9 @@
 #include "sgxd_const.hpp"
 #include "sgxd_types.hpp"
 #include "sgxd_func.hpp"
+#include "directory.hpp"
+#include "parallel.hpp"
+#include "trace.hpp"
 #include "audio/audio_func.hpp"
 #include "riff/fourcc_type.hpp"
 #include "riff/chunk_type.hpp"
@@ -26,15 +30,15 @@ MAKEUUID(WAVE_GUID_SONYATRAC3PLUS, 0xE923AABF, 0xCB58, 0x4471, 0xA119FFFA01E4CE6
 #endif
 
 ///Unpacks variable waveform definitions from WAVE data
-void unpackWave(unsigned char *in, const unsigned length) {
-    if (sgd_debug) fprintf(stderr, "    Unpack WAVE\n");
+void unpackWave(sgxdctx &ctx, unsigned char *in, const unsigned length) {
+    TRACE_STEP(ctx.debug, "    Unpack WAVE\n");
     
-    sgd_inf.wave = {};
-    if (!sgd_beg || !sgd_dat_beg || !sgd_dat_end || !in || length < 8) return;
+    ctx.inf.wave = {};
+    if (!ctx.beg || !ctx.dat_beg || !ctx.dat_end || !in || length < 8) return;
 
     const unsigned char *in_end = in + length;
     unsigned t_sz;
-    auto &out = sgd_inf.wave;
+    auto &out = ctx.inf.wave;
 
     auto get_int = [&in, &in_end](const unsigned length) -> unsigned {
         unsigned out = 0;
@@ -51,18 +55,17 @@ void unpackWave(unsigned char *in, const unsigned length) {
         return out;
     };
 
-    if (sgd_debug) fprintf(stderr, "    Read WAVE Header\n");
+    TRACE_STEP(ctx.debug, "    Read WAVE Header\n");
     out.flag = get_int(4);
     out.wave.resize(get_int(4));
-    signed tinf[out.wave.size()][4] {};
 
-    if (sgd_debug) fprintf(stderr, "        Global flag: 0x%08X\n", out.flag);
+    TRACE_STEP(ctx.debug, "        Global flag: 0x%08X\n", out.flag);
 
-    if (sgd_debug) fprintf(stderr, "    Read WAVE Definition\n");
+    TRACE_STEP(ctx.debug, "    Read WAVE Definition\n");
     for (auto &w : out.wave) {
         w.flag = get_int(4);
-        w.name = get_str(sgd_beg, get_int(4));
-        tinf[&w - out.wave.data()][0] = *(in++);
+        w.name = get_str(ctx.beg, get_int(4));
+        w.codec = *(in++);
         w.chns = *(in++);
         w.numloop = *(in++);
         in += 1;
@@ -75,200 +78,243 @@ void unpackWave(unsigned char *in, const unsigned length) {
         w.loopsmp = get_int(4);
         w.loopbeg = get_int(4);
         w.loopend = get_int(4);
-        tinf[&w - out.wave.data()][1] = get_int(4);
-        tinf[&w - out.wave.data()][2] = get_int(4);
-        tinf[&w - out.wave.data()][3] = get_int(4);
+        w.strmsize = get_int(4);
+        w.strmbeg = get_int(4);
+        w.strmend = get_int(4);
+        if (w.loopbeg < 0) w.loopbeg = w.loopsmp;
+        if (w.loopend < 0) w.loopend = w.loopsmp;
         
-        if (sgd_debug) {
-            fprintf(stderr, "        Current waveform: %d\n", &w - out.wave.data());
-            fprintf(stderr, "            Local flag: 0x%08X\n", w.flag);
-            fprintf(stderr, "            Name: %s\n", w.name.c_str());
-            fprintf(stderr, "            Channels: %d\n", w.chns);
-            fprintf(stderr, "            Loop amount: %d\n", w.numloop);
-            fprintf(stderr, "            Sample rate: %d\n", w.smprate);
-            fprintf(stderr, "            Bit rate: %d\n", w.rate0);
-            fprintf(stderr, "            Byte rate: %d\n", w.rate1);
-            fprintf(stderr, "            Left volume: %d\n", w.volleft);
-            fprintf(stderr, "            Right volume: %d\n", w.volright);
-            fprintf(stderr, "            Loop position: %d\n", w.looppos);
-            fprintf(stderr, "            Loop samples: %d\n", w.loopsmp);
-            fprintf(stderr, "            Loop begin: %d\n", w.loopbeg);
-            fprintf(stderr, "            Loop end: %d\n", w.loopend);
+        TRACE_FIELD(ctx.debug, "        Current waveform: %d\n", &w - out.wave.data());
+        TRACE_FIELD(ctx.debug, "            Local flag: 0x%08X\n", w.flag);
+        TRACE_FIELD(ctx.debug, "            Name: %s\n", w.name.c_str());
+        TRACE_FIELD(ctx.debug, "            Channels: %d\n", w.chns);
+        TRACE_FIELD(ctx.debug, "            Loop amount: %d\n", w.numloop);
+        TRACE_FIELD(ctx.debug, "            Sample rate: %d\n", w.smprate);
+        TRACE_FIELD(ctx.debug, "            Bit rate: %d\n", w.rate0);
+        TRACE_FIELD(ctx.debug, "            Byte rate: %d\n", w.rate1);
+        TRACE_FIELD(ctx.debug, "            Left volume: %d\n", w.volleft);
+        TRACE_FIELD(ctx.debug, "            Right volume: %d\n", w.volright);
+        TRACE_FIELD(ctx.debug, "            Loop position: %d\n", w.looppos);
+        TRACE_FIELD(ctx.debug, "            Loop samples: %d\n", w.loopsmp);
+        TRACE_FIELD(ctx.debug, "            Loop begin: %d\n", w.loopbeg);
+        TRACE_FIELD(ctx.debug, "            Loop end: %d\n", w.loopend);
+    }
+
+    //Waves are independent, decode each into its own buffer
+    if (ctx.lazy) return;
+    TRACE_STEP(ctx.debug, "    Decode WAVE\n");
+    parallelFor(ctx.jobs, out.wave.size(), [&ctx](const unsigned w) -> void { decodeWave(ctx, w); });
+}
+
+///Decodes specified waveform, if not yet decoded
+///  Callers asking for a wave being decoded wait for it, PCM is only put in once complete
+void decodeWave(sgxdctx &ctx, const int &wav) {
+    if (
+        wav < 0 || (unsigned)wav >= ctx.inf.wave.wave.size() ||
+        !ctx.dat_beg || !ctx.dat_end
+    ) return;
+
+    auto &wv = ctx.inf.wave.wave[wav];
+    std::vector<short> pcm;
+    auto set_pcm = [&ctx, &wv, &pcm]() -> void {
+        {
+            std::lock_guard<std::mutex> lck(ctx.wave_lock);
+            wv.pcm = std::move(pcm);
+            wv.is_dec = true; wv.is_run = false;
         }
+        ctx.wave_wait.notify_all();
+    };
+
+    {
+        std::unique_lock<std::mutex> lck(ctx.wave_lock);
+        ctx.wave_wait.wait(lck, [&wv]() { return !wv.is_run; });
+        if (wv.is_dec) return;
+        wv.is_run = true;
     }
 
-    if (sgd_debug) fprintf(stderr, "    Decode WAVE\n");
-    for (int w = 0; w < out.wave.size(); ++w) {
-        if (sgd_debug) fprintf(stderr, "        Current waveform: %d\n", w);
+    //Nothing to decode when stream lies outside of body
+    if (wv.strmbeg < 0 || wv.strmbeg >= ctx.dat_end - ctx.dat_beg) { set_pcm(); return; }
+    [[maybe_unused]] const unsigned siz = std::min<long long>(std::max(wv.strmsize, 0), ctx.dat_end - ctx.dat_beg - wv.strmbeg);
+
+    TRACE_STEP(ctx.debug, "        Current waveform: %d\n", wav);
 
-        switch(tinf[w][0] & 0xFF) {
+    switch(wv.codec) {
 #if 1
-            case SGXD_CODEC_PCM16LE:
-            case SGXD_CODEC_PCM16BE:
-                if (sgd_debug) fprintf(
-                    stderr,
-                    "            Decode 16bit %s Endian PCM\n",
-                    (tinf[w][0] & 0xFF) == SGXD_CODEC_PCM16LE ? "Little" : "Big"
-                );
-                in = (unsigned char*)sgd_dat_beg + tinf[w][2];
-                for (int d = 0; d < tinf[w][1]; ++d) {
-                    if ((tinf[w][0] & 0xFF) == SGXD_CODEC_PCM16LE) out.wave[w].pcm.push_back(get_int(2));
-                    else { out.wave[w].pcm.push_back((short)in[0] << 8 | in[1]); in += 2; }
-                }
-                break;
+        case SGXD_CODEC_PCM16LE:
+        case SGXD_CODEC_PCM16BE:
+            TRACE_STEP(
+                ctx.debug,
+                "            Decode 16bit %s Endian PCM\n",
+                (wv.codec) == SGXD_CODEC_PCM16LE ? "Little" : "Big"
+            );
+            for (int d = 0; d < wv.strmsize && ctx.dat_beg + wv.strmbeg + 2 * d + 2 <= ctx.dat_end; ++d) {
+                const unsigned char *in = ctx.dat_beg + wv.strmbeg + 2 * d;
+                if ((wv.codec) == SGXD_CODEC_PCM16LE) pcm.push_back((short)in[1] << 8 | in[0]);
+                else pcm.push_back((short)in[0] << 8 | in[1]);
+            }
+            break;
 #endif
 
 #ifdef DECODESONYADPCM_IMPLEMENTATION
-            case SGXD_CODEC_SONY_ADPCM:
-            case SGXD_CODEC_SONY_SHORT_ADPCM:
-                if (sgd_debug) fprintf(
-                    stderr,
-                    "            Decode Sony %s\n",
-                    (tinf[w][0] & 0xFF) == SGXD_CODEC_SONY_SHORT_ADPCM ? "Short ADPCM" : "ADPCM"
-                );
-                out.wave[w].pcm = decodeSonyAdpcm(
-                    (unsigned char*)sgd_dat_beg + tinf[w][2], tinf[w][1], out.wave[w].loopsmp,
-                    out.wave[w].chns, (tinf[w][0] & 0xFF) == SGXD_CODEC_SONY_SHORT_ADPCM
-                );
-                break;
+        case SGXD_CODEC_SONY_ADPCM:
+        case SGXD_CODEC_SONY_SHORT_ADPCM:
+            TRACE_STEP(
+                ctx.debug,
+                "            Decode Sony %s\n",
+                (wv.codec) == SGXD_CODEC_SONY_SHORT_ADPCM ? "Short ADPCM" : "ADPCM"
+            );
+            pcm = decodeSonyAdpcm(
+                (unsigned char*)ctx.dat_beg + wv.strmbeg, siz, wv.loopsmp,
+                wv.chns, (wv.codec) == SGXD_CODEC_SONY_SHORT_ADPCM
+            );
+            break;
 #endif
 
 #ifdef DECODESONYAT3P_IMPLEMENTATION
-            case SGXD_CODEC_SONY_ATRAC3PLUS:
-                if (sgd_debug) fprintf(stderr, "            Decode Sony Atrac3+\n");
-                unpackRiff((unsigned char*)sgd_dat_beg + tinf[w][2], tinf[w][1]);
-                unpackRiffWave(riff_inf.riff);
-                if (wav_inf.fmt.guid != WAVE_GUID_SONYATRAC3PLUS) continue;
-                else if (wav_inf.wavl.empty()) continue;
-                out.wave[w].pcm = decodeSonyAt3p(
-                    wav_inf.wavl[0].chnk.getArr().data(),
-                    wav_inf.wavl[0].chnk.size() - 8, out.wave[w].loopsmp,
-                    wav_inf.fmt.align, out.wave[w].chns,
-                    (!wav_inf.fact.smpinfo.empty()) ? &wav_inf.fact.smpinfo[0] : 0
-                );
-                break;
+        case SGXD_CODEC_SONY_ATRAC3PLUS: {
+            //RIFF WAVE unpacking still goes through global info
+            static std::mutex at3p_lock;
+            std::lock_guard<std::mutex> lock(at3p_lock);
+
+            TRACE_STEP(ctx.debug, "            Decode Sony Atrac3+\n");
+            unpackRiff((unsigned char*)ctx.dat_beg + wv.strmbeg, siz);
+            unpackRiffWave(riff_inf.riff);
+            if (wav_inf.fmt.guid != WAVE_GUID_SONYATRAC3PLUS) break;
+            else if (wav_inf.wavl.empty()) break;
+            pcm = decodeSonyAt3p(
+                wav_inf.wavl[0].chnk.getArr().data(),
+                wav_inf.wavl[0].chnk.size() - 8, wv.loopsmp,
+                wav_inf.fmt.align, wv.chns,
+                (!wav_inf.fact.smpinfo.empty()) ? &wav_inf.fact.smpinfo[0] : 0
+            );
+            break;
+        }
 #endif
 
 #ifdef DECODEDOLBYAC3_IMPLEMENTATION
-            case SGXD_CODEC_DOLBY_AC_3:
-                if ((sgd_dat_beg + tinf[w][2])[0] == 0x4F &&
-                    (sgd_dat_beg + tinf[w][2])[1] == 0x67 &&
-                    (sgd_dat_beg + tinf[w][2])[2] == 0x67 &&
-                    (sgd_dat_beg + tinf[w][2])[3] == 0x53);
-                else {
-                    if (sgd_debug) fprintf(stderr, "            Decode Dolby AC-3\n");
-                    out.wave[w].pcm = decodeDolbyAc3(
-                        (unsigned char*)sgd_dat_beg + tinf[w][2], tinf[w][1],
-                        out.wave[w].loopsmp, out.wave[w].rate1, out.wave[w].chns
-                    );
-                    break;
-                }
+        case SGXD_CODEC_DOLBY_AC_3:
+            if ((ctx.dat_beg + wv.strmbeg)[0] == 0x4F &&
+                (ctx.dat_beg + wv.strmbeg)[1] == 0x67 &&
+                (ctx.dat_beg + wv.strmbeg)[2] == 0x67 &&
+                (ctx.dat_beg + wv.strmbeg)[3] == 0x53);
+            else {
+                TRACE_STEP(ctx.debug, "            Decode Dolby AC-3\n");
+                pcm = decodeDolbyAc3(
+                    (unsigned char*)ctx.dat_beg + wv.strmbeg, siz,
+                    wv.loopsmp, wv.rate1, wv.chns
+                );
+                break;
+            }
 #endif
 
 #ifdef DECODEOGG_IMPLEMENTATION
-            case SGXD_CODEC_OGG_VORBIS:
-                if (sgd_debug) fprintf(stderr, "            Decode Ogg-Vorbis\n");
-                out.wave[w].pcm = decodeOgg(
-                    (unsigned char*)sgd_dat_beg + tinf[w][2], tinf[w][1],
-                    out.wave[w].loopsmp, (unsigned short*)&out.wave[w].chns
-                );
-                break;
+        case SGXD_CODEC_OGG_VORBIS:
+            TRACE_STEP(ctx.debug, "            Decode Ogg-Vorbis\n");
+            pcm = decodeOgg(
+                (unsigned char*)ctx.dat_beg + wv.strmbeg, siz,
+                wv.loopsmp, (unsigned short*)&wv.chns
+            );
+            break;
 #endif
-            case SGXD_CODEC_UNKNOWN0:
-            case SGXD_CODEC_UNKNOWN1:
-            default:
-                if (sgd_debug) fprintf(stderr, "            Codec 0x%02X\n", tinf[w][0] & 0xFF);
-                break;
-        }
-        
-        if (out.wave[w].loopbeg < 0) out.wave[w].loopbeg = out.wave[w].loopsmp;
-        if (out.wave[w].loopend < 0) out.wave[w].loopend = out.wave[w].loopsmp;
-        
-        if (!out.wave[w].pcm.empty()) {
-            if (
-                std::all_of(
-                    out.wave[w].pcm.begin(),
-                    out.wave[w].pcm.end(),
-                    [](const short &s) { return !s; }
-                )
-            ) out.wave[w].pcm.clear();
-            else if (sgd_debug) fprintf(stderr, "            Audio decode successful\n");
-        }
+        case SGXD_CODEC_UNKNOWN0:
+        case SGXD_CODEC_UNKNOWN1:
+        default:
+            TRACE_STEP(ctx.debug, "            Codec 0x%02X\n", wv.codec);
+            break;
+    }
+    
+    if (!pcm.empty()) {
+        if (
+            std::all_of(
+                pcm.begin(),
+                pcm.end(),
+                [](const short &s) { return !s; }
+            )
+        ) pcm.clear();
+        else TRACE_STEP(ctx.debug, "            Audio decode successful\n");
     }
+    set_pcm();
 }
 
+///Unpacks WAVE data into global SGXD info
+void unpackWave(unsigned char *in, const unsigned length) { unpackWave(sgd_ctx, in, length); }
+
+///Decodes specified waveform from global SGXD info, if not yet decoded
+void decodeWave(const int &wav) { decodeWave(sgd_ctx, wav); }
+
 ///Packs specified waveform into waveform data
-std::vector<unsigned char> waveToWave(const int &wav) {
-    if (sgd_debug) fprintf(stderr, "    Extract WAV\n");
+std::vector<unsigned char> waveToWave(sgxdctx &ctx, const int &wav) {
+    TRACE_STEP(ctx.debug, "    Extract WAV\n");
     
-    wav_inf = {};
+    riffwave riff {};
+    decodeWave(ctx, wav);
     if (
-        sgd_inf.wave.empty() ||
-        wav < 0 || wav >= sgd_inf.wave.wave.size() ||
-        sgd_inf.wave.wave[wav].pcm.empty()
+        ctx.inf.wave.empty() ||
+        wav < 0 || (unsigned)wav >= ctx.inf.wave.wave.size() ||
+        ctx.inf.wave.wave[wav].pcm.empty()
     ) return {};
 
-    const auto &wv = sgd_inf.wave.wave[wav];
+    const auto &wv = ctx.inf.wave.wave[wav];
 
-    if (sgd_debug) fprintf(stderr, "        Set format fields to waveform\n");
+    TRACE_STEP(ctx.debug, "        Set format fields to waveform\n");
     //Setup format fields
-    wav_inf.fmt.codec = CODEC_PCM;
-    wav_inf.fmt.chns = wv.chns;
-    wav_inf.fmt.smprate = wv.smprate;
-    wav_inf.fmt.bytrate = wv.smprate * 2;
-    wav_inf.fmt.align = 2;
-    wav_inf.fmt.bitrate = 16;
+    riff.fmt.codec = CODEC_PCM;
+    riff.fmt.chns = wv.chns;
+    riff.fmt.smprate = wv.smprate;
+    riff.fmt.bytrate = wv.smprate * 2;
+    riff.fmt.align = 2;
+    riff.fmt.bitrate = 16;
     if (wv.chns > 2) {
-        wav_inf.fmt.codec = CODEC_EXTENSIBLE;
-        wav_inf.fmt.smpinfo = 16;
+        riff.fmt.codec = CODEC_EXTENSIBLE;
+        riff.fmt.smpinfo = 16;
         switch(wv.chns) {
             case 3:
-                wav_inf.fmt.chnmask = SPKR_FL | SPKR_FR | SPKR_FC;
+                riff.fmt.chnmask = SPKR_FL | SPKR_FR | SPKR_FC;
                 break;
             case 4:
-                wav_inf.fmt.chnmask = SPKR_FL | SPKR_FR |
+                riff.fmt.chnmask = SPKR_FL | SPKR_FR |
                                       SPKR_BL | SPKR_BR;
                 break;
             case 5:
-                wav_inf.fmt.chnmask = SPKR_FL | SPKR_FR |
+                riff.fmt.chnmask = SPKR_FL | SPKR_FR |
                                       SPKR_FC |
                                       SPKR_BL | SPKR_BR;
                 break;
             case 6:
-                wav_inf.fmt.chnmask = SPKR_FL | SPKR_FR |
+                riff.fmt.chnmask = SPKR_FL | SPKR_FR |
                                       SPKR_FC | SPKR_LF |
                                       SPKR_BL | SPKR_BR;
                 break;
             case 7:
-                wav_inf.fmt.chnmask = SPKR_FL | SPKR_FR |
+                riff.fmt.chnmask = SPKR_FL | SPKR_FR |
                                       SPKR_FC | SPKR_LF |
                                       SPKR_BC |
                                       SPKR_BL | SPKR_BR;
                 break;
             case 8:
-                wav_inf.fmt.chnmask = SPKR_FL | SPKR_FR |
+                riff.fmt.chnmask = SPKR_FL | SPKR_FR |
                                       SPKR_FC | SPKR_LF |
                                       SPKR_SL | SPKR_SR |
                                       SPKR_BL | SPKR_BR;
                 break;
             default:
-                wav_inf.fmt.chnmask = SPKR_ALL;
+                riff.fmt.chnmask = SPKR_ALL;
                 break;
         }
-        wav_inf.fmt.guid = WAVE_GUID_PCM;
+        riff.fmt.guid = WAVE_GUID_PCM;
     }
 
-    if (sgd_debug) fprintf(stderr, "        Set waveform data to waveform\n");
+    TRACE_STEP(ctx.debug, "        Set waveform data to waveform\n");
     //Setup data field
-    wav_inf.wavl.emplace_back(wv.pcm);
+    riff.wavl.emplace_back(wv.pcm);
 
-    if (sgd_debug) fprintf(stderr, "        Set sampler info to waveform\n");
+    TRACE_STEP(ctx.debug, "        Set sampler info to waveform\n");
     //Setup sampler fields
-    wav_inf.smpl.emplace_back();
-    wav_inf.smpl.back().smpperiod = (1.00 / wv.smprate) * 1000000000;
-    wav_inf.smpl.back().noteroot = 60;
-    if (wv.loopbeg != wv.loopend) wav_inf.smpl.back().loops.emplace_back();
-    for (auto &lp : wav_inf.smpl.back().loops) {
+    riff.smpl.emplace_back();
+    riff.smpl.back().smpperiod = (1.00 / wv.smprate) * 1000000000;
+    riff.smpl.back().noteroot = 60;
+    if (wv.loopbeg != wv.loopend) riff.smpl.back().loops.emplace_back();
+    for (auto &lp : riff.smpl.back().loops) {
         lp.loopid = 0;
         lp.looptyp = 0;
         lp.loopbeg = wv.loopbeg;
@@ -277,12 +323,58 @@ std::vector<unsigned char> waveToWave(const int &wav) {
         lp.loopfrq = wv.numloop;
     }
 
-    return packRiffWave();
+    return packRiffWave(riff);
 }
 
+///Packs specified waveform from global SGXD info into waveform data
+std::vector<unsigned char> waveToWave(const int &wav) { return waveToWave(sgd_ctx, wav); }
+
+///Reads specified waveform from body file and packs it into waveform data
+///  Only the stream of that waveform is read, for use after unpackSgxdHead
+std::vector<unsigned char> probeWave(sgxdctx &ctx, const int &wav) {
+    TRACE_STEP(ctx.debug, "    Probe WAV\n");
+
+    if (
+        ctx.body.empty() ||
+        wav < 0 || (unsigned)wav >= ctx.inf.wave.wave.size()
+    ) return {};
+
+    const auto &wv = ctx.inf.wave.wave[wav];
+    if (wv.strmbeg < 0 || (unsigned)wv.strmbeg >= ctx.body_size) return {};
+
+    //16bit PCM is read per sample, everything else per byte
+    unsigned siz = std::max(wv.strmsize, 0);
+    if (wv.codec == SGXD_CODEC_PCM16LE || wv.codec == SGXD_CODEC_PCM16BE) siz *= 2;
+    siz = std::min(siz, ctx.body_size - wv.strmbeg);
+
+    std::vector<unsigned char> dat(siz);
+    TRACE_STEP(ctx.debug, "        Read %u bytes at 0x%08X from %s\n", siz, ctx.body_offs + wv.strmbeg, ctx.body.c_str());
+    if (!getFileRange(ctx.body.c_str(), ctx.body_offs + wv.strmbeg, dat.data(), siz)) {
+        fprintf(stderr, "Unable to open %s\n", ctx.body.c_str());
+        return {};
+    }
+    dat.resize(siz);
+
+    //Decode through a context holding just this waveform
+    sgxdctx tmp {};
+    tmp.debug = ctx.debug;
+    tmp.jobs = 1;
+    tmp.dat_beg = dat.data();
+    tmp.dat_end = dat.data() + dat.size();
+    tmp.inf.wave.wave.push_back(wv);
+    tmp.inf.wave.wave[0].strmbeg = 0;
+    tmp.inf.wave.wave[0].pcm.clear();
+    tmp.inf.wave.wave[0].is_dec = false;
+
+    return waveToWave(tmp, 0);
+}
+
+///Reads specified waveform from body file of global SGXD info and packs it into waveform data
+std::vector<unsigned char> probeWave(const int &wav) { return probeWave(sgd_ctx, wav); }
+
 ///Extracts variable waveform definitions into string
-std::string extractWave() {
-    if (sgd_debug) fprintf(stderr, "    Extract WAVE info\n");
+std::string extractWave(sgxdctx &ctx) {
+    TRACE_STEP(ctx.debug, "    Extract WAVE info\n");
     
     std::string out;
     auto set_fstr = [&out]<typename... T>(const char *in, T&&... args) -> void {
@@ -290,10 +382,10 @@ std::string extractWave() {
         out.resize(s1 + s0 - 1); snprintf(out.data() + s1, s0, in, args...);
     };
 
-    set_fstr("Global Flags: %s\n", std::bitset<32>(sgd_inf.wave.flag).to_string().c_str());
+    set_fstr("Global Flags: %s\n", std::bitset<32>(ctx.inf.wave.flag).to_string().c_str());
     set_fstr("Waveforms:\n");
-    for (const auto &w : sgd_inf.wave.wave) {
-        set_fstr("    Waveform: %d\n", &w - sgd_inf.wave.wave.data());
+    for (const auto &w : ctx.inf.wave.wave) {
+        set_fstr("    Waveform: %d\n", &w - ctx.inf.wave.wave.data());
         set_fstr("        Waveform Flags: %s\n", std::bitset<32>(w.flag).to_string().c_str());
         set_fstr("        Name: %s\n", (!w.name.empty()) ? w.name.c_str() : "(none)");
         set_fstr("        Channels: %d\n", w.chns);
@@ -311,3 +403,6 @@ std::string extractWave() {
 
     return out;
 }
+
+///Extracts variable waveform definitions from global SGXD info into string
+std::string extractWave() { return extractWave(sgd_ctx); }
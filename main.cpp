@@ -4,17 +4,28 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
 #include <string>
+#include <vector>
 #define SOUNDBANKSGXD_IMPLEMENTATION
 #define PROGRAMME_IDENTIFIER "lbrt2mid v8.0"
+#include "lrt/convcache.hpp"
+#include "lrt/directory.hpp"
+#include "lrt/filequeue.hpp"
+#include "lrt/parallel.hpp"
+#include "lrt/trace.hpp"
 #include "lrt/lrt_func.hpp"
+#include "lrt/sgxd_const.hpp"
 #include "lrt/sgxd_func.hpp"
 #include "playmidi/playmidi_func.hpp"
 #include "printpause.hpp"
 
 
 void printOpt(const char *pName) {
-    fprintf(stderr, "Usage: %s [-hdcp] [<infile.sf2>] [<infile(s).lrt/mid>]\n\n", pName);
+    fprintf(stderr, "Usage: %s [-hdcprise] [-j N] [-n N] [-w N] [-q G:S] [-k <cachefile>] [-a <outfile.tar>] [<infile.sf2>] [<infile(s).lrt/mid>]\n\n", pName);
     fprintf(stderr, "Options:\n");
     fprintf(stderr, "   -h          Prints this message\n");
     fprintf(stderr, "   -d          Toggles debug mode\n");
@@ -22,19 +33,244 @@ void printOpt(const char *pName) {
     fprintf(stderr, "                   Additionally converts MIDI's to CSV's\n");
     fprintf(stderr, "   -p          Activates playback mode\n");
     fprintf(stderr, "                   Uses most recent SF2 and all (converted) MIDI's\n");
+    fprintf(stderr, "   -r          Activates request playback, used with playback mode\n");
+    fprintf(stderr, "                   Following SGD's get their request sequences run\n");
+    fprintf(stderr, "                   directly against their own SF2 after the MIDI's\n");
+    fprintf(stderr, "   -n N        Seeds random request operands with N\n");
+    fprintf(stderr, "                   Sequences pick the same values every run, 0 by default\n");
+    fprintf(stderr, "   -j N        Activates batch mode with N workers\n");
+    fprintf(stderr, "                   Following inputs may be files, folders or manifests\n");
+    fprintf(stderr, "                   (one path per line) and are converted in parallel\n");
+    fprintf(stderr, "   -a FILE     Activates archive mode\n");
+    fprintf(stderr, "                   Writes all extracted files into one tar archive\n");
+    fprintf(stderr, "                   with a FILE.toc listing offset, size and name\n");
+    fprintf(stderr, "   -k FILE     Activates cache mode, implies batch mode\n");
+    fprintf(stderr, "                   Skips inputs unchanged since the last run and doesn't\n");
+    fprintf(stderr, "                   rewrite identical outputs, hashes are kept in FILE\n");
+    fprintf(stderr, "                   (ignored in archive mode)\n");
+    fprintf(stderr, "   -i          Activates probe mode\n");
+    fprintf(stderr, "                   Prints metadata from LRT, SGD and SGH headers only\n");
+    fprintf(stderr, "   -w N        Extracts waveform N in probe mode\n");
+    fprintf(stderr, "                   Reads just its stream from the SGB (or SGD)\n");
+    fprintf(stderr, "   -q G:S      Extracts sequence S of group G in probe mode\n");
+    fprintf(stderr, "                   Converts just it and its sub-sequences\n");
+    fprintf(stderr, "   -s          Activates streaming mode\n");
+    fprintf(stderr, "                   Converts LRT's while reading them, memory doesn't grow\n");
+    fprintf(stderr, "                   with length; - reads concatenated LRT's from stdin\n");
+    fprintf(stderr, "                   (can't be used with -a, -e, -j or -k)\n");
+    fprintf(stderr, "   -e          Activates event cache mode\n");
+    fprintf(stderr, "                   Following .mid get a .mev cache, used by playback\n");
+    fprintf(stderr, "                   instead of reading the MIDI again\n");
+}
+
+///Batch Conversion Job
+struct batchjob {
+    std::string file0, file1, sf2, out; //out prefixes every output of job
+    bool isLRT;
+    int ret;
+};
+
+///Gets extension of file path, if any
+std::string getExt(const std::string &file) {
+    auto p0 = file.find_last_of("\\/"), p1 = file.find_last_of('.');
+    if (p1 == std::string::npos || (p0 != std::string::npos && p1 < p0)) return "";
+    return file.substr(p1 + 1);
+}
+
+///Converts files, folders and manifests on a pool of workers
+///  Returns number of jobs that failed
+int convertBatch(const std::vector<std::string> &in, const unsigned jobs, const bool debug, filequeue &queue, convcache *cache = 0) {
+    std::vector<std::string> fles;
+    std::vector<batchjob> bat;
+    std::set<std::string> seen;
+    std::map<std::string, int> pairs;
+    int ret = 0, same = 0;
+
+    auto is_job = [](const std::string &ext) -> bool {
+        return
+            ext.find("lrt") != std::string::npos ||
+            ext.find("sgd") != std::string::npos ||
+            ext.find("sgh") != std::string::npos ||
+            ext.find("sgb") != std::string::npos;
+    };
+    auto set_fle = [&](auto&& self, std::string in, const bool is_top) -> void {
+        in.erase(std::remove(in.begin(), in.end(), '\"'), in.end());
+        while (!in.empty() && (in.back() == '\r' || in.back() == ' ' || in.back() == '\t')) in.pop_back();
+        if (in.empty() || in[0] == '#') return;
+
+        if (isFolder(in.c_str())) {
+            std::vector<std::string> tmp;
+            if (!getFolderFiles(in.c_str(), tmp)) fprintf(stderr, "Unable to open %s\n", in.c_str());
+            std::sort(tmp.begin(), tmp.end());
+            for (const auto &t : tmp) {
+                if (is_job(getExt(t)) && seen.insert(t).second) fles.push_back(t);
+            }
+        }
+        else if (is_job(getExt(in))) {
+            if (seen.insert(in).second) fles.push_back(in);
+        }
+        else if (is_top) {
+            //Treat anything else as a manifest of paths
+            const unsigned char *data = 0;
+            unsigned size = 0;
+
+            if (!mapFileData(in.c_str(), data, size)) {
+                fprintf(stderr, "Unable to open %s\n", in.c_str());
+                return;
+            }
+            std::string lst((const char*)data, size);
+            unmapFileData(data, size);
+
+            for (size_t p0 = 0, p1 = 0; p0 < lst.size(); p0 = p1 + 1) {
+                p1 = lst.find('\n', p0); if (p1 == std::string::npos) p1 = lst.size();
+                self(self, lst.substr(p0, p1 - p0), false);
+            }
+        }
+        else if (debug) fprintf(stderr, "Skipping unknown file %s\n", in.c_str());
+    };
+    auto get_hsh = [](const batchjob &job, unsigned long long &hash) -> int {
+        //Options that change outputs are part of the hash
+        hash = (job.isLRT) ? (lrt_midicsv | lrt_mev << 1) : sgd_ctx.seed;
+        for (const auto &f : {job.file0, job.file1}) {
+            const unsigned char *data = 0;
+            unsigned size = 0;
+
+            if (f.empty()) continue;
+            if (!mapFileData(f.c_str(), data, size)) return 0;
+            hash = getHash(data, size, hash);
+            unmapFileData(data, size);
+        }
+        return 1;
+    };
+
+    for (const auto &i : in) set_fle(set_fle, i, true);
+
+    //Set jobs, keeping header and body pairs together
+    for (const auto &f : fles) {
+        const auto ext = getExt(f);
+        const auto stm = f.substr(0, f.size() - ext.size());
+
+        if (ext.find("lrt") != std::string::npos) bat.push_back({f, "", "", "", true, 0});
+        else if (ext.find("sgd") != std::string::npos) bat.push_back({f, "", "", "", false, 0});
+        else {
+            if (pairs.find(stm) == pairs.end()) {
+                pairs[stm] = bat.size();
+                bat.push_back({"", "", "", "", false, 0});
+            }
+            if (ext.find("sgh") != std::string::npos) bat[pairs[stm]].file0 = f;
+            else bat[pairs[stm]].file1 = f;
+        }
+    }
+
+    fprintf(stdout, "Batch converting %zu job(s) with %u worker(s)\n", bat.size(), (jobs) ? jobs : getJobs());
+
+    parallelFor(jobs, bat.size(), [&bat, &debug, &queue, &cache, &get_hsh](const unsigned j) -> void {
+        auto &job = bat[j];
+        const std::string key = job.file0 + "\n" + job.file1;
+        unsigned long long hash = 0;
+
+        if (cache && get_hsh(job, hash) && cache->isFresh(key, hash)) {
+            job.ret = 2;
+            for (const auto &o : cache->getOutputs(key)) if (getExt(o) == "sf2") job.sf2 = o;
+            return;
+        }
+        if (cache) cache->setJob(key, hash);
+
+        if (job.isLRT) {
+            lbrtctx ctx;
+            ctx.debug = debug;
+            ctx.midicsv = lrt_midicsv;
+            ctx.mev = lrt_mev;
+            ctx.jobs = 1;
+            ctx.queue = &queue;
+            unpackLrt(ctx, job.file0.c_str());
+            job.ret = extractLrt(ctx);
+            job.out = ctx.inf.path + ctx.inf.name;
+        }
+        else if (!job.file0.empty()) {
+            sgxdctx ctx;
+            ctx.debug = debug;
+            ctx.jobs = 1;
+            ctx.seed = sgd_ctx.seed;
+            ctx.queue = &queue;
+            unpackSgxd(ctx, job.file0.c_str(), (job.file1.empty()) ? 0 : job.file1.c_str());
+
+            std::string pth = job.file0;
+            pth = pth.substr(0, pth.find_last_of("\\/") + 1);
+            job.ret = extractSgxd(ctx, pth.c_str());
+            job.sf2 = pth + "@" + ctx.inf.file + "/rgnd/" + ctx.inf.file + ".sf2";
+            job.out = pth + "@" + ctx.inf.file + "/";
+        }
+        else fprintf(stderr, "Missing header file for %s\n", job.file1.c_str());
+
+        if (cache) cache->endJob(job.ret);
+    });
+
+    //Wait for pending writes before summarising, jobs whose files failed did too
+    if (!queue.flush()) {
+        for (const auto &e : queue.getErrors()) {
+            for (auto &job : bat) {
+                if (job.out.empty() || e.compare(0, job.out.size(), job.out)) continue;
+                if (job.isLRT && e.size() > job.out.size() && e[job.out.size()] != '.' && e[job.out.size()] != '_') continue;
+                job.ret = 0;
+            }
+        }
+    }
+    flushTrace();
+
+    //Print summary
+    fprintf(stdout, "\nBatch summary\n");
+    for (const auto &job : bat) {
+        std::string nam = (!job.file0.empty()) ? job.file0 : job.file1;
+        if (!job.file0.empty() && !job.file1.empty()) nam += " + " + job.file1;
+
+        fprintf(stdout, "    %s  %s\n", (job.ret == 2) ? "SAME" : (job.ret) ? "OK  " : "FAIL", nam.c_str());
+        if (job.ret) ret += 1;
+        if (job.ret == 2) same += 1;
+
+        if (job.isLRT) {
+            auto mid = job.file0;
+            a_tml.mid.push_back(mid.replace(mid.rfind(getExt(mid)), 4, "mid"));
+        }
+        else if (!job.sf2.empty()) a_tml.sf2 = job.sf2;
+    }
+    fprintf(stdout, "Converted %d of %zu job(s)", ret, bat.size());
+    if (cache) fprintf(stdout, ", %d unchanged", same);
+    fprintf(stdout, "\n");
+
+    return bat.size() - ret;
 }
 
 int main(int argc, char *argv[]) {
-    bool debug = false, play = false;
+    bool debug = false, play = false, probe = false, arc = false, stream = false, reqs = false;
+    int ret = 0;
+    unsigned jobs = 0;
+    int wave = -1, grp = -1, seq = -1;
+    std::vector<std::string> bat;
+    filequeue queue;
+    convcache cache;
+    std::string cfle;
 
     std::string prgm = argv[0];
     prgm.erase(std::remove(prgm.begin(), prgm.end(), '\"'), prgm.end());
     prgm = prgm.substr(prgm.find_last_of("\\/") + 1);
     prgm = prgm.substr(0, prgm.find_last_of('.'));
 
+    //Streaming writes MIDI straight to its folder, never whole or through the queue
+    auto is_arg = [&argc, &argv](const char *opt) -> bool {
+        for (int i = 1; i < argc; ++i) if (!strcmp(argv[i], opt)) return true;
+        return false;
+    };
+    if (is_arg("-s") && (is_arg("-a") || is_arg("-e") || is_arg("-j") || is_arg("-k"))) {
+        fprintf(stderr, "Streaming mode can't be used with -a, -e, -j or -k\n");
+        return 1;
+    }
+
     if (argc < 2) { printOpt(prgm.c_str()); }
     else {
         std::string sgh, sgb, tfle;
+        lrt_ctx.queue = &queue;
+        sgd_ctx.queue = &queue;
         auto get_sgd = [&](const char *s0, const char *s1 = 0) -> void {
             sgd_debug = debug;
             unpackSgxd(s0, s1);
@@ -45,12 +281,87 @@ int main(int argc, char *argv[]) {
             
             a_tml.sf2 = pth + "@" + sgd_inf.file + "/rgnd/" + sgd_inf.file + ".sf2";
             
+            //Request sequences keep what playback needs of their bank, the next SGD replaces it
+            if (reqs) {
+                tmlseqd bnk;
+                bnk.sf2 = a_tml.sf2;
+                bnk.seqd.resize(sgd_inf.seqd.seqd.size());
+                for (int g = 0; g < (int)sgd_inf.seqd.seqd.size(); ++g) {
+                    bnk.seqd[g].resize(sgd_inf.seqd.seqd[g].seq.size());
+                    for (int s = 0; s < (int)sgd_inf.seqd.seqd[g].seq.size(); ++s) {
+                        const auto &sq = sgd_inf.seqd.seqd[g].seq[s];
+                        if (sq.empty() || sq.fmt != SEQD_REQUEST) continue;
+                        convertSeqd(g, s);
+                        bnk.seqd[g][s] = {sq.name, sq.div, sq.prog, {sgd_ctx.seed, sgd_inf.file, g, s}};
+                        bnk.seq.push_back({g, s});
+                    }
+                }
+                for (const auto &rgn : sgd_inf.rgnd.rgnd) {
+                    auto &tns = bnk.rgnd.emplace_back();
+                    for (const auto &ton : rgn) tns.push_back({ton.notelow, ton.notehigh, ton.bnkid});
+                }
+                if (!bnk.seq.empty()) a_tml.seqd.push_back(std::move(bnk));
+            }
+            
             tfle.clear(); sgh.clear(); sgb.clear();
         };
+        auto get_seq = [&](const char *s0) -> void {
+            //Sequences sit in the header, only the one asked for is converted
+            std::string pth = s0, nam, ext;
+            const seqdseq *sq = 0;
+            pth = pth.substr(0, pth.find_last_of("\\/") + 1) + "@" + sgd_inf.file;
+            if ((unsigned)grp < sgd_inf.seqd.seqd.size() && (unsigned)seq < sgd_inf.seqd.seqd[grp].seq.size()) {
+                sq = &sgd_inf.seqd.seqd[grp].seq[seq];
+            }
+            if (sq && !sq->name.empty()) nam = sq->name;
+            else {
+                nam.resize(snprintf(nullptr, 0, "seq_%03d_%03d", grp, seq));
+                snprintf(nam.data(), nam.size() + 1, "seq_%03d_%03d", grp, seq);
+            }
+            nam = pth + "/seqd/" + nam.substr(0, nam.find_first_of("."));
+            ext = (sq && sq->fmt > SEQD_RAWMIDI) ? ".unk" : ".mid";
+
+            auto mid = seqdToMidi(grp, seq);
+            if (mid.empty()) fprintf(stderr, "Unable to convert sequence %d of group %d\n", seq, grp);
+            else if (
+                !createFolder(&queue, (pth + "/").c_str()) ||
+                !createFolder(&queue, (pth + "/seqd/").c_str()) ||
+                !createFile(&queue, (nam + ext).c_str(), std::move(mid))
+            ) fprintf(stderr, "Unable to write %s\n", (nam + ext).c_str());
+            else fprintf(stdout, "Extracted %s\n", (nam + ext).c_str());
+        };
+        auto get_prb = [&](const char *s0, const char *s1 = 0) -> void {
+            sgd_debug = debug;
+            unpackSgxdHead(s0, s1);
+            fprintf(stdout, "%s", probeSgxd().c_str());
+            if (sgd_inf.empty()) return;
+            if (grp >= 0) get_seq(s0);
+            if (wave < 0) return;
+
+            std::string pth = s0, nam;
+            pth = pth.substr(0, pth.find_last_of("\\/") + 1) + "@" + sgd_inf.file;
+            if ((unsigned)wave < sgd_inf.wave.wave.size() && !sgd_inf.wave.wave[wave].name.empty()) nam = sgd_inf.wave.wave[wave].name;
+            else {
+                nam.resize(snprintf(nullptr, 0, "smpl_%03d", wave));
+                snprintf(nam.data(), nam.size() + 1, "smpl_%03d", wave);
+            }
+            nam = pth + "/wave/" + nam + ".wav";
+
+            auto wav = probeWave(wave);
+            if (wav.empty()) fprintf(stderr, "Unable to read waveform %d\n", wave);
+            else if (
+                !createFolder(&queue, (pth + "/").c_str()) ||
+                !createFolder(&queue, (pth + "/wave/").c_str()) ||
+                !createFile(&queue, nam.c_str(), std::move(wav))
+            ) fprintf(stderr, "Unable to write %s\n", nam.c_str());
+            else fprintf(stdout, "Extracted %s\n", nam.c_str());
+        };
         
         for (int i = 1; i < argc; ++i) {
             std::string ext, fle, rot;
 
+            //Trace lines of previous file go out first
+            flushTrace();
             tfle = argv[i];
             tfle.erase(std::remove(tfle.begin(), tfle.end(), '\"'), tfle.end());
 
@@ -58,6 +369,74 @@ int main(int argc, char *argv[]) {
             else if (tfle == "-d") { debug = !debug; continue; }
             else if (tfle == "-c") { lrt_midicsv = true; continue; }
             else if (tfle == "-p") { play = true; continue; }
+            else if (tfle == "-r") { reqs = true; continue; }
+            else if (tfle == "-i") { probe = true; continue; }
+            else if (tfle == "-s") { stream = true; continue; }
+            else if (tfle == "-e") { lrt_mev = true; continue; }
+            else if (tfle == "-") {
+                if (!stream) { fprintf(stderr, "Standard input needs streaming mode\n"); continue; }
+                lrt_debug = debug;
+                streamLrt("-");
+                continue;
+            }
+            else if (tfle == "-w") {
+                if (i + 1 < argc) wave = atoi(argv[++i]);
+                probe = true; continue;
+            }
+            else if (tfle == "-q") {
+                if (i + 1 < argc) {
+                    char *end = 0;
+                    grp = strtol(argv[++i], &end, 10);
+                    seq = (*end == ':') ? strtol(end + 1, 0, 10) : -1;
+                }
+                if (grp < 0 || seq < 0) { fprintf(stderr, "Sequence has to be given as G:S\n"); grp = seq = -1; }
+                else probe = true;
+                continue;
+            }
+            else if (tfle == "-a") {
+                if (i + 1 >= argc) fprintf(stderr, "Archive has to be given as -a <outfile.tar>\n");
+                else if (!queue.setArchive(argv[++i])) fprintf(stderr, "Unable to create %s\n", argv[i]);
+                else arc = true;
+                continue;
+            }
+            else if (tfle == "-n") {
+                if (i + 1 < argc) sgd_ctx.seed = strtoull(argv[++i], 0, 0);
+                continue;
+            }
+            else if (tfle == "-k") {
+                if (i + 1 < argc) cfle = argv[++i];
+                if (!jobs) jobs = getJobs();
+                continue;
+            }
+            else if (tfle == "-j") {
+                if (i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9') jobs = atoi(argv[++i]);
+                if (!jobs) jobs = getJobs();
+                continue;
+            }
+
+            if (probe) {
+                //Headers only, body of SGH is its SGB
+                ext = getExt(tfle);
+                if (ext.find("lrt") != std::string::npos) {
+                    lrt_debug = debug;
+                    unpackLrtHead(tfle.c_str());
+                    fprintf(stdout, "%s", probeLrt().c_str());
+                }
+                else if (ext.find("sgd") != std::string::npos) get_prb(tfle.c_str());
+                else if (ext.find("sgh") != std::string::npos) {
+                    get_prb(tfle.c_str(), (tfle.substr(0, tfle.size() - ext.size()) + "sgb").c_str());
+                }
+                else if (debug) fprintf(stderr, "Skipping %s in probe mode\n", tfle.c_str());
+                continue;
+            }
+
+            if (jobs) {
+                //Keep playback inputs as usual, defer everything else to batch
+                ext = getExt(tfle);
+                if (ext.find("sf2") != std::string::npos) { a_tml.sf2 = tfle; continue; }
+                else if (ext.find("mid") != std::string::npos) { a_tml.mid.push_back(tfle); continue; }
+                bat.push_back(tfle); continue;
+            }
 
             if (debug) fprintf(stderr, "\n");
             if (tfle.rfind(".") == std::string::npos) tfle += ".unknown";
@@ -83,8 +462,11 @@ int main(int argc, char *argv[]) {
 
                 if (isLRT) {
                     lrt_debug = debug;
-                    unpackLrt(tfle.c_str());
-                    extractLrt();
+                    if (stream) streamLrt(tfle.c_str());
+                    else {
+                        unpackLrt(tfle.c_str());
+                        extractLrt();
+                    }
                     a_tml.mid.push_back(tfle.replace(tfle.rfind(ext), 4, "mid"));
                 }
                 else a_tml.mid.push_back(tfle);
@@ -116,15 +498,40 @@ int main(int argc, char *argv[]) {
             else if (debug) fprintf(stderr, "This is an unknown file\n");
         }
 
+        flushTrace();
+
+        //Archives always get every file, so no cache there
+        if (!cfle.empty() && !arc) {
+            if (!cache.load(cfle, PROGRAMME_IDENTIFIER) && debug) fprintf(stderr, "Starting new cache %s\n", cfle.c_str());
+            queue.setCache(&cache);
+        }
+        else cfle.clear();
+
+        if (!bat.empty()) {
+            if (debug) fprintf(stderr, "\n");
+            if (convertBatch(bat, jobs, debug, queue, (!cfle.empty()) ? &cache : 0)) ret = 1;
+        }
+
+        //Finish writing before playback
+        queue.setArchive("");
+        if (!queue.flush()) {
+            const auto err = queue.getErrors();
+            ret = 1;
+            fprintf(stderr, "\nUnable to write %zu file(s)\n", err.size());
+            for (const auto &e : err) fprintf(stderr, "    %s\n", e.c_str());
+        }
+        if (!cfle.empty() && !cache.save(queue.getErrors())) fprintf(stderr, "Unable to write %s\n", cfle.c_str());
+
         if (play) {
             if (debug) fprintf(stderr, "\n");
             playmidi_debug = debug;
             playSequence();
         }
+        flushTrace();
     }
 
     fprintf(stdout, "\nEnd of thing\n");
 
-    sleep(10);
-    return 0;
+    if (!jobs) sleep(10);
+    return ret;
 }
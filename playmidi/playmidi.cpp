@@ -1,5 +1,10 @@
+#include <algorithm>
 #include <cstdio>
+#include <deque>
 #include <string>
+#include <vector>
+#include "../lrt/trace.hpp"           //Before minisdl_audio, which redefines snprintf
+#include "../lrt/convcache.hpp"       //Same
 #include "tsf/minisdl_audio.h"
 #define TSF_IMPLEMENTATION
 #define TML_IMPLEMENTATION
@@ -7,10 +12,344 @@
 #include "tsf/tml.h"
 #include "playmidi_func.hpp"
 #include "playmidi_types.hpp"
+#include "../lrt/directory.hpp"
+#include "../lrt/sgxd_const.hpp"
+#include "../lrt/midi/midi_const.hpp"
+#include "../lrt/midi/midi_types.hpp"
+#include "../lrt/midi/midi_func.hpp"
 
 static tsf *g_TinySoundFont = NULL;                         // Pointer to Soundfont
 static tml_message *g_MidiMessage = NULL;                   // Pointer to Midi playback state
 static double g_Msec = 0.0;                                 // Pointer to Total playback time
+static std::deque<tml_message> g_MidiQueue;                 // Messages read ahead of playback
+static tracering *g_TraceRing = NULL;                       // Trace ring of audio thread, made ahead
+
+///SEQD Playback Thread
+///  One running request sequence, sub-sequences get threads of their own
+struct seqdthrd {
+    static const unsigned LOOPS = 8, IDS = 32;
+
+    int sq = -1;                                            //Sequence in playback list, -1 if free
+    int up = -1;                                            //Thread that started it
+    unsigned up_gen = 0;                                    //Start of that thread, so reused threads miss
+    unsigned gen = 0;                                       //Bumped on every start, so stale IDs miss
+    unsigned pc = 0;
+    seqdrng rng;                                            //Same picks as the converted sequence
+    double wake = 0.0;                                      //Time of next request in msec
+    unsigned loops = 0;
+    struct { unsigned pc; int cnt; } loop[LOOPS];
+    unsigned idn = 0;
+    struct { int id, ch, nte, sub; unsigned gen; } ids[IDS];  //Notes (ch >= 0) and sub-sequences by ID
+};
+
+///SEQD Playback Sequence
+struct seqdplay {
+    const tmlseqdseq *seq = 0;
+    double tck2msc = 0.0;
+    seqdrng rng;
+    std::vector<std::pair<int, unsigned>> lbl;              //Address label times and their requests
+};
+
+///SEQD Virtual Machine
+///  Runs request sequences against the synthesiser, only the audio thread touches it while running
+struct seqdvm {
+    static const int THREADS = 32, REGS = 64;
+    static const unsigned STEPS = 4096;
+
+    std::vector<seqdplay> play;
+    std::vector<std::vector<std::array<int, 3>>> chn;       //Lowest note, highest note and channel of tones by region
+    std::vector<std::vector<int>> ids;                      //Playback list index by group and sequence, -1 if none
+    seqdthrd thrd[THREADS];
+    int reg[REGS] {};
+    int top = -1;                                           //Sequence played, in playback list
+    double tail = -1.0;                                     //Time to end at once every thread is done
+};
+
+static seqdvm *g_SeqdVm = NULL;                             // Pointer to SEQD playback state
+
+///Gets SEQD request operand, registers read as they are now
+static int getSeqdArg(seqdvm &vm, seqdrng &rng, const seqdarg *&in) {
+    const auto &a = *in++;
+    if (a.typ == SEQD_SYSREG || a.typ == SEQD_REG) return (a.val >= 0 && a.val < seqdvm::REGS) ? vm.reg[a.val] : 0;
+    if (a.typ != SEQD_RANDOM) return a.val;
+
+    const int b0 = getSeqdArg(vm, rng, in), b1 = getSeqdArg(vm, rng, in), b2 = getSeqdArg(vm, rng, in);
+    return rng.getPick(b0, b1, b2);
+}
+
+///Sets up SEQD virtual machine for request sequences of a bank, and channels of its soundfont
+///  Address labels follow every wait, as in the asm listing
+///  Every region has a channel like the converted MIDI, banks past its first get extra ones
+static void setSeqdVm(seqdvm &vm, const tmlseqd &bnk, tsf *sf2) {
+    vm.play.clear();
+    vm.ids.assign(bnk.seqd.size(), {});
+    vm.chn.assign(bnk.rgnd.size(), {});
+
+    int ext = bnk.rgnd.size();
+    for (int r = 0; r < (int)bnk.rgnd.size(); ++r) {
+        std::vector<std::array<int, 2>> bnks;
+        for (const auto &ton : bnk.rgnd[r]) {
+            int ch = -1;
+            for (const auto &b : bnks) if (b[0] == ton.bnkid) ch = b[1];
+            if (ch < 0) {
+                ch = (bnks.empty()) ? r : ext++;
+                bnks.push_back({ton.bnkid, ch});
+                if (sf2) tsf_channel_set_bank_preset(sf2, ch, ton.bnkid, r);
+            }
+            vm.chn[r].push_back({ton.notelow, ton.notehigh, ch});
+        }
+    }
+
+    for (const auto &g : bnk.seqd) {
+        auto &ids = vm.ids[&g - bnk.seqd.data()];
+        ids.assign(g.size(), -1);
+
+        for (const auto &s : g) {
+            if (s.prog.empty()) continue;
+            seqdplay ply;
+            ply.seq = &s;
+            ply.tck2msc = 500000 / (1000.0 * ((s.div > 0) ? s.div : 480));
+            ply.rng = s.rng;
+
+            //Waits that aren't constant count as their least
+            int tim = 0;
+            ply.lbl.push_back({0, 0});
+            for (const auto &ins : s.prog.inst) {
+                if (ins.op != SEQD_WAIT || !ins.argc) continue;
+                const auto &a = s.prog.arg[ins.argi + (s.prog.arg[ins.argi].typ == SEQD_RANDOM)];
+                tim += (a.typ == SEQD_POSITIVE) ? a.val : 0;
+                if (ply.lbl.back().first < tim) ply.lbl.push_back({tim, (unsigned)(&ins - s.prog.inst.data()) + 1});
+            }
+
+            ids[&s - g.data()] = vm.play.size();
+            vm.play.push_back(std::move(ply));
+        }
+    }
+}
+
+///Starts sequence on a free thread of SEQD virtual machine, -1 if none is free
+static int setSeqdStart(seqdvm &vm, const int sq, const int up, const double now) {
+    if (sq < 0) return -1;
+    for (auto &t : vm.thrd) {
+        if (t.sq >= 0) continue;
+        const unsigned gen = t.gen + 1;
+        t = {};
+        t.sq = sq; t.up = up; t.gen = gen; t.wake = now;
+        t.up_gen = (up >= 0) ? vm.thrd[up].gen : 0;
+        t.rng = vm.play[sq].rng;
+        return &t - vm.thrd;
+    }
+    return -1;
+}
+
+///Starts sequence from playback list alone on SEQD virtual machine, registers cleared
+static void setSeqdPlay(seqdvm &vm, const int sq) {
+    for (auto &t : vm.thrd) t = {};
+    std::fill(vm.reg, vm.reg + seqdvm::REGS, 0);
+    vm.top = sq;
+    vm.tail = -1.0;
+    setSeqdStart(vm, sq, -1, 0.0);
+}
+
+///Stops thread of SEQD virtual machine and what it started, or just the latter, notes are released
+///  Threads that already ended still release theirs
+///  Sub-sequences are found by the thread that started them, even ones no longer known by ID
+static void setSeqdStop(seqdvm &vm, const int th, const bool is_subs = false) {
+    auto &t = vm.thrd[th];
+
+    if (!is_subs) {
+        t.sq = -1;
+        for (unsigned i = 0; i < t.idn; ++i) {
+            const auto &d = t.ids[i];
+            if (d.ch >= 0) tsf_channel_note_off(g_TinySoundFont, d.ch, d.nte);
+        }
+        //Released once, later stops would cut notes others started since
+        t.idn = 0;
+    }
+    for (int c = 0; c < seqdvm::THREADS; ++c) {
+        const auto &u = vm.thrd[c];
+        if (c != th && u.up == th && u.up_gen == t.gen) setSeqdStop(vm, c);
+    }
+}
+
+///Runs threads of SEQD virtual machine up to now, 0 once everything has ended
+static int runSeqd(seqdvm &vm, const double now) {
+    bool is_run = false;
+
+    for (int th = 0; th < seqdvm::THREADS; ++th) {
+        auto &t = vm.thrd[th];
+        if (t.sq < 0) continue;
+        is_run = true;
+        if (t.wake > now) continue;
+
+        const auto &ply = vm.play[t.sq];
+        const auto &prg = ply.seq->prog;
+
+        auto get_id = [&t](const int id) -> int {
+            for (unsigned i = 0; i < t.idn; ++i) if (t.ids[i].id == id) return i;
+            return -1;
+        };
+        auto set_id = [&t, &get_id](const int id) -> int {
+            int i = get_id(id);
+            if (i < 0 && t.idn < seqdthrd::IDS) i = t.idn++;
+            if (i >= 0) t.ids[i].id = id;
+            return i;
+        };
+        auto set_jump = [&t, &ply](const int tim) -> void {
+            for (const auto &l : ply.lbl) {
+                if (l.first == tim) { t.pc = l.second; return; }
+            }
+            TRACE_FIELD(playmidi_debug, "    No address at time %d\n", tim);
+        };
+
+        for (unsigned stp = 0; t.sq >= 0 && t.wake <= now; ++stp) {
+            if (t.pc >= prg.inst.size()) { t.sq = -1; break; }
+            //Requests that never wait get picked up on the next block
+            if (stp >= seqdvm::STEPS) { t.wake = now + 1.0; break; }
+
+            const auto &ins = prg.inst[t.pc++];
+            const seqdarg *arg = prg.arg.data() + ins.argi;
+            int v[seqdinst::ARGS] {};
+            for (unsigned a = 0; a < ins.argc; ++a) v[a] = getSeqdArg(vm, t.rng, arg);
+
+            switch(ins.op) {
+                case SEQD_SUB_START: {
+                    const int &id = v[0], &grp = v[1], &seq = v[2];
+                    TRACE_FIELD(playmidi_debug, "    Start sequence %d from group %d\n", seq, grp);
+                    if ((unsigned)grp >= vm.ids.size() || (unsigned)seq >= vm.ids[grp].size()) break;
+
+                    const int sub = setSeqdStart(vm, vm.ids[grp][seq], th, t.wake);
+                    const int i = (sub >= 0) ? set_id(id) : -1;
+                    if (i >= 0) { t.ids[i].ch = -1; t.ids[i].sub = sub; t.ids[i].gen = vm.thrd[sub].gen; }
+                    break;
+                }
+                case SEQD_SUB_STOP:
+                case SEQD_SUB_STOPREL: {
+                    const int i = get_id(v[0]);
+                    TRACE_FIELD(playmidi_debug, "    Stop sequence %d\n", v[0]);
+                    if (i >= 0 && t.ids[i].ch < 0 && vm.thrd[t.ids[i].sub].gen == t.ids[i].gen) setSeqdStop(vm, t.ids[i].sub);
+                    break;
+                }
+                case SEQD_START: {
+                    const int &id = v[0], &prs = v[1], &nte = v[2], &vol = v[3];
+                    int ch = -1;
+                    if ((unsigned)prs < vm.chn.size()) {
+                        for (const auto &c : vm.chn[prs]) {
+                            if (nte >= c[0] && nte <= c[1]) { ch = c[2]; break; }
+                        }
+                    }
+                    TRACE_FIELD(playmidi_debug, "    Start note %d of region %d\n", nte, prs);
+                    if (ch < 0) break;
+
+                    //Channels already hold their preset
+                    tsf_channel_note_on(g_TinySoundFont, ch, nte & 0x7F, std::min(1.0f, vol / 4096.0f));
+                    const int i = set_id(id);
+                    if (i >= 0) { t.ids[i].ch = ch; t.ids[i].nte = nte & 0x7F; }
+                    break;
+                }
+                case SEQD_STOP:
+                case SEQD_STOPREL: {
+                    //Synthesiser only has released note offs, stopping all takes sub-sequences along
+                    const int &id = v[0], &glb = v[1];
+                    TRACE_FIELD(playmidi_debug, "    Stop note %d\n", id);
+                    for (unsigned i = 0; i < t.idn; ++i) {
+                        const auto &d = t.ids[i];
+                        if (d.ch >= 0 && (glb || d.id == id)) tsf_channel_note_off(g_TinySoundFont, d.ch, d.nte);
+                    }
+                    if (glb) setSeqdStop(vm, th, true);
+                    break;
+                }
+                case SEQD_SYSREG_INIT:
+                case SEQD_SYSREG_ADD:
+                case SEQD_SYSREG_MINUS:
+                case SEQD_SYSREG_MULT:
+                case SEQD_SYSREG_DIVI:
+                case SEQD_SYSREG_MODU:
+                case SEQD_SYSREG_AND:
+                case SEQD_SYSREG_OR:
+                case SEQD_SYSREG_XOR: {
+                    //Register gets both values put together, registers among them already read
+                    const int &typ = v[0], &vl0 = v[1], &vl1 = v[2];
+                    if (typ < 0 || typ >= seqdvm::REGS) break;
+                    auto &r = vm.reg[typ];
+                    switch(ins.op) {
+                        case SEQD_SYSREG_INIT:
+                        case SEQD_SYSREG_ADD:   r = vl0 + vl1; break;
+                        case SEQD_SYSREG_MINUS: r = vl0 - vl1; break;
+                        case SEQD_SYSREG_MULT:  r = vl0 * vl1; break;
+                        case SEQD_SYSREG_DIVI:  if (vl1) r = vl0 / vl1; break;
+                        case SEQD_SYSREG_MODU:  if (vl1) r = vl0 % vl1; break;
+                        case SEQD_SYSREG_AND:   r = vl0 & vl1; break;
+                        case SEQD_SYSREG_OR:    r = vl0 | vl1; break;
+                        case SEQD_SYSREG_XOR:   r = vl0 ^ vl1; break;
+                    }
+                    TRACE_FIELD(playmidi_debug, "    Set register %d to %d\n", typ, r);
+                    break;
+                }
+                case SEQD_WAIT:
+                    t.wake += v[0] * ply.tck2msc;
+                    break;
+                case SEQD_JUMP:
+                    set_jump(v[0]);
+                    break;
+                case SEQD_JUMPNEQ:
+                    if (v[0] != v[1]) set_jump(v[2]);
+                    break;
+                case SEQD_JUMP3:
+                    if (v[0] == v[1]) set_jump(v[2]);
+                    break;
+                case SEQD_JUMPGEQ:
+                    if (v[0] >= v[1]) set_jump(v[2]);
+                    break;
+                case SEQD_JUMPLES:
+                    if (v[0] < v[1]) set_jump(v[2]);
+                    break;
+                case SEQD_LOOPBEG:
+                    //Count of 0 loops forever
+                    if (t.loops < seqdthrd::LOOPS) t.loop[t.loops++] = {t.pc, v[0]};
+                    break;
+                case SEQD_LOOPEND: {
+                    if (!t.loops) break;
+                    auto &l = t.loop[t.loops - 1];
+                    if (l.cnt <= 0 || --l.cnt > 0) t.pc = l.pc;
+                    else t.loops -= 1;
+                    break;
+                }
+                case SEQD_LOOPBREAK: {
+                    //Guesstimate, leaves innermost loop if both values match
+                    if (!t.loops || v[0] != v[1]) break;
+                    t.loops -= 1;
+                    for (int dep = 0; t.pc < prg.inst.size(); ++t.pc) {
+                        const auto op = prg.inst[t.pc].op;
+                        if (op == SEQD_LOOPBEG) dep += 1;
+                        else if (op == SEQD_LOOPEND && !dep--) { t.pc += 1; break; }
+                    }
+                    break;
+                }
+                case SEQD_CALLMKR:
+                    TRACE_FIELD(playmidi_debug, "    Marker %d\n", v[0]);
+                    break;
+                case SEQD_PRINT:
+                    TRACE_FIELD(playmidi_debug, "    Print %d\n", v[0]);
+                    break;
+                case SEQD_EOR:
+                    t.sq = -1;
+                    break;
+                default:
+                    //Nothing to play for the rest yet
+                    TRACE_FIELD(playmidi_debug, "    Skip request 0x%02X\n", (unsigned char)ins.op);
+                    break;
+            }
+        }
+    }
+    if (is_run) return 1;
+
+    //Notes ring out for a while after every thread is done, as converted sequences do
+    if (vm.tail < 0) vm.tail = now + 8000 * ((vm.top >= 0) ? vm.play[vm.top].tck2msc : 1.0);
+    if (now < vm.tail) return 1;
+    tsf_note_off_all(g_TinySoundFont);
+    return 0;
+}
 
 ///Callback function called by audio thread
 static void AudioCallback(void *data, unsigned char *stream, int len) {
@@ -18,6 +357,9 @@ static void AudioCallback(void *data, unsigned char *stream, int len) {
 	int SampleBlock,
 		SampleCount = (len / (2 * sizeof(short))); //2 output channels
 
+	//Trace lines wait for the main thread in a ring made ahead, formatting or allocating here would stall audio
+	if constexpr (TRACE_LEVEL >= TRACE_LEVEL_FIELD) setTraceRing(g_TraceRing);
+
 	for (SampleBlock = TSF_RENDER_EFFECTSAMPLEBLOCK; SampleCount; SampleCount -= SampleBlock, stream += (SampleBlock * (2 * sizeof(short)))) {
 		//Process MIDI playback, then process TSF_RENDER_EFFECTSAMPLEBLOCK samples at once
 		if (SampleBlock > SampleCount) SampleBlock = SampleCount;
@@ -26,30 +368,30 @@ static void AudioCallback(void *data, unsigned char *stream, int len) {
 		for (g_Msec += SampleBlock * (1000.0 / 44100.0); g_MidiMessage && g_Msec >= g_MidiMessage->time; g_MidiMessage = g_MidiMessage->next) {
 			switch (g_MidiMessage->type) {
 				case TML_NOTE_OFF:				// Stop a note
-					if (playmidi_debug) fprintf(stderr, "    Stop Note\n");
+					TRACE_FIELD(playmidi_debug, "    Stop Note\n");
                     tsf_channel_note_off(g_TinySoundFont, g_MidiMessage->channel, g_MidiMessage->key);
 					break;
                 case TML_NOTE_ON:				// Play a note
-					if (playmidi_debug) fprintf(stderr, "    Start Note\n");
+					TRACE_FIELD(playmidi_debug, "    Start Note\n");
                     tsf_channel_note_on(g_TinySoundFont, g_MidiMessage->channel, g_MidiMessage->key, g_MidiMessage->velocity / 127.0f);
 					break;
                 case TML_CONTROL_CHANGE:		// MIDI controller messages
-					if (playmidi_debug) fprintf(stderr, "    Set controller\n");
+					TRACE_FIELD(playmidi_debug, "    Set controller\n");
                     tsf_channel_midi_control(
                         g_TinySoundFont, g_MidiMessage->channel,
                         g_MidiMessage->control, g_MidiMessage->control_value
                     );
 					break;
                 case TML_PROGRAM_CHANGE:		// Channel program (preset) change
-					if (playmidi_debug) fprintf(stderr, "    Set preset\n");
+					TRACE_FIELD(playmidi_debug, "    Set preset\n");
                     tsf_channel_set_presetnumber(g_TinySoundFont, g_MidiMessage->channel, g_MidiMessage->program, 0);
 					break;
 				case TML_PITCH_BEND:            // Pitch wheel modification
-					if (playmidi_debug) fprintf(stderr, "    Set pitch wheel\n");
+					TRACE_FIELD(playmidi_debug, "    Set pitch wheel\n");
                     tsf_channel_set_pitchwheel(g_TinySoundFont, g_MidiMessage->channel, g_MidiMessage->pitch_bend);
 					break;
                 case TML_EOT:                   // End of track message
-                    if (playmidi_debug) fprintf(stderr, "    End of track\n");
+                    TRACE_FIELD(playmidi_debug, "    End of track\n");
                     tsf_note_off_all(g_TinySoundFont);
                     break;
                 default:
@@ -57,18 +399,263 @@ static void AudioCallback(void *data, unsigned char *stream, int len) {
 			}
 		}
 
+		//Run SEQD requests until current playback time
+		if (g_SeqdVm && !runSeqd(*g_SeqdVm, g_Msec)) g_SeqdVm = NULL;
+
 		//Render the block of audio samples in short format
 		tsf_render_short(g_TinySoundFont, (short*)stream, SampleBlock, 0);
 	}
 }
 
 
+///Sets playback message from MIDI message, 0 if playback has no use for it
+///  End of track is left to the caller, it depends on the message before
+static int setTmlMesg(const mesgview &m, tml_message &msg) {
+    const auto st = m.getStat();
+    const auto dt = m.getData();
+
+    if (st >= STAT_NOTE_OFF && st < STAT_SYSTEM_EXCLUSIVE && !dt.empty()) {
+        msg.type = st;
+        msg.channel = m.getChan();
+        msg.key = dt[0] & 0x7F;
+        if (st == STAT_PITCH_WHEEL) msg.pitch_bend = ((dt.size() > 1 ? dt[1] & 0x7F : 0) << 7) | msg.key;
+        else if (st != STAT_PROGRAMME_CHANGE && st != STAT_CHANNEL_PRESSURE && dt.size() > 1) msg.velocity = dt[1] & 0x7F;
+    }
+    else if (st == META_TEMPO && dt.size() == 3) {
+        msg.type = TML_SET_TEMPO;
+        std::copy(dt.begin(), dt.end(), ((tml_tempomsg*)&msg)->Tempo);
+    }
+
+    return msg.type;
+}
+
+///Loads messages from MIDI event cache next to MIDI file, if it's there and current
+///  Messages come out as tml_load would make them, MIDI is only hashed, never parsed
+static int loadMev(const std::string &mid, std::vector<tml_message> &out) {
+    const unsigned char *data = 0;
+    unsigned size = 0, src = 0;
+    mevinfo mev;
+
+    out.clear();
+    if (!mapFileData((mid.substr(0, mid.find_last_of('.')) + ".mev").c_str(), data, size)) return 0;
+    if (!unpackMev(mev, data, size)) {
+        unmapFileData(data, size);
+        return 0;
+    }
+
+    //MIDI file, if there, has to be what cache was made from
+    if (getFileSize(mid.c_str(), src)) {
+        const unsigned char *mid_data = 0;
+        unsigned mid_size = 0;
+        bool is_cur = src == mev.src && mapFileData(mid.c_str(), mid_data, mid_size) && getHash(mid_data, mid_size) == mev.hash;
+
+        if (mid_data) unmapFileData(mid_data, mid_size);
+        if (!is_cur) {
+            unmapFileData(data, size);
+            return 0;
+        }
+    }
+
+    //Messages over all tracks ordered by tick, then track
+    std::vector<unsigned> ids(mev.msg.size(), 0);
+    for (unsigned tck = 0; true;) {
+        unsigned nxt = -1;
+
+        for (unsigned t = 0; t < mev.msg.size(); ++t) {
+            const auto &trk = mev.msg[t];
+            auto &i = ids[t];
+
+            for (; i < trk.size() && trk[i].getTime() == tck; ++i) {
+                tml_message msg {};
+
+                msg.time = mev.getMsec(tck);
+                if (trk[i].getStat() == META_END_OF_SEQUENCE) {
+                    //Ends track, kept only if it comes after a delay
+                    if (((i) ? trk[i - 1].getTime() : 0) != tck) { msg.type = TML_EOT; out.push_back(msg); }
+                    i = trk.size(); break;
+                }
+                if (setTmlMesg(trk[i], msg)) out.push_back(msg);
+            }
+            if (i < trk.size() && trk[i].getTime() < nxt) nxt = trk[i].getTime();
+        }
+
+        if (nxt == (unsigned)-1) break;
+        tck = nxt;
+    }
+    unmapFileData(data, size);
+
+    for (unsigned i = 1; i < out.size(); ++i) out[i - 1].next = &out[i];
+    return !out.empty();
+}
+
+///Plays MIDI file while reading it, messages are read a little ahead of playback
+///  Only what's ahead is held, so playback starts once the first blocks are in
+///  Messages come out as tml_load would make them
+static int streamMidi(const std::string &mid, const std::string &nam) {
+    const double AHEAD = 2000.0;
+    FILE *in = fopen(mid.c_str(), "rb");
+    if (!in) return 0;
+
+    midireader rdr([&in](const unsigned offs, unsigned char *out, const unsigned size) -> unsigned {
+        if (fseek(in, offs, SEEK_SET)) return 0;
+        return fread(out, 1, size, in);
+    });
+    if (!rdr.open() || !rdr.div || rdr.div & 0x8000) {
+        fclose(in);
+        return 0;
+    }
+
+    std::vector<unsigned> prv(rdr.size(), 0);           //Tick of previous message per track
+    std::vector<bool> fin(rdr.size(), false);           //Tracks past their end
+    unsigned tmp_tck = 0;                               //Tick and time at last tempo change
+    int tmp_msc = 0;
+    double tck2msc = 500000 / (1000.0 * rdr.div), msc = 0.0;
+    bool more = true;
+    tml_message hold {};
+
+    //Playback waits at the last message until the next ones replace it
+    hold.time = -1;
+
+    auto get_ahead = [&](const double until) -> void {
+        std::vector<tml_message> add;
+        mesgview m;
+        unsigned id;
+
+        while (msc < until && (more = rdr.getMesg(m, id))) {
+            tml_message msg {};
+            const auto tck = m.getTime();
+
+            if (fin[id]) continue;
+            msg.time = tmp_msc + (int)((tck - tmp_tck) * tck2msc);
+            msc = msg.time;
+
+            if (m.getStat() == META_END_OF_SEQUENCE) {
+                //Ends track, kept only if it comes after a delay
+                if (prv[id] != tck) { msg.type = TML_EOT; add.push_back(msg); }
+                fin[id] = true;
+                continue;
+            }
+            prv[id] = tck;
+            if (!setTmlMesg(m, msg)) continue;
+
+            if (msg.type == TML_SET_TEMPO) {
+                const auto &tmp = ((tml_tempomsg*)&msg)->Tempo;
+                tck2msc = ((tmp[0] << 16) | (tmp[1] << 8) | tmp[2]) / (1000.0 * rdr.div);
+                tmp_msc = msg.time;
+                tmp_tck = tck;
+            }
+            add.push_back(msg);
+        }
+
+        SDL_LockAudio();
+        for (const auto &msg : add) {
+            auto &end = g_MidiQueue.back();
+            end = msg;
+            end.next = &g_MidiQueue.emplace_back(hold);
+        }
+        if (!more) {
+            g_MidiQueue.back().time = msc;
+            g_MidiQueue.back().next = NULL;
+        }
+        //Played messages aren't needed anymore
+        while (!g_MidiQueue.empty() && &g_MidiQueue.front() != g_MidiMessage) g_MidiQueue.pop_front();
+        SDL_UnlockAudio();
+    };
+
+    fprintf(stdout, "Playing %s\n", nam.c_str());
+    SDL_LockAudio();
+    g_MidiQueue.assign(1, hold);
+    g_Msec = 0.0;
+    g_MidiMessage = &g_MidiQueue.front();
+    SDL_UnlockAudio();
+
+    get_ahead(AHEAD);
+    SDL_PauseAudio(0);
+    while (g_MidiMessage != NULL) {
+        SDL_Delay(100);
+        flushTrace();
+        if (!more) continue;
+
+        SDL_LockAudio();
+        const double now = g_Msec;
+        SDL_UnlockAudio();
+        get_ahead(now + AHEAD);
+    }
+
+    g_MidiQueue.clear();
+    fclose(in);
+    return 1;
+}
+
+///Runs request sequences of a bank on the SEQD virtual machine, with the bank's own SF2
+///  Sequences that never end are cut off after a while
+static int playSeqd(const tmlseqd &bnk, const int freq) {
+    const double LIMIT = 60000.0;
+    seqdvm vm;
+    tsf *sf2, *org;
+
+    sf2 = tsf_load_filename(bnk.sf2.c_str());
+    if (!sf2) {
+        fprintf(stderr, "Could not set SF2 %s\n", bnk.sf2.c_str());
+        return 0;
+    }
+    tsf_set_output(sf2, TSF_STEREO_INTERLEAVED, freq, 0.0f);
+    //Channels and presets get made here rather than on the audio thread
+    setSeqdVm(vm, bnk, sf2);
+
+    SDL_LockAudio();
+    org = g_TinySoundFont;
+    g_TinySoundFont = sf2;
+    SDL_UnlockAudio();
+
+    for (const auto &gs : bnk.seq) {
+        const int &g = gs[0], &s = gs[1];
+        if ((unsigned)g >= vm.ids.size() || (unsigned)s >= vm.ids[g].size() || vm.ids[g][s] < 0) continue;
+
+        //Named as on extraction, snprintf isn't usable past minisdl_audio
+        std::string nam = bnk.seqd[g][s].name;
+        if (nam.empty()) {
+            auto get_num = [](const int n) -> std::string {
+                const auto out = std::to_string(n);
+                return std::string((out.size() < 3) ? 3 - out.size() : 0, '0') + out;
+            };
+            nam = "seq_" + get_num(g) + "_" + get_num(s);
+        }
+
+        fprintf(stdout, "Playing %s\n", nam.c_str());
+        SDL_LockAudio();
+        setSeqdPlay(vm, vm.ids[g][s]);
+        g_Msec = 0.0;
+        g_SeqdVm = &vm;
+        SDL_UnlockAudio();
+
+        SDL_PauseAudio(0);
+        while (g_SeqdVm != NULL) {
+            SDL_Delay(100);
+            flushTrace();
+            if (g_Msec < LIMIT) continue;
+
+            SDL_LockAudio();
+            if (g_SeqdVm) tsf_note_off_all(g_TinySoundFont);
+            g_SeqdVm = NULL;
+            SDL_UnlockAudio();
+        }
+    }
+
+    SDL_LockAudio();
+    g_TinySoundFont = org;
+    SDL_UnlockAudio();
+    tsf_close(sf2);
+
+    return 1;
+}
+
 ///Play sequences
 int playSequence() {
 	SDL_AudioSpec out;
     
     auto set_output = [&out]() -> int {
-        if (playmidi_debug) fprintf(stderr, "Define audio output format\n");
+        TRACE_STEP(playmidi_debug, "Define audio output format\n");
 
         //Define desired audio output format
         out.freq = 44100;
@@ -77,11 +664,11 @@ int playSequence() {
         out.samples = 4096;
         out.callback = AudioCallback;
 
-        if (playmidi_debug) fprintf(stderr, "Initialize audio system\n");
+        TRACE_STEP(playmidi_debug, "Initialize audio system\n");
 
         //Initialize audio system
         if (SDL_AudioInit(TSF_NULL) < 0) {
-            if (playmidi_debug) fprintf(stderr, "Could not initialize audio hardware or driver\n");
+            TRACE_STEP(playmidi_debug, "Could not initialize audio hardware or driver\n");
             return 0;
         }
 
@@ -89,14 +676,14 @@ int playSequence() {
     };
     
     //Set audio output format
-    if (playmidi_debug) fprintf(stderr, "Set audio output format\n");
+    TRACE_STEP(playmidi_debug, "Set audio output format\n");
 	if (!set_output()) {
         fprintf(stderr, "Could not open set audio output format\n");
         return 0;
     }
     
     //Set SoundFont
-    if (playmidi_debug) fprintf(stderr, "Set SF2\n");
+    TRACE_STEP(playmidi_debug, "Set SF2\n");
     g_TinySoundFont = tsf_load_filename(a_tml.sf2.c_str());
     if (!g_TinySoundFont) {
         fprintf(stderr, "Could not set SF2\n");
@@ -104,24 +691,30 @@ int playSequence() {
     }
 
     //Set SoundFont rendering output mode
-    if (playmidi_debug) fprintf(stderr, "Set SF2 rendering output mode\n");
+    TRACE_STEP(playmidi_debug, "Set SF2 rendering output mode\n");
     tsf_set_output(g_TinySoundFont, TSF_STEREO_INTERLEAVED, out.freq, 0.0f);
 
 	//Request desired audio output format
-    if (playmidi_debug) fprintf(stderr, "Open audio hardware and output format\n");
+    TRACE_STEP(playmidi_debug, "Open audio hardware and output format\n");
 	if (SDL_OpenAudio(&out, TSF_NULL) < 0) {
 		fprintf(stderr, "Could not open the audio hardware or the desired audio output format\n");
 		return 0;
 	}
 
+    //Audio thread traces into a ring made before it starts
+    if constexpr (TRACE_LEVEL >= TRACE_LEVEL_FIELD) { if (playmidi_debug) g_TraceRing = getTraceRealtime(); }
+
 	//Start audio playback
-    if (playmidi_debug) fprintf(stderr, "Play MIDI files\n");
+    TRACE_STEP(playmidi_debug, "Play MIDI files\n");
     for (int m = 0; m < a_tml.mid.size(); ++m) {
         tml_message *tmp = NULL;
+        std::vector<tml_message> mev;
         std::string nam;
         
-        tmp = tml_load_filename(a_tml.mid[m].c_str());
         nam = a_tml.mid[m].substr(a_tml.mid[m].find_last_of("\\/") + 1);
+        if (loadMev(a_tml.mid[m], mev)) tmp = mev.data();
+        else if (streamMidi(a_tml.mid[m], nam)) continue;
+        else tmp = tml_load_filename(a_tml.mid[m].c_str());
         if (!tmp) {
             fprintf(stderr, "Could not open %s\n", nam.c_str());
             continue;
@@ -131,12 +724,21 @@ int playSequence() {
         SDL_PauseAudio(0);
         g_Msec = 0.0;
         g_MidiMessage = tmp;
-        while (g_MidiMessage != NULL) SDL_Delay(100);
+        while (g_MidiMessage != NULL) { SDL_Delay(100); flushTrace(); }
         
         //tml_free(tmp);
     }
+
+    //Run request sequences of SGXD banks
+    for (const auto &bnk : a_tml.seqd) playSeqd(bnk, out.freq);
     
     //Clean up
+    SDL_PauseAudio(1);
+    SDL_LockAudio();
+    tracering *ring = g_TraceRing;
+    g_TraceRing = NULL;
+    SDL_UnlockAudio();
+    dropTraceRing(ring);
     //tsf_close(g_TinySoundFont);
     a_tml = {};
 
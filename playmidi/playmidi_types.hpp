@@ -1,12 +1,38 @@
 #ifndef PLAYMIDI_TYPES_HPP
 #define PLAYMIDI_TYPES_HPP
 
+#include <array>
 #include <string>
 #include <vector>
+#include "../lrt/sgxd_types.hpp"
+
+///SEQD Request Sequence Playback Info
+struct tmlseqdseq {
+    std::string name;
+    short div = 0;
+    seqdprog prog;                              //Empty if not a request sequence
+    seqdrng rng;                                //Same picks as the converted sequence
+};
+
+///SEQD Region Tone Playback Info
+struct tmlseqdton {
+    char notelow, notehigh;
+    char bnkid;                                 //Soundfont bank of its preset
+};
+
+///SEQD Bank Playback Info
+///  Only what's needed to run request sequences of a bank, the rest of it isn't kept
+struct tmlseqd {
+    std::string sf2;                            //Soundfont made from its regions
+    std::vector<std::vector<tmlseqdseq>> seqd;  //By group and sequence
+    std::vector<std::vector<tmlseqdton>> rgnd;  //Tones by region
+    std::vector<std::array<int, 2>> seq;        //Group and sequence of every one to run
+};
 
 struct tmlmsg {
     std::string sf2;
     std::vector<std::string> mid;
+    std::vector<tmlseqd> seqd;
 };
 
 
@@ -5,6 +5,12 @@
 
 #if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) \
                       || defined(WIN64) || defined(_WIN64) || defined(__WIN64__)
+    #ifndef NOMINMAX
+    #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
     #include <windows.h>
     #define sleep(secs) Sleep(secs * 1000)
 #else
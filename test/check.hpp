@@ -0,0 +1,54 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <cstdio>
+#include "../lrt/midi/midi_types.hpp"
+
+
+static int chk_fail = 0;
+
+///Reports failed check, returns outcome
+static inline bool setCheck(const bool ok, const char *what, const int line) {
+    if (!ok) {
+        fprintf(stderr, "FAIL %s (line %d)\n", what, line);
+        chk_fail += 1;
+    }
+    return ok;
+}
+
+#define CHECK(x) setCheck((x), #x, __LINE__)
+
+///Compares two tracks message by message, reports first difference
+template<typename T0, typename T1>
+static inline bool isSameTrack(const T0 &t0, const T1 &t1) {
+    if (t0.size() != t1.size()) {
+        fprintf(stderr, "    size %u != %u\n", (unsigned)t0.size(), (unsigned)t1.size());
+        return false;
+    }
+    for (unsigned i = 0; i < t0.size(); ++i) {
+        const mesgview m0 = t0[i], m1 = t1[i];
+        if (
+            m0.getTime() != m1.getTime() ||
+            m0.getStat() != m1.getStat() ||
+            m0.getChan() != m1.getChan() ||
+            !(m0.getData() == m1.getData())
+        ) {
+            fprintf(
+                stderr, "    message %u: %u/%d/%d != %u/%d/%d\n", i,
+                m0.getTime(), m0.getStat(), m0.getChan(), m1.getTime(), m1.getStat(), m1.getChan()
+            );
+            return false;
+        }
+    }
+    return true;
+}
+
+///Reports outcome of all checks, returns exit code
+static inline int getCheck(const char *name) {
+    if (chk_fail) fprintf(stderr, "%s: %d check(s) failed\n", name, chk_fail);
+    else fprintf(stdout, "%s: ok\n", name);
+    return chk_fail != 0;
+}
+
+
+#endif
@@ -0,0 +1,107 @@
+///MIDICSV writer golden check
+///  g++ -std=c++20 -I lrt test/csv_check.cpp lrt/midi/csv.cpp -o csv_check -lpthread
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) \
+                      || defined(WIN64) || defined(_WIN64) || defined(__WIN64__)
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+#include "check.hpp"
+#define PACKCSV_IMPLEMENTATION
+#include "../lrt/midi/midi_func.hpp"
+
+
+int main() {
+    const std::vector<unsigned char> sysex {0xF0, 0x7E, 0x7F, 0x09, 0x01, 0xF7};
+    const short prg = STAT_PROGRAMME_CHANGE | 3, ctl = STAT_CONTROLLER | 3, pwh = STAT_PITCH_WHEEL | 3;
+    const short non = STAT_NOTE_ON | 3, nof = STAT_NOTE_OFF | 3;
+    midiinfo mid {MIDI_MULTIPLE_TRACK, 2, 480};
+    mid.msg.resize(2);
+
+    mid.msg[0].push_back({0, META_SEQUENCE_ID, {0x01, 0x02}});
+    mid.msg[0].push_back({0, META_TRACK_NAME, "Conductor Track"});
+    mid.msg[0].push_back({0, META_TEMPO, {0x07, 0xA1, 0x20}});
+    mid.msg[0].push_back({0, META_TIME_SIGNATURE, {4, 2, 24, 8}});
+    mid.msg[0].push_back({0, META_KEY_SIGNATURE, {0xFD, 1}});
+    mid.msg[0].push_back({0, META_KEY_SIGNATURE, {2, 0}});
+    mid.msg[0].push_back({480, META_MARKER, "loopStart"});
+    mid.msg[0].push_back({960, META_END_OF_SEQUENCE});
+    mid.msg[1].push_back({0, prg, {5}});
+    mid.msg[1].push_back({0, ctl, {7, 100}});
+    mid.msg[1].push_back({0, STAT_SYSTEM_EXCLUSIVE, sysex.data(), (int)sysex.size()});
+    mid.msg[1].push_back({0, STAT_SYSTEM_EXCLUSIVE, sysex.data(), 0});
+    mid.msg[1].push_back({0, non, {60, 100}});
+    mid.msg[1].push_back({240, pwh, {0x01, 0x41}});
+    mid.msg[1].push_back({480, nof, {60, 0}});
+    mid.msg[1].push_back({960, META_END_OF_SEQUENCE});
+
+    //Lines as the std::format writer gave them, empty sysex has always run into the next line
+    const std::string ref =
+        "0, 0, HEADER, 1, 2, 480\n"
+        "1, 0, START_TRACK\n"
+        "1, 0, SEQUENCE_NUMBER, 258\n"
+        "1, 0, TITLE_T, \"Conductor Track\"\n"
+        "1, 0, TEMPO, 500000\n"
+        "1, 0, TIME_SIGNATURE, 4, 2, 24, 8\n"
+        "1, 0, KEY_SIGNATURE, -3, \"minor\"\n"
+        "1, 0, KEY_SIGNATURE, 2, \"major\"\n"
+        "1, 480, MARKER_T, \"loopStart\"\n"
+        "1, 960, END_TRACK\n"
+        "2, 0, START_TRACK\n"
+        "2, 0, PROGRAM_C, 3, 5\n"
+        "2, 0, CONTROL_C, 3, 7, 100\n"
+        "2, 0, SYSTEM_EXCLUSIVE, , 6, 240, 126, 127, 9, 1, 247\n"
+        "2, 0, SYSTEM_EXCLUSIVE, , 0, 2, 0, NOTE_ON_C, 3, 60, 100\n"
+        "2, 240, PITCH_BEND_C, 3, 8321\n"
+        "2, 480, NOTE_OFF_C, 3, 60, 0\n"
+        "2, 960, END_TRACK\n"
+        "0, 0, END_OF_FILE\n";
+    CHECK(packCsv(mid) == ref);
+
+    //Text past the 64 KiB block goes out whole, blocks stay within block and slack
+    const std::string txt(70000, 'a');
+    midiinfo big {MIDI_SINGLE_TRACK, 1, 96};
+    big.msg.emplace_back();
+    big.msg[0].push_back({0, META_TEXT, txt.c_str()});
+    big.msg[0].push_back({0, META_END_OF_SEQUENCE});
+    const std::string big_ref =
+        "0, 0, HEADER, 0, 1, 96\n"
+        "1, 0, START_TRACK\n"
+        "1, 0, TEXT_T, \"" + txt + "\"\n"
+        "1, 0, END_TRACK\n"
+        "0, 0, END_OF_FILE\n";
+    std::string snk;
+    unsigned blks = 0, most = 0;
+    CHECK(packCsv(big, [&](const char *data, const unsigned data_size) -> int {
+        snk.append(data, data_size);
+        blks += 1; most = std::max(most, data_size);
+        return 1;
+    }));
+    CHECK(snk == big_ref);
+    CHECK(blks > 1 && most <= (1 << 16) + 256);
+    CHECK(!packCsv(big, [](const char*, const unsigned) -> int { return 0; }));
+
+    //File descriptor gives the same text
+    const char *tmp = "csv_check.tmp";
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (CHECK(fd >= 0)) {
+        CHECK(packCsv(mid, fd));
+        close(fd);
+
+        std::string fil;
+        if (FILE *f = fopen(tmp, "rb")) {
+            char buf[4096];
+            for (size_t s; (s = fread(buf, 1, sizeof(buf), f));) fil.append(buf, s);
+            fclose(f);
+        }
+        CHECK(fil == ref);
+        remove(tmp);
+    }
+
+    return getCheck("csv_check");
+}
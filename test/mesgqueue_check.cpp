@@ -0,0 +1,74 @@
+///Track writer check, queued emission against sorting the whole track
+///  g++ -std=c++20 -I lrt test/mesgqueue_check.cpp lrt/midi/midi.cpp -o mesgqueue_check -lpthread
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "check.hpp"
+#include "../lrt/midi/midi_func.hpp"
+
+
+///Gets note stream as lbrtconv gives it, note offs ahead of time and overlapping
+///  back is time of a message that jumps back, 0 for none
+static void getStream(mesgqueue &que, mesgtrack &srt, const unsigned seed, const unsigned back) {
+    std::mt19937 rng(seed);
+    unsigned tm = 0;
+
+    auto set_now = [&que, &srt](const unsigned tm, const short st, std::initializer_list<unsigned char> dt) -> void {
+        que.setMesg(tm, st, dt);
+        srt.push_back({tm, st, dt});
+    };
+    auto set_late = [&que, &srt](const unsigned tm, const short st, std::initializer_list<unsigned char> dt) -> void {
+        que.setLater(tm, st, dt);
+        srt.push_back({tm, st, dt});
+    };
+
+    que.setMesg(0, META_TRACK_NAME, "Check Track");
+    srt.push_back({0, META_TRACK_NAME, "Check Track"});
+    for (unsigned i = 0; i < 2000; ++i) {
+        const unsigned char chn = rng() % 4, key = 40 + rng() % 40;
+        const unsigned len = (rng() % 8) ? rng() % 960 : 0;
+
+        //Same-time groups, controllers and note ons out of their sorted order
+        if (rng() % 3) tm += rng() % 240;
+        if (back && i == 1000) tm -= back;
+        if (!(rng() % 5)) set_now(tm, STAT_CONTROLLER | chn, {7, (unsigned char)(rng() % 128)});
+        set_now(tm, STAT_NOTE_ON | chn, {key, (unsigned char)(1 + rng() % 127)});
+        if (rng() % 2) set_late(tm + len, STAT_NOTE_ON | chn, {key, 0});
+        else set_late(tm + len, STAT_NOTE_OFF | chn, {key, 64});
+    }
+    set_late(tm + 960, META_END_OF_SEQUENCE, {});
+    que.flush();
+    srt.sort();
+}
+
+int main() {
+    for (unsigned seed = 1; seed <= 8; ++seed) {
+        midiinfo mid {MIDI_SINGLE_TRACK, 1, 480}, ref {MIDI_SINGLE_TRACK, 1, 480};
+        mid.msg.emplace_back(); ref.msg.emplace_back();
+
+        //Messages reach the track in order, as sorting the whole of it would give
+        mesgqueue que(mid.msg[0]);
+        getStream(que, ref.msg[0], seed, 0);
+        CHECK(que.isOrdered());
+        CHECK(isSameTrack(mid.msg[0], ref.msg[0]));
+        CHECK(packMidi(mid) == packMidi(ref));
+
+        //Going back in time falls back to sorting, with the same outcome
+        midiinfo bmid {MIDI_SINGLE_TRACK, 1, 480}, bref {MIDI_SINGLE_TRACK, 1, 480};
+        bmid.msg.emplace_back(); bref.msg.emplace_back();
+        mesgqueue bque(bmid.msg[0]);
+        getStream(bque, bref.msg[0], seed, 5000);
+        CHECK(!bque.isOrdered());
+        CHECK(isSameTrack(bmid.msg[0], bref.msg[0]));
+        CHECK(packMidi(bmid) == packMidi(bref));
+    }
+
+    //Nothing added leaves track empty
+    mesgtrack trk;
+    mesgqueue que(trk);
+    CHECK(que.empty());
+    que.flush();
+    CHECK(trk.empty());
+
+    return getCheck("mesgqueue_check");
+}
@@ -0,0 +1,91 @@
+///MIDI event cache round-trip check
+///  g++ -std=c++20 -I lrt test/mev_check.cpp lrt/midi/mev.cpp lrt/midi/midi.cpp -o mev_check -lpthread
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "check.hpp"
+#include "../lrt/midi/midi_func.hpp"
+
+
+int main() {
+    const std::vector<unsigned char> sysex(33, 0x44);
+    midiinfo mid {MIDI_MULTIPLE_TRACK, 2, 480};
+    mid.msg.resize(2);
+
+    //Tempo halves at tick 960, loop markers in both forms
+    mid.msg[0].push_back({0, META_TRACK_NAME, "Conductor Track"});
+    mid.msg[0].push_back({0, META_TEMPO, {0x07, 0xA1, 0x20}});
+    mid.msg[0].push_back({480, META_MARKER, "loopStart"});
+    mid.msg[0].push_back({960, META_TEMPO, {0x03, 0xD0, 0x90}});
+    mid.msg[0].push_back({1920, META_END_OF_SEQUENCE});
+    mid.msg[1].push_back({0, STAT_SYSTEM_EXCLUSIVE, sysex.data(), (int)sysex.size()});
+    mid.msg[1].push_back({0, STAT_NOTE_ON | 2, {60, 100}});
+    mid.msg[1].push_back({1440, STAT_CONTROLLER | 2, {CC_XML_LOOPEND, 0}});
+    mid.msg[1].push_back({1440, STAT_NOTE_ON | 2, {60, 0}});
+    mid.msg[1].push_back({1920, META_END_OF_SEQUENCE});
+
+    //Cache reads back the same messages
+    const auto dat = packMev(mid, 1234, 0x0123456789ABCDEFULL);
+    mevinfo mev;
+    CHECK(unpackMev(mev, dat.data(), dat.size()));
+    CHECK(mev.fmt == mid.fmt && mev.trk == mid.trk && mev.div == mid.div);
+    CHECK(mev.src == 1234 && mev.hash == 0x0123456789ABCDEFULL);
+    if (CHECK(mev.msg.size() == mid.msg.size())) {
+        for (unsigned t = 0; t < mid.msg.size(); ++t) CHECK(isSameTrack(mev.msg[t], mid.msg[t]));
+    }
+
+    //Loop points and tempo map
+    CHECK(mev.lbeg == 480 && mev.lend == 1440);
+    CHECK(mev.tempo_size == 2);
+    CHECK(mev.getMsec(0) == 0);
+    CHECK(mev.getMsec(480) == 500);
+    CHECK(mev.getMsec(960) == 1000);
+    CHECK(mev.getMsec(1440) == 1250);
+
+    //Cache of cache data matches MIDI data written from it
+    midiinfo out {mev.fmt, mev.trk, mev.div};
+    for (const auto &trk : mev.msg) {
+        out.msg.emplace_back();
+        for (const auto &m : trk) out.msg.back().push_back(m.getMesg());
+    }
+    CHECK(packMidi(out) == packMidi(mid));
+
+    //Broken or foreign data is refused
+    auto bad = dat;
+    CHECK(!unpackMev(mev, bad.data(), bad.size() - 4) && mev.empty());
+    bad[8] ^= 0xFF;
+    CHECK(!unpackMev(mev, bad.data(), bad.size()));
+    bad = dat;
+    bad[4] += 1;
+    CHECK(!unpackMev(mev, bad.data(), bad.size()));
+
+    //Records are read in place, so data has to be aligned
+    std::vector<unsigned> mis(dat.size() / 4 + 2);
+    memcpy((unsigned char*)mis.data() + 1, dat.data(), dat.size());
+    CHECK(!unpackMev(mev, (unsigned char*)mis.data() + 1, dat.size()));
+
+    //Records of first track pointing past the end, entry follows 56 byte header
+    bad = dat;
+    const unsigned end = bad.size();
+    memcpy(bad.data() + 56, &end, 4);
+    CHECK(!unpackMev(mev, bad.data(), bad.size()));
+
+    //Payload running past end of its arena
+    CHECK(unpackMev(mev, dat.data(), dat.size()));
+    bad = dat;
+    const unsigned rec = (const unsigned char*)mev.msg[1].recs - dat.data();
+    mevmesg sys;
+    memcpy(&sys, bad.data() + rec, sizeof(mevmesg));
+    CHECK(sys.dsiz == sysex.size());
+    sys.dval += 1;
+    memcpy(bad.data() + rec, &sys, sizeof(mevmesg));
+    CHECK(!unpackMev(mev, bad.data(), bad.size()) && mev.empty());
+
+    //Time code division can't be timed, so it isn't cached
+    midiinfo smp = mid;
+    smp.setDivision(-25, 40);
+    CHECK(packMev(smp).empty());
+    CHECK(packMev(midiinfo {}).empty());
+
+    return getCheck("mev_check");
+}
@@ -0,0 +1,112 @@
+///SMF writer round-trip check
+///  g++ -std=c++20 -I lrt test/midi_check.cpp lrt/midi/midi.cpp -o midi_check -lpthread
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#if defined(_MSC_VER) || defined(WIN32) || defined(_WIN32) || defined(__WIN32__) \
+                      || defined(WIN64) || defined(_WIN64) || defined(__WIN64__)
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+#include "check.hpp"
+#include "../lrt/midi/midi_func.hpp"
+
+
+///Gets track with every kind of message the writer handles
+static mesgtrack getTrack(const unsigned char chn) {
+    const std::vector<unsigned char> sysex(200, 0x11);
+    const short prg = STAT_PROGRAMME_CHANGE | chn, ctl = STAT_CONTROLLER | chn, pwh = STAT_PITCH_WHEEL | chn;
+    const short non = STAT_NOTE_ON | chn, nof = STAT_NOTE_OFF | chn;
+    mesgtrack trk;
+
+    trk.push_back({0, META_TRACK_NAME, "Check Track"});
+    trk.push_back({0, META_TEMPO, {0x07, 0xA1, 0x20}});
+    trk.push_back({0, META_TIME_SIGNATURE, {4, 2, 24, 8}});
+    trk.push_back({0, prg, {5}});
+    trk.push_back({0, ctl, {7, 100}});
+    trk.push_back({0, STAT_SYSTEM_EXCLUSIVE, sysex.data(), (int)sysex.size()});
+    //Running status and a long delta time
+    trk.push_back({0, non, {60, 100}});
+    trk.push_back({0, non, {64, 100}});
+    trk.push_back({96, non, {67, 100}});
+    trk.push_back({0x0FFFFF, nof, {60, 0}});
+    trk.push_back({0x0FFFFF, nof, {64, 0}});
+    trk.push_back({0x10FFFF, pwh, {0x00, 0x40}});
+    trk.push_back({0x10FFFF, nof, {67, 0}});
+    trk.push_back({0x10FFFF, META_MARKER, "loopEnd"});
+    trk.push_back({0x10FFFF, META_END_OF_SEQUENCE});
+
+    return trk;
+}
+
+int main() {
+    midiinfo mid {MIDI_MULTIPLE_TRACK, 2, 480};
+    mid.msg.push_back(getTrack(0));
+    mid.msg.push_back(getTrack(9));
+
+    //Data unpacks into the same messages
+    const auto dat = packMidi(mid);
+    CHECK(dat.size() > 14);
+    midiinfo out;
+    unpackMidi(out, (unsigned char*)dat.data(), dat.size(), 1);
+    CHECK(out.fmt == mid.fmt && out.trk == mid.trk && out.div == mid.div);
+    if (CHECK(out.msg.size() == mid.msg.size())) {
+        for (unsigned t = 0; t < mid.msg.size(); ++t) CHECK(isSameTrack(out.msg[t], mid.msg[t]));
+    }
+
+    //Writing again gives the same bytes
+    CHECK(packMidi(out) == dat);
+
+    //Chunked sink gives the same bytes
+    std::vector<unsigned char> snk;
+    CHECK(packMidi(mid, [&snk](const unsigned char *data, const unsigned data_size) -> int {
+        snk.insert(snk.end(), data, data + data_size);
+        return 1;
+    }));
+    CHECK(snk == dat);
+    CHECK(!packMidi(mid, [](const unsigned char*, const unsigned) -> int { return 0; }));
+
+    //File descriptor gives the same bytes
+    const char *tmp = "midi_check.tmp";
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (CHECK(fd >= 0)) {
+        CHECK(packMidi(mid, fd));
+        close(fd);
+
+        std::vector<unsigned char> fil;
+        if (FILE *f = fopen(tmp, "rb")) {
+            unsigned char buf[4096];
+            for (size_t s; (s = fread(buf, 1, sizeof(buf), f));) fil.insert(fil.end(), buf, buf + s);
+            fclose(f);
+        }
+        CHECK(fil == dat);
+        remove(tmp);
+    }
+
+    //Smallest file is written byte for byte
+    const unsigned char ref[] = {
+        'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0, 96,
+        'M', 'T', 'r', 'k', 0, 0, 0, 12,
+        0x00, 0x90, 60, 100,
+        0x60, 60, 0,
+        0x81, 0x00, 0xFF, 0x2F, 0x00
+    };
+    midiinfo one {MIDI_SINGLE_TRACK, 1, 96};
+    one.msg.emplace_back();
+    one.msg[0].push_back({0, STAT_NOTE_ON, {60, 100}});
+    one.msg[0].push_back({96, STAT_NOTE_ON, {60, 0}});
+    one.msg[0].push_back({224, META_END_OF_SEQUENCE});
+    CHECK(packMidi(one) == std::vector<unsigned char>(ref, ref + sizeof(ref)));
+
+    //Inconsistent info is refused
+    midiinfo bad = mid;
+    bad.trk = 3;
+    CHECK(packMidi(bad).empty());
+    bad = {MIDI_SINGLE_TRACK, 0, 96};
+    CHECK(packMidi(bad).empty());
+
+    return getCheck("midi_check");
+}
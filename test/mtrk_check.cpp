@@ -0,0 +1,102 @@
+///MTrk parser check
+///  g++ -std=c++20 -I lrt test/mtrk_check.cpp lrt/midi/midi.cpp -o mtrk_check -lpthread
+#include <cstdio>
+#include <vector>
+#include "check.hpp"
+#include "../lrt/midi/midi_func.hpp"
+
+
+///Gets track of notes on one channel, with some meta and sysex in between
+static mesgtrack getTrack(const unsigned t) {
+    const short non = STAT_NOTE_ON | (t & 0x0F), ctl = STAT_CONTROLLER | (t & 0x0F);
+    const std::vector<unsigned char> sysex(7 + t, 0x22);
+    mesgtrack trk;
+
+    trk.push_back({0, META_TRACK_NAME, "Track"});
+    for (unsigned i = 0; i < 50 + 10 * t; ++i) {
+        const unsigned char key = 30 + (i * 7 + t) % 60;
+        trk.push_back({i * 48, non, {key, 90}});
+        if (!(i % 9)) trk.push_back({i * 48 + 1, ctl, {10, (unsigned char)(i & 0x7F)}});
+        if (!(i % 13)) trk.push_back({i * 48 + 2, STAT_SYSTEM_EXCLUSIVE, sysex.data(), (int)sysex.size()});
+        trk.push_back({i * 48 + 40, non, {key, 0}});
+    }
+    trk.push_back({trk.back().getTime(), META_END_OF_SEQUENCE});
+
+    return trk;
+}
+
+///Checks that track holds only whole messages from start of reference
+static bool isPrefix(const mesgtrack &trk, const mesgtrack &ref) {
+    if (trk.size() > ref.size()) return false;
+    for (unsigned i = 0; i < trk.size(); ++i) {
+        const auto m0 = trk[i], m1 = ref[i];
+        if (m0.getTime() != m1.getTime() || m0.getStat() != m1.getStat()) return false;
+        if (m0.getChan() != m1.getChan() || !(m0.getData() == m1.getData())) return false;
+    }
+    return true;
+}
+
+int main() {
+    //Tracks parsed on any number of threads come out the same
+    midiinfo mid {MIDI_MULTIPLE_TRACK, 24, 96};
+    for (unsigned t = 0; t < mid.trk; ++t) mid.msg.push_back(getTrack(t));
+    auto dat = packMidi(mid);
+
+    for (const unsigned jobs : {1u, 4u, 0u}) {
+        midiinfo out;
+        unpackMidi(out, dat.data(), dat.size(), jobs);
+        if (!CHECK(out.msg.size() == mid.msg.size())) continue;
+        for (unsigned t = 0; t < mid.msg.size(); ++t) CHECK(isSameTrack(out.msg[t], mid.msg[t]));
+    }
+
+    //Running status, meta and sysex are read as written by hand
+    unsigned char raw[] = {
+        0x00, 0xFF, 0x03, 0x02, 'h', 'i',
+        0x00, 0x91, 60, 100,
+        0x10, 62, 101,
+        0x81, 0x00, 0xF0, 0x03, 0x7E, 0x7F, 0xF7,
+        0x00, 0xC1, 0x05,
+        0x00, 0x05,
+        0x00, 0xFF, 0x2F, 0x00
+    };
+    midiinfo hnd;
+    unpackMesg(hnd, raw, sizeof(raw));
+    if (CHECK(hnd.msg.size() == 1)) {
+        mesgtrack ref;
+        ref.push_back({0, META_TRACK_NAME, "hi"});
+        ref.push_back({0, STAT_NOTE_ON | 1, {60, 100}});
+        ref.push_back({16, STAT_NOTE_ON | 1, {62, 101}});
+        ref.push_back({144, STAT_SYSTEM_EXCLUSIVE, {0x7E, 0x7F, 0xF7}});
+        ref.push_back({144, STAT_PROGRAMME_CHANGE | 1, {5}});
+        ref.push_back({144, STAT_PROGRAMME_CHANGE | 1, {5}});
+        ref.push_back({144, META_END_OF_SEQUENCE});
+        CHECK(isSameTrack(hnd.msg[0], ref));
+    }
+
+    //Cut off tracks keep their whole messages only
+    midiinfo one {MIDI_SINGLE_TRACK, 1, 96};
+    one.msg.push_back(getTrack(3));
+    dat = packMidi(one);
+    const unsigned len = dat.size() - 22;
+    unsigned bad = 0;
+    for (unsigned l = 0; l <= len; ++l) {
+        std::vector<unsigned char> cut(dat.begin(), dat.begin() + 22 + l);
+        cut[18] = l >> 24; cut[19] = l >> 16; cut[20] = l >> 8; cut[21] = l;
+
+        midiinfo out;
+        unpackMidi(out, cut.data(), cut.size(), 1);
+        if (l < 2) bad += !out.msg.empty();
+        else bad += out.msg.size() != 1 || !isPrefix(out.msg[0], one.msg[0]);
+    }
+    CHECK(bad == 0);
+
+    //Chunks running past the end are dropped, not read
+    for (unsigned l = 0; l < dat.size(); ++l) {
+        midiinfo out;
+        unpackMidi(out, dat.data(), l, 1);
+        bad += !out.msg.empty();
+    }
+    CHECK(bad == 0);
+
+    return getCheck("mtrk_check");
+}
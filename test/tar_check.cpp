@@ -0,0 +1,125 @@
+///Tar archive writer check
+///  g++ -std=c++20 -I lrt test/tar_check.cpp -o tar_check -lpthread
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "check.hpp"
+#include "../lrt/filequeue.hpp"
+
+
+///Reads whole file, empty if missing
+static std::vector<unsigned char> getFile(const char *file) {
+    std::vector<unsigned char> out;
+    if (FILE *f = fopen(file, "rb")) {
+        unsigned char buf[4096];
+        for (size_t s; (s = fread(buf, 1, sizeof(buf), f));) out.insert(out.end(), buf, buf + s);
+        fclose(f);
+    }
+    return out;
+}
+
+///Reads entries of tar data into name to data map, 0 on any malformed header
+static int unpackTar(const std::vector<unsigned char> &in, std::map<std::string, std::vector<unsigned char>> &out) {
+    std::string lng;
+    unsigned pos = 0;
+
+    while (pos + 512 <= in.size()) {
+        const unsigned char *hdr = in.data() + pos;
+        unsigned sum = 0;
+
+        //Two zero blocks end the archive
+        if (std::all_of(hdr, hdr + 512, [](const unsigned char c) { return !c; })) {
+            return pos + 1024 == in.size() && std::all_of(hdr, hdr + 1024, [](const unsigned char c) { return !c; });
+        }
+
+        for (unsigned i = 0; i < 512; ++i) sum += (i >= 148 && i < 156) ? ' ' : hdr[i];
+        if (strtoul(std::string((const char*)hdr + 148, 8).c_str(), 0, 8) != sum) return 0;
+        if (memcmp(hdr + 257, "ustar", 6)) return 0;
+
+        const unsigned siz = strtoul(std::string((const char*)hdr + 124, 12).c_str(), 0, 8);
+        if (pos + 512 + siz > in.size()) return 0;
+        const unsigned char *dat = hdr + 512;
+
+        std::string name((const char*)hdr, strnlen((const char*)hdr, 100));
+        if (hdr[345]) name = std::string((const char*)hdr + 345, strnlen((const char*)hdr + 345, 155)) + "/" + name;
+
+        if (hdr[156] == 'L') lng.assign((const char*)dat, strnlen((const char*)dat, siz));
+        else if (hdr[156] == '0') {
+            if (!lng.empty()) { name = lng; lng.clear(); }
+            if (out.count(name)) return 0;
+            out[name].assign(dat, dat + siz);
+        }
+        else return 0;
+
+        pos += 512 + (siz + 511) / 512 * 512;
+    }
+
+    return 0;
+}
+
+int main() {
+    const char *arc = "tar_check.tar";
+    const std::string dir(60, 'd'), fle(60, 'f'), lng(120, 'l');
+    std::map<std::string, std::vector<unsigned char>> ref;
+
+    ref["short.mid"] = {'M', 'T', 'h', 'd'};
+    ref["empty.csv"] = {};
+    ref["sub/block.wav"] = std::vector<unsigned char>(512, 0x55);
+    ref["sub/over.wav"] = std::vector<unsigned char>(513, 0x66);
+    ref[dir + "/" + fle + ".sf2"] = std::vector<unsigned char>(1000, 0x77);
+    ref["sub/" + lng + ".mid"] = std::vector<unsigned char>(3, 0x88);
+
+    //Entries from several workers, names as callers give them
+    {
+        filequeue queue(3);
+        CHECK(queue.setArchive(arc));
+        CHECK(queue.setFolder("sub"));
+        for (const auto &r : ref) {
+            std::string name = r.first;
+            if (name == "short.mid") name = "./short.mid";
+            else if (name == "sub/block.wav") name = "/sub\\block.wav";
+            CHECK(queue.setFile(name, std::vector<unsigned char>(r.second)));
+        }
+        CHECK(queue.setArchive(""));
+        CHECK(queue.getErrors().empty());
+    }
+    CHECK(!isFolder("sub"));
+
+    //Archive holds every file once
+    const auto tar = getFile(arc);
+    std::map<std::string, std::vector<unsigned char>> out;
+    CHECK(!tar.empty() && !(tar.size() % 512));
+    CHECK(unpackTar(tar, out));
+    CHECK(out == ref);
+
+    //Table of contents points at entry data
+    const auto toc = getFile((std::string(arc) + ".toc").c_str());
+    std::string txt(toc.begin(), toc.end());
+    unsigned cnt = 0;
+    for (size_t p0 = 0, p1; (p1 = txt.find('\n', p0)) != std::string::npos; p0 = p1 + 1) {
+        unsigned long long pos = 0;
+        unsigned siz = 0;
+        int len = 0;
+        if (!CHECK(sscanf(txt.c_str() + p0, "%llu %u %n", &pos, &siz, &len) == 2)) break;
+
+        const std::string name = txt.substr(p0 + len, p1 - p0 - len);
+        CHECK(ref.count(name) && ref[name].size() == siz);
+        CHECK(pos + siz <= tar.size() && std::equal(tar.begin() + pos, tar.begin() + pos + siz, ref[name].begin()));
+        cnt += 1;
+    }
+    CHECK(cnt == ref.size());
+
+    remove(arc);
+    remove((std::string(arc) + ".toc").c_str());
+
+    //Archive that can't be opened is reported
+    {
+        filequeue queue(1);
+        CHECK(!queue.setArchive("no_such_folder/tar_check.tar"));
+    }
+
+    return getCheck("tar_check");
+}